@@ -2,7 +2,11 @@
 #include "AssimpMeshLoader.h"
 
 #include <algorithm>
-#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
 #include <string>
 
 #include <glm/glm.hpp>
@@ -16,14 +20,105 @@
 
 #include <cppexpose/variant/Variant.h>
 
+#include <cppfs/fs.h>
+#include <cppfs/FileHandle.h>
+
 #include <glbinding/gl/enum.h>
 
+#include <globjects/Buffer.h>
+
+#include <gloperate/base/MappedFile.h>
 #include <gloperate/rendering/Drawable.h>
 
+#include "MeshCache.h"
+
 
 using namespace gloperate;
 
 
+namespace
+{
+
+
+void writeCache(const std::string & filename, const std::vector<char> & data)
+{
+    // Write to temporary file first, so concurrent loads never map a partial file
+    const auto tempFilename = filename + ".tmp";
+
+    {
+        std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+        if (!file.good())
+        {
+            // The source directory may be read-only, which is not an error
+            cppassist::debug("AssimpMeshLoader") << "Could not write cache file " << filename;
+
+            file.close();
+            std::remove(tempFilename.c_str());
+            return;
+        }
+    }
+
+    std::remove(filename.c_str());
+    if (std::rename(tempFilename.c_str(), filename.c_str()) != 0)
+    {
+        std::remove(tempFilename.c_str());
+    }
+}
+
+Drawable * createDrawable(const MeshCache::View & mesh)
+{
+    const auto & header = mesh.header;
+
+    // Create geometry
+    Drawable * geometry = new Drawable;
+
+    // Upload indices
+    globjects::Buffer * indexBuffer = new globjects::Buffer;
+    indexBuffer->setData(static_cast<gl::GLsizeiptr>(header.indexCount) * header.indexSize, mesh.indices, gl::GL_STATIC_DRAW);
+    geometry->setIndexBuffer(indexBuffer, header.indexSize == 2 ? gl::GL_UNSIGNED_SHORT : gl::GL_UNSIGNED_INT);
+    geometry->setSize(header.indexCount);
+    geometry->setRanges(mesh.ranges);
+    geometry->setDrawMode(gloperate::DrawMode::ElementsIndexBuffer);
+
+    // Upload interleaved vertices
+    globjects::Buffer * vertexBuffer = new globjects::Buffer;
+    vertexBuffer->setData(static_cast<gl::GLsizeiptr>(header.vertexCount) * header.stride, mesh.vertices, gl::GL_STATIC_DRAW);
+    geometry->setBuffer(0, vertexBuffer);
+
+    // Position, normal, and texture coordinate are read from the same buffer
+    const auto bindAttribute = [geometry, &header] (size_t index, gl::GLuint offset)
+    {
+        geometry->bindAttribute(index, static_cast<gl::GLint>(index));
+        geometry->setAttributeBindingBuffer(index, 0, 0, static_cast<gl::GLint>(header.stride));
+        geometry->setAttributeBindingFormat(index, 3, gl::GL_FLOAT, gl::GL_FALSE, offset);
+        geometry->enableAttributeBinding(index);
+    };
+
+    gl::GLuint offset = 0;
+
+    bindAttribute(0, offset);
+    offset += sizeof(glm::vec3);
+
+    if (header.attributes & MeshCache::attributeNormal)
+    {
+        bindAttribute(1, offset);
+        offset += sizeof(glm::vec3);
+    }
+
+    if (header.attributes & MeshCache::attributeTexCoord)
+    {
+        bindAttribute(2, offset);
+    }
+
+    return geometry;
+}
+
+
+} // namespace
+
+
 CPPEXPOSE_COMPONENT(AssimpMeshLoader, gloperate::AbstractLoader)
 
 
@@ -103,14 +198,56 @@ std::string AssimpMeshLoader::allLoadingTypes() const
     return string;
 }
 
-Drawable * AssimpMeshLoader::load(const std::string & filename, const cppexpose::Variant & options, std::function<void(int, int)> /*progress*/) const
+Drawable * AssimpMeshLoader::load(const std::string & filename, const cppexpose::Variant & options, std::function<void(int, int)> progress) const
+{
+    return prepare(filename, options, progress)();
+}
+
+std::function<Drawable *()> AssimpMeshLoader::prepare(const std::string & filename, const cppexpose::Variant & options, std::function<void(int, int)> /*progress*/) const
 {
     bool smoothNormals = false;
+    bool useCache      = true;
 
     // Get options
     const cppexpose::VariantMap * map = options.asMap();
     if (map) {
         if (map->count("smoothNormals") > 0) smoothNormals = map->at("smoothNormals").value<bool>();
+        if (map->count("useCache") > 0)      useCache      = map->at("useCache").value<bool>();
+    }
+
+    const std::uint32_t flags = smoothNormals ? MeshCache::flagSmoothNormals : 0u;
+
+    // Get properties of the source file, which are used to detect stale cache files
+    const auto source = cppfs::fs::open(filename);
+    if (!source.exists())
+    {
+        cppassist::error("AssimpMeshLoader") << "File not found: " << filename;
+        return [] () { return nullptr; };
+    }
+
+    const std::uint64_t sourceSize = source.size();
+    const std::uint64_t sourceTime = source.modificationTime();
+    const auto cacheFilename = filename + ".meshcache";
+
+    // Try to map cache file
+    if (useCache)
+    {
+        auto file = std::make_shared<MappedFile>();
+
+        MeshCache::View mesh;
+        if (file->open(cacheFilename) && MeshCache::parse(file->data(), file->size(), sourceSize, sourceTime, flags, mesh))
+        {
+            cppassist::debug("AssimpMeshLoader") << "Loading mesh from cache file " << cacheFilename;
+
+            // The mapping is released after the upload
+            return [file, mesh] () mutable
+            {
+                auto drawable = createDrawable(mesh);
+                file.reset();
+
+                return drawable;
+            };
+        }
     }
 
     // Import scene
@@ -118,6 +255,7 @@ Drawable * AssimpMeshLoader::load(const std::string & filename, const cppexpose:
         filename.c_str(),
         aiProcess_Triangulate           |
         aiProcess_JoinIdenticalVertices |
+        aiProcess_PreTransformVertices  |
         aiProcess_SortByPType |
         (smoothNormals ? aiProcess_GenSmoothNormals : aiProcess_GenNormals));
 
@@ -125,97 +263,163 @@ Drawable * AssimpMeshLoader::load(const std::string & filename, const cppexpose:
     if (!scene)
     {
         cppassist::error("AssimpMeshLoader") << aiGetErrorString();
-        return nullptr;
+        return [] () { return nullptr; };
     }
 
-    // Convert first mesh found in the scene
-    Drawable * geometry = nullptr;
-    if (scene->mNumMeshes > 0) {
-        geometry = convertGeometry(scene->mMeshes[0]);
-    }
+    // Convert all meshes found in the scene
+    auto data = std::make_shared<std::vector<char>>(convertScene(scene, sourceSize, sourceTime, flags));
 
     // Release scene
     aiReleaseImport(scene);
 
-    // Return loaded mesh
-    return geometry;
+    MeshCache::View mesh;
+    if (!MeshCache::parse(data->data(), data->size(), sourceSize, sourceTime, flags, mesh))
+    {
+        cppassist::warning("AssimpMeshLoader") << "No triangle meshes found in " << filename;
+        return [] () { return nullptr; };
+    }
+
+    // Write cache file for subsequent loads
+    if (useCache)
+    {
+        writeCache(cacheFilename, *data);
+    }
+
+    return [data, mesh] () mutable
+    {
+        auto drawable = createDrawable(mesh);
+        data.reset();
+
+        return drawable;
+    };
 }
 
-Drawable * AssimpMeshLoader::convertGeometry(const aiMesh * mesh) const
+std::vector<char> AssimpMeshLoader::convertScene(const aiScene * scene, std::uint64_t sourceSize, std::uint64_t sourceTime, std::uint32_t flags) const
 {
-    // Create geometry
-    Drawable * geometry = new Drawable;
+    // Collect triangle meshes (lines and points are sorted into separate meshes)
+    std::vector<const aiMesh *> meshes;
+    std::uint64_t numVertices = 0;
+    std::uint64_t numIndices  = 0;
+    std::uint32_t attributes  = 0;
 
-    // Copy index array
-    std::vector<unsigned int> indices;
-    for (size_t i = 0; i < mesh->mNumFaces; ++i)
+    for (unsigned int i = 0; i < scene->mNumMeshes; ++i)
     {
-        const auto & face = mesh->mFaces[i];
-        for (auto j = 0u; j < face.mNumIndices; ++j)
-            indices.push_back(face.mIndices[j]);
+        const auto mesh = scene->mMeshes[i];
+        if (!(mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE) || mesh->mNumVertices == 0)
+        {
+            continue;
+        }
+
+        meshes.push_back(mesh);
+
+        numVertices += mesh->mNumVertices;
+        numIndices  += 3u * mesh->mNumFaces;
+
+        if (mesh->HasNormals())        attributes |= MeshCache::attributeNormal;
+        if (mesh->HasTextureCoords(0)) attributes |= MeshCache::attributeTexCoord;
     }
-    globjects::Buffer * indexBuffer = new globjects::Buffer;
-    indexBuffer->setData(std::move(indices), gl::GL_STATIC_DRAW);
-    geometry->setIndexBuffer(indexBuffer);
-    geometry->setSize(indices.size());
-    geometry->setDrawMode(gloperate::DrawMode::ElementsIndexBuffer);
 
-    // Copy vertex array
-    std::vector<glm::vec3> vertices;
-    for (size_t i = 0; i < mesh->mNumVertices; ++i)
+    if (meshes.empty() || numIndices > std::numeric_limits<std::uint32_t>::max())
     {
-        const auto & vertex = mesh->mVertices[i];
-        vertices.push_back({ vertex.x, vertex.y, vertex.z });
+        return std::vector<char>();
     }
-    globjects::Buffer * vertexBuffer = new globjects::Buffer;
-    geometry->setBuffer(0, vertexBuffer);
-    geometry->setData(0, std::move(vertices), gl::GL_STATIC_DRAW);
-    geometry->bindAttribute(0, 0);
-    geometry->setAttributeBindingBuffer(0, 0, 0, sizeof(glm::vec3));
-    geometry->setAttributeBindingFormat(0, 3, gl::GL_FLOAT, gl::GL_FALSE, 0);
-    geometry->enableAttributeBinding(0);
-
-    // Does the mesh contain normal vectors?
-    if (mesh->HasNormals())
+
+    // Choose smallest layout
+    const std::uint32_t numFloats = 3u + ((attributes & MeshCache::attributeNormal) ? 3u : 0u) + ((attributes & MeshCache::attributeTexCoord) ? 3u : 0u);
+    const std::uint32_t indexSize = numVertices <= 65536u ? 2u : 4u;
+
+    MeshCache::Header header;
+    header.magic        = MeshCache::magic;
+    header.version      = MeshCache::version;
+    header.flags        = flags;
+    header.attributes   = attributes;
+    header.sourceSize   = sourceSize;
+    header.sourceTime   = sourceTime;
+    header.vertexCount  = static_cast<std::uint32_t>(numVertices);
+    header.stride       = numFloats * static_cast<std::uint32_t>(sizeof(float));
+    header.indexCount   = 0;
+    header.indexSize    = indexSize;
+    header.submeshCount = static_cast<std::uint32_t>(meshes.size());
+    header.reserved     = 0;
+
+    const size_t submeshOffset = sizeof(MeshCache::Header);
+    const size_t vertexOffset  = submeshOffset + meshes.size() * sizeof(MeshCache::Submesh);
+    const size_t indexOffset   = vertexOffset + static_cast<size_t>(numVertices) * header.stride;
+
+    std::vector<char> data(indexOffset + static_cast<size_t>(numIndices) * indexSize);
+
+    auto submeshes = reinterpret_cast<MeshCache::Submesh *>(data.data() + submeshOffset);
+    auto vertex    = reinterpret_cast<float *>(data.data() + vertexOffset);
+    auto index16   = reinterpret_cast<std::uint16_t *>(data.data() + indexOffset);
+    auto index32   = reinterpret_cast<std::uint32_t *>(data.data() + indexOffset);
+
+    std::uint32_t baseVertex = 0;
+    std::uint32_t indexCount = 0;
+
+    for (size_t m = 0; m < meshes.size(); ++m)
     {
-        // Copy normal array
-        std::vector<glm::vec3> normals;
-        for (size_t i = 0; i < mesh->mNumVertices; ++i)
+        const auto mesh = meshes[m];
+
+        // Copy interleaved vertices, missing attributes are filled with zeros
+        for (unsigned int i = 0; i < mesh->mNumVertices; ++i)
         {
-            const auto & normal = mesh->mNormals[i];
-            normals.push_back({ normal.x, normal.y, normal.z });
+            const auto & position = mesh->mVertices[i];
+            *vertex++ = position.x;
+            *vertex++ = position.y;
+            *vertex++ = position.z;
+
+            if (attributes & MeshCache::attributeNormal)
+            {
+                const auto normal = mesh->HasNormals() ? mesh->mNormals[i] : aiVector3D(0.0f, 0.0f, 0.0f);
+                *vertex++ = normal.x;
+                *vertex++ = normal.y;
+                *vertex++ = normal.z;
+            }
+
+            if (attributes & MeshCache::attributeTexCoord)
+            {
+                const auto textureCoordinate = mesh->HasTextureCoords(0) ? mesh->mTextureCoords[0][i] : aiVector3D(0.0f, 0.0f, 0.0f);
+                *vertex++ = textureCoordinate.x;
+                *vertex++ = textureCoordinate.y;
+                *vertex++ = textureCoordinate.z;
+            }
         }
-        globjects::Buffer * normalBuffer = new globjects::Buffer;
-        geometry->setBuffer(1, normalBuffer);
-        geometry->setData(1, std::move(normals), gl::GL_STATIC_DRAW);
-        geometry->bindAttribute(1, 1);
-        geometry->setAttributeBindingBuffer(1, 1, 0, sizeof(glm::vec3));
-        geometry->setAttributeBindingFormat(1, 3, gl::GL_FLOAT, gl::GL_FALSE, 0);
-        geometry->enableAttributeBinding(1);
-    }
 
-    // Does the mesh contain texture coordinates?
-    if (mesh->HasTextureCoords(0))
-    {
-        // Copy texture cooridinate array
-        std::vector<glm::vec3> textureCoordinates;
-        for (size_t i = 0; i < mesh->mNumVertices; ++i)
+        // Copy triangles, indices are rebased onto the merged vertex array
+        const std::uint32_t firstIndex = indexCount;
+
+        for (unsigned int i = 0; i < mesh->mNumFaces; ++i)
         {
-            const auto & textureCoordinate = mesh->mTextureCoords[0][i];
-            textureCoordinates.push_back({ textureCoordinate.x, textureCoordinate.y, textureCoordinate.z });
+            const auto & face = mesh->mFaces[i];
+            if (face.mNumIndices != 3)
+            {
+                continue;
+            }
+
+            for (unsigned int j = 0; j < 3; ++j)
+            {
+                const auto index = baseVertex + face.mIndices[j];
+
+                if (indexSize == 2)
+                    index16[indexCount++] = static_cast<std::uint16_t>(index);
+                else
+                    index32[indexCount++] = index;
+            }
         }
-        globjects::Buffer * texCoordBuffer = new globjects::Buffer;
-        geometry->setBuffer(2, texCoordBuffer);
-        geometry->setData(2, std::move(textureCoordinates), gl::GL_STATIC_DRAW);
-        geometry->bindAttribute(2, 2);
-        geometry->setAttributeBindingBuffer(2, 2, 0, sizeof(glm::vec3));
-        geometry->setAttributeBindingFormat(2, 3, gl::GL_FLOAT, gl::GL_FALSE, 0);
-        geometry->enableAttributeBinding(2);
+
+        submeshes[m].firstIndex    = firstIndex;
+        submeshes[m].indexCount    = indexCount - firstIndex;
+        submeshes[m].materialIndex = mesh->mMaterialIndex;
+        submeshes[m].reserved      = 0;
+
+        baseVertex += mesh->mNumVertices;
     }
 
-    // Materials
-    //geometry->setMaterialIndex(mesh->mMaterialIndex);
+    // Drop space of skipped faces
+    header.indexCount = indexCount;
+    data.resize(indexOffset + static_cast<size_t>(indexCount) * indexSize);
 
-    // Return geometry
-    return geometry;
+    std::memcpy(data.data(), &header, sizeof(MeshCache::Header));
+
+    return data;
 }
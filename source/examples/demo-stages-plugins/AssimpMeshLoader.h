@@ -2,13 +2,15 @@
 #pragma once
 
 
+#include <cstdint>
+#include <vector>
+
 #include <cppexpose/plugin/plugin_api.h>
 
 #include <gloperate/gloperate-version.h>
 #include <gloperate/base/Loader.h>
 
 
-struct aiMesh;
 struct aiScene;
 
 namespace gloperate
@@ -21,8 +23,19 @@ namespace gloperate
 *  @brief
 *    Loader for meshes (PolygonalGeometry) that uses ASSIMP for import
 *
+*    All triangle meshes of a scene are merged into a single drawable
+*    with interleaved vertices (position, normal, texture coordinate)
+*    and one draw range per submesh (see Drawable::ranges()).
+*
+*    After the first import, the converted mesh is stored in a binary
+*    cache file next to the source file ("<filename>.meshcache"). As long
+*    as size and modification time of the source file and the loading
+*    options match, later loads map the cache file into memory and upload
+*    it directly, without invoking ASSIMP.
+*
 *  Supported options:
 *    "smoothNormals" <bool>: Generate smooth normals
+*    "useCache" <bool>: Read and write the binary cache file (default: true)
 */
 class AssimpMeshLoader : public gloperate::Loader<gloperate::Drawable>
 {
@@ -32,7 +45,7 @@ public:
       , "" // Tags
       , "" // Icon
       , "" // Annotations
-      , "Load a shader from a source code file"
+      , "Load a mesh from a 3D model file"
       , GLOPERATE_AUTHOR_ORGANIZATION
       , "v1.0.0"
     )
@@ -56,18 +69,25 @@ public:
     virtual std::vector<std::string> loadingTypes() const override;
     virtual std::string allLoadingTypes() const override;
     virtual gloperate::Drawable * load(const std::string & filename, const cppexpose::Variant & options, std::function<void(int, int)> progress) const override;
+    virtual std::function<gloperate::Drawable *()> prepare(const std::string & filename, const cppexpose::Variant & options, std::function<void(int, int)> progress) const override;
 
 
 protected:
     /**
     *  @brief
-    *    Convert ASSIMP mesh into gloperate mesh
+    *    Convert ASSIMP scene into the binary mesh format
     *
-    *  @param[in] mesh
-    *    ASSIMP mesh (must be valid!)
+    *  @param[in] scene
+    *    ASSIMP scene (must be valid!)
+    *  @param[in] sourceSize
+    *    Size of the source file
+    *  @param[in] sourceTime
+    *    Modification time of the source file
+    *  @param[in] flags
+    *    Loading flags that have been used for the import
     *
     *  @return
-    *    Mesh, must be destroyed by the caller
+    *    Mesh data in the layout of the cache file (empty if the scene contains no triangles)
     */
-    gloperate::Drawable * convertGeometry(const aiMesh * mesh) const;
+    std::vector<char> convertScene(const aiScene * scene, std::uint64_t sourceSize, std::uint64_t sourceTime, std::uint32_t flags) const;
 };
@@ -0,0 +1,67 @@
+
+#include "MeshCache.h"
+
+#include <cstring>
+
+
+const std::uint32_t MeshCache::magic   = 0x48534d47; // "GMSH"
+const std::uint32_t MeshCache::version = 2; // 2: vertices are transformed by the node hierarchy
+
+const std::uint32_t MeshCache::flagSmoothNormals = 1u << 0;
+
+const std::uint32_t MeshCache::attributeNormal   = 1u << 0;
+const std::uint32_t MeshCache::attributeTexCoord = 1u << 1;
+
+
+bool MeshCache::parse(const char * data, size_t size, std::uint64_t sourceSize, std::uint64_t sourceTime, std::uint32_t flags, View & mesh)
+{
+    if (size < sizeof(Header))
+    {
+        return false;
+    }
+
+    auto & header = mesh.header;
+    std::memcpy(&header, data, sizeof(Header));
+
+    // Reject foreign, outdated, or stale data
+    if (header.magic != magic || header.version != version || header.flags != flags ||
+        header.sourceSize != sourceSize || header.sourceTime != sourceTime)
+    {
+        return false;
+    }
+
+    if (header.vertexCount == 0 || header.indexCount == 0 || header.submeshCount == 0 ||
+        (header.indexSize != 2 && header.indexSize != 4))
+    {
+        return false;
+    }
+
+    const size_t vertexOffset = sizeof(Header) + static_cast<size_t>(header.submeshCount) * sizeof(Submesh);
+    const size_t indexOffset  = vertexOffset + static_cast<size_t>(header.vertexCount) * header.stride;
+
+    // Files that have not been written completely are detected by their size
+    if (size != indexOffset + static_cast<size_t>(header.indexCount) * header.indexSize)
+    {
+        return false;
+    }
+
+    mesh.ranges.resize(header.submeshCount);
+
+    for (std::uint32_t i = 0; i < header.submeshCount; ++i)
+    {
+        Submesh submesh;
+        std::memcpy(&submesh, data + sizeof(Header) + i * sizeof(Submesh), sizeof(Submesh));
+
+        if (static_cast<std::uint64_t>(submesh.firstIndex) + submesh.indexCount > header.indexCount)
+        {
+            return false;
+        }
+
+        mesh.ranges[i] = { static_cast<gl::GLint>(submesh.firstIndex), static_cast<gl::GLsizei>(submesh.indexCount) };
+    }
+
+    mesh.vertices = data + vertexOffset;
+    mesh.indices  = data + indexOffset;
+
+    return true;
+}
@@ -0,0 +1,106 @@
+
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <gloperate/rendering/Drawable.h>
+
+
+/**
+*  @brief
+*    Binary format of the mesh cache files written by AssimpMeshLoader
+*
+*    A cache file consists of a header, a table of submeshes, the
+*    interleaved vertices and the indices. The header records the
+*    source file and the loading flags, so stale files are rejected.
+*/
+class MeshCache
+{
+public:
+    static const std::uint32_t magic;   ///< Magic number ("GMSH")
+    static const std::uint32_t version; ///< Current format version
+
+    // Loading flags
+    static const std::uint32_t flagSmoothNormals; ///< Normals have been generated smooth
+
+    // Vertex attributes following the position
+    static const std::uint32_t attributeNormal;   ///< Vertices contain a normal
+    static const std::uint32_t attributeTexCoord; ///< Vertices contain a texture coordinate
+
+
+    /**
+    *  @brief
+    *    File header
+    */
+    struct Header
+    {
+        std::uint32_t magic;        ///< Magic number (MeshCache::magic)
+        std::uint32_t version;      ///< Format version (MeshCache::version)
+        std::uint32_t flags;        ///< Loading flags used for the import
+        std::uint32_t attributes;   ///< Vertex attributes in addition to the position
+        std::uint64_t sourceSize;   ///< Size of the source file
+        std::uint64_t sourceTime;   ///< Modification time of the source file
+        std::uint32_t vertexCount;  ///< Number of vertices
+        std::uint32_t stride;       ///< Size of a vertex (in bytes)
+        std::uint32_t indexCount;   ///< Number of indices
+        std::uint32_t indexSize;    ///< Size of an index (2 or 4 bytes)
+        std::uint32_t submeshCount; ///< Number of submeshes
+        std::uint32_t reserved;     ///< Padding
+    };
+
+    /**
+    *  @brief
+    *    Entry of the submesh table
+    */
+    struct Submesh
+    {
+        std::uint32_t firstIndex;    ///< Position of the first index of the submesh
+        std::uint32_t indexCount;    ///< Number of indices of the submesh
+        std::uint32_t materialIndex; ///< Material index of the source mesh
+        std::uint32_t reserved;      ///< Padding
+    };
+
+    /**
+    *  @brief
+    *    Parsed mesh data, pointing into the cache data
+    */
+    struct View
+    {
+        Header                            header;   ///< Header of the mesh data
+        std::vector<gloperate::DrawRange> ranges;   ///< Index ranges of the submeshes
+        const char                      * vertices; ///< Interleaved vertex data
+        const char                      * indices;  ///< Index data
+    };
+
+
+public:
+    /**
+    *  @brief
+    *    Parse mesh cache data
+    *
+    *  @param[in] data
+    *    Cache data (must NOT be null!)
+    *  @param[in] size
+    *    Size of the cache data (in bytes)
+    *  @param[in] sourceSize
+    *    Size of the current source file
+    *  @param[in] sourceTime
+    *    Modification time of the current source file
+    *  @param[in] flags
+    *    Loading flags of the current load
+    *  @param[out] mesh
+    *    Parsed mesh (undefined if the data is rejected)
+    *
+    *  @return
+    *    'true' if the data is valid and matches source file and flags, else 'false'
+    *
+    *  @remarks
+    *    Data of another format version, of a modified source file or of
+    *    another import configuration is rejected, as well as data that is
+    *    inconsistent, e.g., because the file has not been written completely.
+    */
+    static bool parse(const char * data, size_t size, std::uint64_t sourceSize, std::uint64_t sourceTime, std::uint32_t flags, View & mesh);
+};
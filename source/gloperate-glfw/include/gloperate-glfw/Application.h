@@ -116,6 +116,29 @@ public:
     */
     int exitCode();
 
+    /**
+    *  @brief
+    *    Check if the main loop is unlocked
+    *
+    *  @return
+    *    'true' if the main loop runs as fast as possible, else 'false'
+    */
+    bool isUnlocked() const;
+
+    /**
+    *  @brief
+    *    Set if the main loop is unlocked
+    *
+    *  @param[in] unlocked
+    *    'true' if the main loop runs as fast as possible, else 'false'
+    *
+    *  @remarks
+    *    By default, the main loop blocks until an event arrives, the
+    *    next scripting timer is due, or wakeup() is called. Unlocking
+    *    the main loop is useful for batch rendering.
+    */
+    void setUnlocked(bool unlocked);
+
 
 protected:
     /**
@@ -124,15 +147,26 @@ protected:
     */
     void processEvents();
 
+    /**
+    *  @brief
+    *    Wait until an event arrives, the next timer is due, or wakeup() is called
+    *
+    *  @remarks
+    *    Does not block if the main loop is unlocked.
+    */
+    void waitEvents();
+
 
 protected:
     static Application * s_app; ///< Pointer to the current application instance, can be nullptr
 
 
 protected:
-    gloperate::Environment * m_environment; ///< Gloperate environment
-    bool                     m_running;     ///< 'true' if application is currently running, else 'false'
-    int                      m_exitCode;    ///< Exit code (0 for no error, > 0 for error)
+    gloperate::Environment    * m_environment;      ///< Gloperate environment
+    bool                        m_running;          ///< 'true' if application is currently running, else 'false'
+    int                         m_exitCode;         ///< Exit code (0 for no error, > 0 for error)
+    bool                        m_unlocked;         ///< 'true' if the main loop does not wait for events, else 'false'
+    int                         m_wakeupHandler;    ///< ID of the wakeup handler registered at the environment
 };
 
 
@@ -2,8 +2,6 @@
 #include <gloperate-glfw/Application.h>
 
 #include <cassert>
-#include <chrono>
-#include <thread>
 
 #include <GLFW/glfw3.h>
 
@@ -43,6 +41,8 @@ Application::Application(gloperate::Environment * environment, int &, char **)
 : m_environment(environment)
 , m_running(false)
 , m_exitCode(0)
+, m_unlocked(false)
+, m_wakeupHandler(0)
 {
     // Make sure that no application object has already been instanciated
     assert(!s_app);
@@ -53,12 +53,20 @@ Application::Application(gloperate::Environment * environment, int &, char **)
     {
         Application::quit(exitCode);
     });
+
+    // Register wakeup handler (may be called from worker threads)
+    m_wakeupHandler = environment->addWakeupHandler([] ()
+    {
+        Application::wakeup();
+    });
 }
 
 Application::~Application()
 {
     // Deregister application
     s_app = nullptr;
+
+    m_environment->removeWakeupHandler(m_wakeupHandler);
 }
 
 int Application::run()
@@ -76,9 +84,9 @@ int Application::run()
     // Execute main loop
     while (m_running)
     {
-        // Wait until events arrive.
+        // Wait until events arrive or the next timer is due.
         // To unlock the main loop, call wakeup().
-        glfwWaitEvents();
+        waitEvents();
         processEvents();
     }
 
@@ -94,6 +102,9 @@ void Application::stop(int code)
     // Stop application, return the given exit code
     m_exitCode = code;
     m_running  = false;
+
+    // Make sure the main loop notices
+    wakeup();
 }
 
 bool Application::isRunning() const
@@ -106,6 +117,18 @@ int Application::exitCode()
     return m_exitCode;
 }
 
+bool Application::isUnlocked() const
+{
+    return m_unlocked;
+}
+
+void Application::setUnlocked(bool unlocked)
+{
+    m_unlocked = unlocked;
+
+    wakeup();
+}
+
 void Application::processEvents()
 {
     // Get messages for all windows
@@ -125,12 +148,34 @@ void Application::processEvents()
 
     // Update scripting timers
     m_environment->timerManager()->update();
+}
 
-    // Make sure we don't saturate the CPU 
-    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+void Application::waitEvents()
+{
+    // Do not block in unlocked mode
+    if (m_unlocked)
+    {
+        glfwPollEvents();
+        return;
+    }
 
-    // Wake up mainloop to enable continuous update/simulation
-    wakeup();
+    // Continuous rendering keeps the loop alive by itself, as each
+    // repaint request posts an empty event via wakeup(). Otherwise,
+    // block until an event arrives or the next scripting timer is due.
+    const float timeout = m_environment->timerManager()->remainingTime();
+
+    if (timeout < 0.0f)
+    {
+        glfwWaitEvents();
+    }
+    else if (timeout > 0.0f)
+    {
+        glfwWaitEventsTimeout(timeout);
+    }
+    else
+    {
+        glfwPollEvents();
+    }
 }
 
 
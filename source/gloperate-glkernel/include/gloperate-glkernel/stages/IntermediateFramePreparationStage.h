@@ -71,11 +71,6 @@ protected:
     virtual void onContextInit(gloperate::AbstractGLContext * context) override;
     virtual void onContextDeinit(gloperate::AbstractGLContext * context) override;
     virtual void onProcess() override;
-
-
-protected:
-    // Data
-    std::unique_ptr<globjects::Framebuffer> m_targetFBO;  ///< Framebuffer for blitting target
 };
 
 
@@ -9,6 +9,7 @@
 #include <globjects/FramebufferAttachment.h>
 #include <globjects/AttachedTexture.h>
 
+#include <gloperate/base/Environment.h>
 #include <gloperate/rendering/ColorRenderTarget.h>
 #include <gloperate/rendering/AttachmentType.h>
 
@@ -35,8 +36,6 @@ IntermediateFramePreparationStage::~IntermediateFramePreparationStage()
 
 void IntermediateFramePreparationStage::onContextInit(gloperate::AbstractGLContext * /*context*/)
 {
-    m_targetFBO = cppassist::make_unique<globjects::Framebuffer>();
-
     renderInterface.onContextInit();
 
     intermediateFrameTextureOut.invalidate();
@@ -44,8 +43,6 @@ void IntermediateFramePreparationStage::onContextInit(gloperate::AbstractGLConte
 
 void IntermediateFramePreparationStage::onContextDeinit(gloperate::AbstractGLContext * /*context*/)
 {
-    m_targetFBO = nullptr;
-
     renderInterface.onContextDeinit();
 
     intermediateFrameTextureOut.setValue(nullptr);
@@ -73,13 +70,9 @@ void IntermediateFramePreparationStage::onProcess()
         auto sourceFBO = renderInterface.obtainFBO(0, *intermediateRenderTarget);
         auto sourceAttachment = (*intermediateRenderTarget)->drawBufferAttachment(0);
 
-        auto targetFBO = m_targetFBO.get();
         auto targetAttachment = gl::GL_COLOR_ATTACHMENT0;
+        auto targetFBO = environment()->framebufferCache()->framebuffer({ { targetAttachment, *intermediateFrameTexture, nullptr } }, {});
 
-        targetFBO->attachTexture(targetAttachment, *intermediateFrameTexture);
-
-        sourceFBO->printStatus(true);
-        targetFBO->printStatus(true);
         sourceFBO->blit(sourceAttachment, rect, targetFBO, targetAttachment, rect, gl::GL_COLOR_BUFFER_BIT, gl::GL_NEAREST);
     }
 
@@ -64,7 +64,6 @@ void MultiFrameAggregationStage::onProcess()
     );
 
     fbo->bind(gl::GL_FRAMEBUFFER);
-    fbo->printStatus(true);
 
     if (*aggregationFactor > 0.99f) // first frame, no blending required
     {
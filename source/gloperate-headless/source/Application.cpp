@@ -3,7 +3,8 @@
 
 #include <cassert>
 #include <chrono>
-#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include <cppassist/logging/logging.h>
 
@@ -20,6 +21,16 @@
 using namespace egl;
 
 
+namespace
+{
+    // There are no native events in headless mode, so the main loop
+    // waits on a condition variable that is signaled by wakeup()
+    std::mutex              s_wakeupMutex;
+    std::condition_variable s_wakeupCondition;
+    bool                    s_wakeupPending = false;
+}
+
+
 namespace gloperate_headless
 {
 
@@ -45,14 +56,21 @@ void Application::quit(int code)
 
 void Application::wakeup()
 {
-    // TODO: empty?
+    {
+        std::lock_guard<std::mutex> lock(s_wakeupMutex);
+        s_wakeupPending = true;
+    }
+
+    s_wakeupCondition.notify_one();
 }
 
 Application::Application(gloperate::Environment * environment, int &, char **)
 : m_environment(environment)
 , m_running(false)
 , m_exitCode(0)
+, m_unlocked(false)
 , m_display(nullptr)
+, m_wakeupHandler(0)
 {
     // Make sure that no application object has already been instanciated
     assert(!s_app);
@@ -64,6 +82,12 @@ Application::Application(gloperate::Environment * environment, int &, char **)
         Application::quit(exitCode);
     });
 
+    // Register wakeup handler (may be called from worker threads)
+    m_wakeupHandler = environment->addWakeupHandler([] ()
+    {
+        Application::wakeup();
+    });
+
     m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
 
     assert(m_display != nullptr);
@@ -84,6 +108,8 @@ Application::~Application()
     // Deregister application
     s_app = nullptr;
 
+    m_environment->removeWakeupHandler(m_wakeupHandler);
+
     if (m_display != nullptr)
     {
         cppassist::debug("gloperate-headless") << "Terminate EGL Display " << m_display;
@@ -110,6 +136,13 @@ int Application::run()
         // Wait until drawing finished.
         processEvents();
         eglWaitClient();
+
+        // Wait until a surface requests an update or the next timer is due.
+        // To unlock the main loop, call wakeup().
+        if (m_running)
+        {
+            waitEvents();
+        }
     }
 
     // Return with exit code
@@ -143,6 +176,9 @@ void Application::stop(int code)
     // Stop application, return the given exit code
     m_exitCode = code;
     m_running  = false;
+
+    // Make sure the main loop notices
+    wakeup();
 }
 
 bool Application::isRunning() const
@@ -155,6 +191,18 @@ int Application::exitCode()
     return m_exitCode;
 }
 
+bool Application::isUnlocked() const
+{
+    return m_unlocked;
+}
+
+void Application::setUnlocked(bool unlocked)
+{
+    m_unlocked = unlocked;
+
+    wakeup();
+}
+
 void Application::processEvents()
 {
     // Get messages for all surfaces
@@ -174,12 +222,31 @@ void Application::processEvents()
 
     // Update scripting timers
     m_environment->timerManager()->update();
+}
 
-    // Make sure we don't saturate the CPU 
-    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+void Application::waitEvents()
+{
+    std::unique_lock<std::mutex> lock(s_wakeupMutex);
 
-    // Wake up mainloop to enable continuous update/simulation
-    wakeup();
+    // Do not block in unlocked mode
+    if (!m_unlocked)
+    {
+        // Continuous rendering keeps the loop alive by itself, as each
+        // repaint request calls wakeup(). Otherwise, block until woken
+        // up or the next scripting timer is due.
+        const float timeout = m_environment->timerManager()->remainingTime();
+
+        if (timeout < 0.0f)
+        {
+            s_wakeupCondition.wait(lock, [] () { return s_wakeupPending; });
+        }
+        else if (timeout > 0.0f)
+        {
+            s_wakeupCondition.wait_for(lock, std::chrono::duration<float>(timeout), [] () { return s_wakeupPending; });
+        }
+    }
+
+    s_wakeupPending = false;
 }
 
 
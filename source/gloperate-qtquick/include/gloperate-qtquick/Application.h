@@ -117,9 +117,10 @@ protected:
 
 
 protected:
-    gloperate::Environment m_environment; ///< Main gloperate environment
-    QmlEngine              m_qmlEngine;   ///< Spezialied QML engine for gloperate
-    QTimer                 m_timer;       ///< Global timer (e.g., to update scripting timers)
+    gloperate::Environment      m_environment;      ///< Main gloperate environment
+    QmlEngine                   m_qmlEngine;        ///< Spezialied QML engine for gloperate
+    QTimer                      m_timer;            ///< Global timer (e.g., to update scripting timers)
+    int                         m_wakeupHandler;    ///< ID of the wakeup handler registered at the environment
 };
 
 
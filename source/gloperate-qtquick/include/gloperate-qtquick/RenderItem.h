@@ -21,6 +21,7 @@ namespace globjects
 namespace gloperate
 {
     class Canvas;
+    class Environment;
 }
 
 
@@ -104,11 +105,32 @@ protected:
     */
     void onTimer();
 
+    /**
+    *  @brief
+    *    Called when the item is added to or removed from a window
+    *
+    *  @param[in] window
+    *    New window (can be null)
+    */
+    void onWindowChanged(QQuickWindow * window);
+
+    /**
+    *  @brief
+    *    Schedule an update of the canvas timing in the next event loop iteration
+    *
+    *  @remarks
+    *    Thread-safe, can be called from the render thread or worker threads.
+    */
+    void scheduleUpdate();
+
 
 protected:
-    QString                            m_stage;  ///< Name of the render stage to use
-    QTimer                             m_timer;  ///< Timer for continuous update
-    std::unique_ptr<gloperate::Canvas> m_canvas; ///< Canvas that renders into the item (must NOT be null)
+    QString                            m_stage;            ///< Name of the render stage to use
+    QTimer                             m_timer;            ///< Timer for continuous update (triggered after each frame and on wakeup)
+    std::unique_ptr<gloperate::Canvas> m_canvas;           ///< Canvas that renders into the item (must NOT be null)
+    QMetaObject::Connection            m_frameConnection;  ///< Connection to the frameSwapped signal of the current window
+    gloperate::Environment           * m_environment;      ///< Environment the wakeup handler is registered at (can be null)
+    int                                m_wakeupHandler;    ///< ID of the wakeup handler registered at the environment
 };
 
 
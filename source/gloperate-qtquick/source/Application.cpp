@@ -1,6 +1,8 @@
 
 #include <gloperate-qtquick/Application.h>
 
+#include <cmath>
+
 #include <QUrl>
 #include <QQmlContext>
 #include <QSurfaceFormat>
@@ -31,6 +33,7 @@ Application::Application(int & argc, char ** argv)
 : QGuiApplication(argc, argv)
 , m_environment()
 , m_qmlEngine(&m_environment)
+, m_wakeupHandler(0)
 {
     // Read command line options
     cppassist::ArgumentParser argumentParser;
@@ -84,11 +87,20 @@ Application::Application(int & argc, char ** argv)
         this, &Application::onTimer
     );
 
-    m_timer.start(5);
+    // The timer is rescheduled for the next due scripting timer
+    m_timer.setSingleShot(true);
+    m_timer.start(0);
+
+    // Reschedule timer on wakeup (may be called from worker threads)
+    m_wakeupHandler = m_environment.addWakeupHandler([this] ()
+    {
+        QMetaObject::invokeMethod(&m_timer, "start", Qt::QueuedConnection, Q_ARG(int, 0));
+    });
 }
 
 Application::~Application()
 {
+    m_environment.removeWakeupHandler(m_wakeupHandler);
 }
 
 const QString & Application::gloperateModulePath() const
@@ -125,6 +137,14 @@ void Application::onTimer()
 {
     // Update scripting timers
     m_environment.timerManager()->update();
+
+    // Sleep until the next scripting timer is due
+    const float remaining = m_environment.timerManager()->remainingTime();
+
+    if (remaining >= 0.0f)
+    {
+        m_timer.start(static_cast<int>(std::ceil(remaining * 1000.0f)));
+    }
 }
 
 
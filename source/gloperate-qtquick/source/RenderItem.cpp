@@ -31,6 +31,8 @@ RenderItem::RenderItem(QQuickItem * parent)
 : QQuickFramebufferObject(parent)
 , m_stage("")
 , m_canvas(nullptr)
+, m_environment(nullptr)
+, m_wakeupHandler(0)
 {
     // Set input modes
     setAcceptedMouseButtons(Qt::AllButtons);
@@ -43,13 +45,24 @@ RenderItem::RenderItem(QQuickItem * parent)
         this, &RenderItem::onTimer
     );
 
-    // Start timer
-    m_timer.setSingleShot(false);
-    m_timer.start(5);
+    // Instead of polling, the timer is triggered after each frame and on wakeup.
+    // Continuous rendering keeps itself alive, as updateTime() requests
+    // a redraw as long as the pipeline depends on the time delta.
+    m_timer.setSingleShot(true);
+
+    QObject::connect(
+        this, &QQuickItem::windowChanged,
+        this, &RenderItem::onWindowChanged
+    );
 }
 
 RenderItem::~RenderItem()
 {
+    // Remove wakeup handler before the timer is destroyed
+    if (m_environment)
+    {
+        m_environment->removeWakeupHandler(m_wakeupHandler);
+    }
 }
 
 gloperate::Canvas * RenderItem::canvas() const
@@ -92,6 +105,18 @@ QQuickFramebufferObject::Renderer * RenderItem::createRenderer() const
         self->update();
     } );
 
+    // Update timing when the application is woken up, e.g., by finished loads
+    if (m_environment)
+    {
+        m_environment->removeWakeupHandler(m_wakeupHandler);
+    }
+
+    self->m_environment   = environment;
+    self->m_wakeupHandler = environment->addWakeupHandler([self] ()
+    {
+        self->scheduleUpdate();
+    } );
+
     // Load initial stage
     m_canvas->loadRenderStage(m_stage.toStdString());
 
@@ -214,5 +239,29 @@ void RenderItem::onTimer()
     m_canvas->updateTime();
 }
 
+void RenderItem::onWindowChanged(QQuickWindow * window)
+{
+    QObject::disconnect(m_frameConnection);
+
+    if (!window)
+    {
+        return;
+    }
+
+    // frameSwapped is emitted on the render thread
+    m_frameConnection = QObject::connect(
+        window, &QQuickWindow::frameSwapped,
+        this, &RenderItem::scheduleUpdate,
+        Qt::DirectConnection
+    );
+
+    scheduleUpdate();
+}
+
+void RenderItem::scheduleUpdate()
+{
+    QMetaObject::invokeMethod(&m_timer, "start", Qt::QueuedConnection, Q_ARG(int, 0));
+}
+
 
 } // namespace gloperate_qtquick
@@ -4,6 +4,9 @@
 
 #include <vector>
 
+#include <openll/GlyphVertexCloud.h>
+#include <openll/Label.h>
+
 #include <gloperate/pipeline/Stage.h>
 
 #include <gloperate-text/gloperate-text_api.h>
@@ -14,8 +17,6 @@ namespace openll
 
 
 class FontFace;
-class Label;
-class GlyphVertexCloud;
 
 
 } // namespace openll
@@ -25,6 +26,21 @@ namespace gloperate_text
 {
 
 
+/**
+*  @brief
+*    Stage that typesets glyph sequences into a vertex cloud
+*
+*    Each sequence is typeset separately and its vertices are cached.
+*    Sequences are compared to the ones of the last update, and only
+*    those that differ are typeset again and patched into the vertex
+*    cloud. If the number of vertices or sequences changes, the vertex
+*    cloud is rebuilt from the cache. A change of the font typesets all
+*    sequences. Larger sets of sequences are typeset in parallel on the
+*    thread pool of the environment.
+*
+*    If 'optimized' is set, the vertices of all sequences are reordered
+*    together, so all sequences are typeset at once without caching.
+*/
 class GLOPERATE_TEXT_API GlyphPreparationStage : public gloperate::Stage
 {
 public:
@@ -45,9 +61,39 @@ protected:
     virtual void onContextDeinit(gloperate::AbstractGLContext * context) override;
     virtual void onProcess() override;
 
+    /**
+    *  @brief
+    *    Typeset sequences into the per-sequence vertex cache
+    *
+    *  @param[in] indices
+    *    Indices of the sequences to typeset
+    */
+    void typesetSequences(const std::vector<size_t> & indices);
+
+    /**
+    *  @brief
+    *    Typeset a range of sequences using one of the typesetting clouds
+    *
+    *  @param[in] cloud
+    *    Vertex cloud used for typesetting (must NOT be used concurrently!)
+    *  @param[in] begin
+    *    First index of the range in 'indices'
+    *  @param[in] end
+    *    Index behind the last index of the range in 'indices'
+    *  @param[in] indices
+    *    Indices of the sequences to typeset
+    */
+    void typesetRange(openll::GlyphVertexCloud & cloud, size_t begin, size_t end, const std::vector<size_t> & indices);
+
 
 protected:
-    std::unique_ptr<openll::GlyphVertexCloud> m_vertexCloud;
+    using Vertices = std::vector<openll::GlyphVertexCloud::Vertex>;
+
+    std::unique_ptr<openll::GlyphVertexCloud>              m_vertexCloud;      ///< Vertex cloud of all sequences
+    std::vector<std::unique_ptr<openll::GlyphVertexCloud>> m_typesetClouds;    ///< Vertex clouds for typesetting single sequences (one per concurrent task, created on demand)
+    std::vector<openll::Label>                             m_typesetSequences; ///< Copy of the sequences typeset in the last update
+    std::vector<Vertices>                                  m_sequenceVertices; ///< Cached vertices per sequence
+    std::vector<size_t>                                    m_sequenceOffsets;  ///< Offset of each sequence in the vertex cloud (plus total size)
 };
 
 
@@ -3,6 +3,7 @@
 
 
 #include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
 
 #include <gloperate/pipeline/Stage.h>
 #include <gloperate/stages/interfaces/RenderInterface.h>
@@ -44,6 +45,7 @@ public:
 
     Input<openll::GlyphVertexCloud *> vertexCloud;
     Input<gloperate::Camera *> camera;
+    Input<glm::mat4> tileMatrix; ///< Matrix applied after the camera projection (e.g., set by ImageExporter for tiled rendering)
 
 
 public:
@@ -1,12 +1,43 @@
 
 #include <gloperate-text/stages/GlyphPreparationStage.h>
 
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+
 #include <glm/vec2.hpp>
 
 #include <openll/FontFace.h>
+#include <openll/Label.h>
 #include <openll/Typesetter.h>
 #include <openll/GlyphVertexCloud.h>
 
+#include <gloperate/base/Environment.h>
+#include <gloperate/base/ThreadPool.h>
+
+
+namespace
+{
+    // Minimum number of sequences per concurrent typesetting task
+    const size_t s_minSequencesPerTask = 64;
+
+
+    // Check if two sequences produce the same glyph vertices
+    bool typesetEqual(const openll::Label & a, const openll::Label & b)
+    {
+        return a.text()       == b.text()
+            && a.fontFace()   == b.fontFace()
+            && a.fontSize()   == b.fontSize()
+            && a.wordWrap()   == b.wordWrap()
+            && a.lineWidth()  == b.lineWidth()
+            && a.alignment()  == b.alignment()
+            && a.lineAnchor() == b.lineAnchor()
+            && a.transform()  == b.transform()
+            && a.margins()    == b.margins()
+            && a.textColor()  == b.textColor();
+    }
+}
+
 
 namespace gloperate_text
 {
@@ -29,19 +60,113 @@ void GlyphPreparationStage::onContextInit(gloperate::AbstractGLContext *)
 {
     m_vertexCloud = cppassist::make_unique<openll::GlyphVertexCloud>();
 
+    // Typesetting clouds are created on demand
+    m_typesetClouds.clear();
+
+    // Typeset all sequences on the next update
+    m_typesetSequences.clear();
+    m_sequenceVertices.clear();
+    m_sequenceOffsets.clear();
+
     vertexCloud.invalidate();
 }
 
 void GlyphPreparationStage::onContextDeinit(gloperate::AbstractGLContext *)
 {
     m_vertexCloud = nullptr;
+    m_typesetClouds.clear();
 
     vertexCloud.setValue(nullptr);
 }
 
 void GlyphPreparationStage::onProcess()
 {
-    openll::Typesetter::typeset(*m_vertexCloud.get(), *sequences.value(), optimized.value(), false);
+    const auto & labels = *sequences.value();
+
+    // Optimization reorders the vertices of all sequences together, so typeset them as a whole
+    if (optimized.value())
+    {
+        m_typesetSequences.clear();
+        m_sequenceVertices.clear();
+        m_sequenceOffsets.clear();
+
+        openll::Typesetter::typeset(*m_vertexCloud, labels, true, false);
+
+        m_vertexCloud->update(); // update drawable
+        m_vertexCloud->setTexture(font.value()->glyphTexture());
+
+        vertexCloud.setValue(m_vertexCloud.get());
+
+        return;
+    }
+
+    // Determine sequences that differ from the ones typeset last time
+    const bool typesetAll = font.hasChanged() || optimized.hasChanged() || m_typesetSequences.empty();
+    const bool resized    = labels.size() != m_typesetSequences.size();
+
+    std::vector<size_t> indices;
+
+    for (size_t i = 0; i < labels.size(); ++i)
+    {
+        if (typesetAll || i >= m_typesetSequences.size() || !typesetEqual(labels[i], m_typesetSequences[i]))
+        {
+            indices.push_back(i);
+        }
+    }
+
+    m_typesetSequences = labels;
+
+    // Remember sizes of changed sequences
+    std::vector<size_t> oldSizes(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        oldSizes[i] = (indices[i] < m_sequenceVertices.size()) ? m_sequenceVertices[indices[i]].size() : 0;
+    }
+
+    m_sequenceVertices.resize(labels.size());
+
+    typesetSequences(indices);
+
+    // Patch changed sequences in place if their number of vertices did not change
+    auto & vertices = m_vertexCloud->vertices();
+
+    bool patch = !typesetAll && !resized && m_sequenceOffsets.size() == labels.size() + 1 && vertices.size() == m_sequenceOffsets.back();
+    for (size_t i = 0; patch && i < indices.size(); ++i)
+    {
+        patch = m_sequenceVertices[indices[i]].size() == oldSizes[i];
+    }
+
+    if (patch)
+    {
+        // Nothing to upload if no sequence has changed
+        if (indices.empty())
+        {
+            vertexCloud.setValue(m_vertexCloud.get());
+            return;
+        }
+
+        for (auto index : indices)
+        {
+            std::copy(m_sequenceVertices[index].begin(), m_sequenceVertices[index].end(), vertices.begin() + m_sequenceOffsets[index]);
+        }
+    }
+    else
+    {
+        // Rebuild vertex cloud from all sequences
+        m_sequenceOffsets.resize(labels.size() + 1);
+        m_sequenceOffsets[0] = 0;
+        for (size_t i = 0; i < labels.size(); ++i)
+        {
+            m_sequenceOffsets[i + 1] = m_sequenceOffsets[i] + m_sequenceVertices[i].size();
+        }
+
+        vertices.clear();
+        vertices.reserve(m_sequenceOffsets.back());
+        for (const auto & sequenceVertices : m_sequenceVertices)
+        {
+            vertices.insert(vertices.end(), sequenceVertices.begin(), sequenceVertices.end());
+        }
+    }
 
     m_vertexCloud->update(); // update drawable
     m_vertexCloud->setTexture(font.value()->glyphTexture());
@@ -49,5 +174,78 @@ void GlyphPreparationStage::onProcess()
     vertexCloud.setValue(m_vertexCloud.get());
 }
 
+void GlyphPreparationStage::typesetSequences(const std::vector<size_t> & indices)
+{
+    const auto threadPool = environment()->threadPool();
+
+    // Typeset small sets on the calling thread
+    const auto maxTasks = static_cast<size_t>(threadPool->numThreads()) + 1;
+    const auto numTasks = std::min(maxTasks, (indices.size() + s_minSequencesPerTask - 1) / s_minSequencesPerTask);
+
+    // Create only as many typesetting clouds as there are concurrent tasks
+    while (m_typesetClouds.size() < std::max(numTasks, size_t(1)))
+    {
+        m_typesetClouds.push_back(cppassist::make_unique<openll::GlyphVertexCloud>());
+    }
+
+    if (numTasks <= 1 || gloperate::ThreadPool::isWorkerThread())
+    {
+        typesetRange(*m_typesetClouds.front(), 0, indices.size(), indices);
+        return;
+    }
+
+    // Typeset ranges of sequences concurrently, the last range on the calling thread
+    std::mutex              mutex;
+    std::condition_variable condition;
+    size_t                  numFinished = 0;
+
+    const auto rangeSize = (indices.size() + numTasks - 1) / numTasks;
+
+    for (size_t task = 0; task + 1 < numTasks; ++task)
+    {
+        const auto begin = std::min(task * rangeSize, indices.size());
+        const auto end   = std::min(begin + rangeSize, indices.size());
+        auto & cloud     = *m_typesetClouds[task + 1];
+
+        threadPool->submit([this, &cloud, begin, end, &indices, &mutex, &condition, &numFinished] ()
+        {
+            typesetRange(cloud, begin, end, indices);
+
+            // Notify under the lock, as the waiting thread owns mutex and condition
+            std::lock_guard<std::mutex> lock(mutex);
+            numFinished++;
+            condition.notify_one();
+        });
+    }
+
+    typesetRange(*m_typesetClouds.front(), std::min((numTasks - 1) * rangeSize, indices.size()), indices.size(), indices);
+
+    // Wait for worker threads
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&numFinished, numTasks] ()
+    {
+        return numFinished + 1 == numTasks;
+    });
+}
+
+void GlyphPreparationStage::typesetRange(openll::GlyphVertexCloud & cloud, size_t begin, size_t end, const std::vector<size_t> & indices)
+{
+    const auto & labels = *sequences.value();
+
+    std::vector<openll::Label> label(1);
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        const auto index = indices[i];
+
+        // Typeset sequence on its own and keep its vertices. The cloud is
+        // only used as vertex container and is never uploaded to the GPU.
+        label.front() = labels[index];
+        openll::Typesetter::typeset(cloud, label, false, false);
+
+        m_sequenceVertices[index] = cloud.vertices();
+    }
+}
+
 
 } // namespace gloperate_text
@@ -19,6 +19,7 @@ GlyphRenderStage::GlyphRenderStage(gloperate::Environment * environment, const s
 , renderInterface(this)
 , vertexCloud("vertexCloud", this)
 , camera("camera", this)
+, tileMatrix("tileMatrix", this, glm::mat4(1.0f))
 {
 }
 
@@ -52,7 +53,7 @@ void GlyphRenderStage::onProcess()
 
     if (*camera != nullptr)
     {
-        m_renderer->renderInWorld(*vertexCloud.value(), camera->viewProjectionMatrix());
+        m_renderer->renderInWorld(*vertexCloud.value(), *tileMatrix * camera->viewProjectionMatrix());
     }
     else
     {
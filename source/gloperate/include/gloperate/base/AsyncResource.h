@@ -0,0 +1,142 @@
+
+#pragma once
+
+
+#include <memory>
+#include <atomic>
+#include <functional>
+
+#include <gloperate/gloperate_api.h>
+
+
+namespace gloperate
+{
+
+
+/**
+*  @brief
+*    Handle to a resource that is loaded asynchronously
+*
+*    The handle is returned by ResourceManager::loadAsync(). File I/O and
+*    decoding are done on a worker thread, while the resource itself, e.g.,
+*    an OpenGL texture, is created on the first call of get() after the
+*    handle has become ready. Therefore, get() has to be called from the
+*    thread that holds the OpenGL context.
+*
+*    Typical usage in a stage:
+*    \code{.cpp}
+*
+*        // on input change
+*        m_loading = environment()->resourceManager()->loadAsync<globjects::Texture>(path);
+*        ...
+*        // on each process
+*        if (m_loading.isReady())
+*            m_texture = m_loading.get();
+*    \endcode
+*
+*  @tparam T
+*    Resource type
+*/
+template <typename T>
+class GLOPERATE_TEMPLATE_API AsyncResource
+{
+public:
+    /**
+    *  @brief
+    *    Loading state shared between handle and worker thread
+    */
+    struct State
+    {
+        std::atomic<bool>                                              ready;    ///< 'true' if the worker has finished, else 'false'
+        std::atomic<int>                                               current;  ///< Current progress reported by the loader
+        std::atomic<int>                                               total;    ///< Total progress reported by the loader
+        std::function<T *()>                                           create;   ///< Creates the resource on the context thread (set by the worker)
+        std::function<std::shared_ptr<T>(const std::shared_ptr<T> &)> finish;   ///< Registers the created resource, e.g., in a cache (can be empty)
+        std::shared_ptr<T>                                             resource; ///< Created resource
+        bool                                                           created;  ///< 'true' if create() has been invoked, else 'false'
+
+        State();
+    };
+
+
+public:
+    /**
+    *  @brief
+    *    Constructor
+    *
+    *  @remarks
+    *    Creates an empty, invalid handle
+    */
+    AsyncResource();
+
+    /**
+    *  @brief
+    *    Constructor
+    *
+    *  @param[in] resource
+    *    Resource that is already available
+    *
+    *  @remarks
+    *    Creates a handle that is ready immediately
+    */
+    explicit AsyncResource(const std::shared_ptr<T> & resource);
+
+    /**
+    *  @brief
+    *    Constructor
+    *
+    *  @param[in] state
+    *    Loading state (must NOT be null!)
+    */
+    explicit AsyncResource(const std::shared_ptr<State> & state);
+
+    /**
+    *  @brief
+    *    Check if handle refers to a loading request
+    *
+    *  @return
+    *    'true' if valid, else 'false'
+    */
+    bool isValid() const;
+
+    /**
+    *  @brief
+    *    Check if loading has finished
+    *
+    *  @return
+    *    'true' if get() can be called without blocking, else 'false'
+    */
+    bool isReady() const;
+
+    /**
+    *  @brief
+    *    Get loading progress
+    *
+    *  @return
+    *    Progress in the range [0, 1] (0 if the loader does not report progress)
+    */
+    float progress() const;
+
+    /**
+    *  @brief
+    *    Get loaded resource
+    *
+    *  @return
+    *    Resource (null if the handle is not ready or loading has failed)
+    *
+    *  @remarks
+    *    Must be called from the thread that holds the OpenGL context
+    *    in which the resource is to be used.
+    */
+    std::shared_ptr<T> get();
+
+
+protected:
+    std::shared_ptr<State> m_state; ///< Loading state (null for invalid handles)
+};
+
+
+} // namespace gloperate
+
+
+#include <gloperate/base/AsyncResource.inl>
@@ -0,0 +1,100 @@
+
+#pragma once
+
+
+#include <cassert>
+
+
+namespace gloperate
+{
+
+
+template <typename T>
+AsyncResource<T>::State::State()
+: ready(false)
+, current(0)
+, total(0)
+, created(false)
+{
+}
+
+template <typename T>
+AsyncResource<T>::AsyncResource()
+{
+}
+
+template <typename T>
+AsyncResource<T>::AsyncResource(const std::shared_ptr<T> & resource)
+: m_state(std::make_shared<State>())
+{
+    m_state->resource = resource;
+    m_state->created  = true;
+    m_state->ready    = true;
+}
+
+template <typename T>
+AsyncResource<T>::AsyncResource(const std::shared_ptr<State> & state)
+: m_state(state)
+{
+    assert(state);
+}
+
+template <typename T>
+bool AsyncResource<T>::isValid() const
+{
+    return m_state != nullptr;
+}
+
+template <typename T>
+bool AsyncResource<T>::isReady() const
+{
+    return m_state && m_state->ready;
+}
+
+template <typename T>
+float AsyncResource<T>::progress() const
+{
+    if (!m_state)
+    {
+        return 0.0f;
+    }
+
+    if (m_state->ready)
+    {
+        return 1.0f;
+    }
+
+    const int total = m_state->total;
+    return total > 0 ? static_cast<float>(m_state->current) / total : 0.0f;
+}
+
+template <typename T>
+std::shared_ptr<T> AsyncResource<T>::get()
+{
+    if (!isReady())
+    {
+        return nullptr;
+    }
+
+    // Create resource on the calling thread only once
+    if (!m_state->created)
+    {
+        m_state->created = true;
+
+        auto resource = std::shared_ptr<T>(m_state->create ? m_state->create() : nullptr);
+        m_state->create = nullptr;
+
+        if (resource && m_state->finish)
+        {
+            resource = m_state->finish(resource);
+        }
+
+        m_state->finish   = nullptr;
+        m_state->resource = resource;
+    }
+
+    return m_state->resource;
+}
+
+
+} // namespace gloperate
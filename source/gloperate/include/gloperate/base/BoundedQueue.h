@@ -0,0 +1,96 @@
+
+#pragma once
+
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include <gloperate/gloperate_api.h>
+
+
+namespace gloperate
+{
+
+
+/**
+*  @brief
+*    Bounded lock-free queue
+*
+*    Multiple threads can push and pop concurrently without locking.
+*    Each cell carries a sequence number that tells producers and
+*    consumers whether it is free or filled, so threads only contend
+*    on the enqueue or the dequeue position, respectively.
+*
+*  @tparam T
+*    Element type (must be default-constructible and copyable)
+*  @tparam Capacity
+*    Maximum number of elements (must be a power of two)
+*/
+template <typename T, size_t Capacity>
+class GLOPERATE_TEMPLATE_API BoundedQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+
+public:
+    /**
+    *  @brief
+    *    Constructor
+    */
+    BoundedQueue();
+
+    // No copying
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue & operator=(const BoundedQueue &) = delete;
+
+    /**
+    *  @brief
+    *    Add element to the end of the queue
+    *
+    *  @param[in] value
+    *    Element
+    *
+    *  @return
+    *    'true' if the element has been added, 'false' if the queue is full
+    */
+    bool push(const T & value);
+
+    /**
+    *  @brief
+    *    Remove element from the front of the queue
+    *
+    *  @param[out] value
+    *    Element
+    *
+    *  @return
+    *    'true' if an element has been removed, 'false' if the queue is empty
+    */
+    bool pop(T & value);
+
+
+protected:
+    /**
+    *  @brief
+    *    Queue cell
+    */
+    struct Cell
+    {
+        std::atomic<size_t> sequence; ///< Position for which the cell can be filled (== position) or read (== position + 1)
+        T                   value;    ///< Element
+    };
+
+
+protected:
+    std::array<Cell, Capacity> m_cells;        ///< Ring buffer
+    char                       m_padding0[64]; ///< Keeps the enqueue position on its own cache line
+    std::atomic<size_t>        m_enqueuePos;   ///< Next position to be filled
+    char                       m_padding1[64]; ///< Keeps the dequeue position on its own cache line
+    std::atomic<size_t>        m_dequeuePos;   ///< Next position to be read
+};
+
+
+} // namespace gloperate
+
+
+#include <gloperate/base/BoundedQueue.inl>
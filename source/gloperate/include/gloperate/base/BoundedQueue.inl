@@ -0,0 +1,101 @@
+
+#pragma once
+
+
+namespace gloperate
+{
+
+
+template <typename T, size_t Capacity>
+BoundedQueue<T, Capacity>::BoundedQueue()
+: m_enqueuePos(0)
+, m_dequeuePos(0)
+{
+    for (size_t i = 0; i < Capacity; ++i)
+    {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T, size_t Capacity>
+bool BoundedQueue<T, Capacity>::push(const T & value)
+{
+    Cell * cell = nullptr;
+    size_t pos  = m_enqueuePos.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        cell = &m_cells[pos & (Capacity - 1)];
+
+        const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const auto   diff     = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+
+        if (diff == 0)
+        {
+            // Cell is free, try to claim it
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // Queue is full
+            return false;
+        }
+        else
+        {
+            // Another producer has claimed the cell
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->value = value;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+
+    return true;
+}
+
+template <typename T, size_t Capacity>
+bool BoundedQueue<T, Capacity>::pop(T & value)
+{
+    Cell * cell = nullptr;
+    size_t pos  = m_dequeuePos.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        cell = &m_cells[pos & (Capacity - 1)];
+
+        const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const auto   diff     = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+
+        if (diff == 0)
+        {
+            // Cell is filled, try to claim it
+            if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // Queue is empty
+            return false;
+        }
+        else
+        {
+            // Another consumer has claimed the cell
+            pos = m_dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    value = cell->value;
+
+    // Release cell for the next round
+    cell->sequence.store(pos + Capacity, std::memory_order_release);
+
+    return true;
+}
+
+
+} // namespace gloperate
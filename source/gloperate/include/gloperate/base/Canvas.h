@@ -3,8 +3,12 @@
 
 
 #include <string>
+#include <vector>
 #include <mutex>
+#include <chrono>
+#include <atomic>
 
+#include <glm/vec2.hpp>
 #include <glm/vec4.hpp>
 #include <glm/fwd.hpp>
 
@@ -14,6 +18,7 @@
 #include <cppexpose/signal/ScopedConnection.h>
 
 #include <gloperate/base/ChronoTimer.h>
+#include <gloperate/base/BoundedQueue.h>
 
 
 namespace globjects
@@ -38,6 +43,12 @@ class DepthStencilRenderTarget;
 class StencilRenderTarget;
 class BlitStage;
 
+template <typename T>
+class Input;
+
+template <typename T>
+class Output;
+
 
 /**
 *  @brief
@@ -47,6 +58,12 @@ class BlitStage;
 *    actual rendering. It should be embedded by the windowing backend and
 *    receives state changes from the outside (such as window size, mouse,
 *    or keyboard events) and passes them on to the rendering components.
+*
+*    Input events are pushed into a lock-free queue, so the UI thread is
+*    never blocked by a frame that is being rendered on another thread.
+*    Queued events are dispatched immediately if the canvas is not busy,
+*    and otherwise at the beginning of the next call to render() or
+*    updateTime(). Consecutive mouse moves are coalesced.
 */
 class GLOPERATE_API Canvas : public cppexpose::Object
 {
@@ -117,6 +134,32 @@ public:
     void loadRenderStage(const std::string & name);
     //@}
 
+    //@{
+    /**
+    *  @brief
+    *    Open a transaction on the render stage
+    *
+    *  @remarks
+    *    While a transaction is open, input values of the render stage are
+    *    set without notifying the stages and invalidating their outputs for
+    *    each value. This is done once per changed input and affected stage
+    *    when the transaction is committed. Transactions can be nested and
+    *    are carried over when the render stage is replaced. They have no
+    *    effect if the render stage is not a pipeline.
+    *
+    *  @see Pipeline::beginTransaction()
+    */
+    void beginTransaction();
+
+    /**
+    *  @brief
+    *    Commit a transaction on the render stage
+    *
+    *  @see beginTransaction()
+    */
+    void commitTransaction();
+    //@}
+
     //@{
     /**
     *  @brief
@@ -268,11 +311,96 @@ public:
     *    Modifiers (gloperate modifier codes)
     */
     void promoteMouseWheel(const glm::vec2 & delta, const glm::ivec2 & pos, int modifier);
+
+    /**
+    *  @brief
+    *    Get input latency of the last frame
+    *
+    *  @return
+    *    Time (in seconds) from the oldest input event that has been dispatched
+    *    for the last rendered frame to the end of rendering (0 if there was none)
+    */
+    float inputLatency() const;
     //@}
 
 
+protected:
+    /**
+    *  @brief
+    *    Slots of the render stage that are accessed every frame
+    *
+    *    The slots are looked up once when the render stage is set
+    *    and again only after slots have been added to or removed
+    *    from the render stage.
+    */
+    struct SlotBindings
+    {
+        bool                                               valid;                    ///< 'true' if the bindings are up to date, else 'false'
+        Input<glm::vec4>                                 * viewport;                 ///< Input 'viewport' (can be null)
+        Input<float>                                     * timeDelta;                ///< Input 'timeDelta' (can be null)
+        Output<glm::vec4>                                * viewportOutput;           ///< First viewport output (can be null)
+        std::vector<Input<ColorRenderTarget *> *>          colorTargetInputs;        ///< Color render target inputs
+        std::vector<Input<DepthRenderTarget *> *>          depthTargetInputs;        ///< Depth render target inputs
+        std::vector<Input<DepthStencilRenderTarget *> *>   depthStencilTargetInputs; ///< Depth stencil render target inputs
+        std::vector<Input<StencilRenderTarget *> *>        stencilTargetInputs;      ///< Stencil render target inputs
+        std::vector<Output<ColorRenderTarget *> *>         colorTargetOutputs;       ///< Color render target outputs
+        cppexpose::ScopedConnection                        inputAdded;               ///< Connection to the inputAdded-signal of the render stage
+        cppexpose::ScopedConnection                        inputRemoved;             ///< Connection to the inputRemoved-signal of the render stage
+        cppexpose::ScopedConnection                        outputAdded;              ///< Connection to the outputAdded-signal of the render stage
+        cppexpose::ScopedConnection                        outputRemoved;            ///< Connection to the outputRemoved-signal of the render stage
+    };
+
+    /**
+    *  @brief
+    *    Input event queued by the UI thread
+    */
+    struct QueuedInput
+    {
+        /**
+        *  @brief
+        *    Type of input event
+        */
+        enum class Type : int
+        {
+            KeyPress,
+            KeyRelease,
+            MouseMove,
+            MousePress,
+            MouseRelease,
+            MouseWheel
+        };
+
+        Type                                  type;     ///< Event type
+        int                                   code;     ///< Key or mouse button
+        int                                   modifier; ///< Modifiers (gloperate modifier codes)
+        glm::ivec2                            pos;      ///< Mouse position
+        glm::vec2                             delta;    ///< Wheel delta
+        std::chrono::steady_clock::time_point time;     ///< Time at which the event has been received
+    };
+
+    using InputQueue = BoundedQueue<QueuedInput, 256>; ///< Queue for input events (up to 256 events)
+
+
 protected:
     //@{
+    /**
+    *  @brief
+    *    Get slot bindings of the current render stage
+    *
+    *  @return
+    *    Slot bindings (looked up again if invalid)
+    *
+    *  @remarks
+    *    Must only be called if a render stage is set.
+    */
+    const SlotBindings & slotBindings();
+
+    /**
+    *  @brief
+    *    Invalidate slot bindings of the current render stage
+    */
+    void invalidateSlotBindings();
+
     /**
     *  @brief
     *    Check if a redraw is required
@@ -283,6 +411,37 @@ protected:
     */
     void checkRedraw();
 
+    /**
+    *  @brief
+    *    Queue input event and dispatch it if the canvas is not busy
+    *
+    *  @param[in] event
+    *    Input event
+    */
+    void queueInputEvent(const QueuedInput & event);
+
+    /**
+    *  @brief
+    *    Dispatch queued input events to the input devices
+    *
+    *  @return
+    *    'true' if events have been dispatched, else 'false'
+    *
+    *  @remarks
+    *    Must be called with m_mutex locked.
+    */
+    bool dispatchInputEvents();
+
+    /**
+    *  @brief
+    *    Update input latency at the end of a frame
+    *
+    *  @remarks
+    *    Measures the time since the oldest input event that has been
+    *    dispatched for this frame. Must be called with m_mutex locked.
+    */
+    void updateInputLatency();
+
     /**
     *  @brief
     *    Promote changes of input slots
@@ -314,6 +473,7 @@ protected:
     cppexpose::Variant scr_getSlot(const std::string & path, const std::string & slot);
     cppexpose::Variant scr_getValue(const std::string & path, const std::string & slot);
     void scr_setValue(const std::string & path, const std::string & slot, const cppexpose::Variant & value);
+    void scr_setValues(const std::string & path, const cppexpose::Variant & values);
     //@}
 
     //@{
@@ -330,24 +490,33 @@ protected:
     gloperate::ChronoTimer                    m_clock;                  ///< Time measurement
     glm::vec4                                 m_viewport;               ///< Viewport (in real device coordinates)
     float                                     m_timeDelta;              ///< Time delta since the last update (in seconds)
+    unsigned int                              m_completedLoads;         ///< Number of finished asynchronous resource loads at the last update
     std::unique_ptr<Stage>                    m_renderStage;            ///< Render stage that renders into the canvas
     std::unique_ptr<Stage>                    m_oldStage;               ///< Old render stage, will be destroyed on the next render call
     std::unique_ptr<BlitStage>                m_blitStage;              ///< Blit stage that is used to blit to target color attachment if render stage uses own targets
     std::unique_ptr<MouseDevice>              m_mouseDevice;            ///< Device for Mouse Events
     std::unique_ptr<KeyboardDevice>           m_keyboardDevice;         ///< Device for Keyboard Events
     bool                                      m_replaceStage;           ///< 'true' if the stage has just been replaced, else 'false'
+    unsigned int                              m_transactionDepth;       ///< Number of nested transactions opened on the canvas (protected by m_mutex)
     std::recursive_mutex                      m_mutex;                  ///< Mutex for separating main and render thread
     cppexpose::ScopedConnection               m_inputChangedConnection; ///< Connection for the inputChanged-signal of the current stage
     cppexpose::Function                       m_inputChangedCallback;   ///< Script function that is called on inputChanged (slot, status)
     std::vector<cppexpose::Function>          m_renderedCallbacks;      ///< Script functions that are called once after rendering
     bool                                      m_rendered;               ///< 'true' after a new frame has been drawn
-    std::vector<AbstractSlot *>               m_changedInputs;          ///< List of changed input slots
+    std::vector<AbstractSlot *>               m_changedInputs;          ///< List of changed input slots (each slot at most once)
     std::mutex                                m_changedInputMutex;      ///< Mutex to access m_changedInputs
+    InputQueue                                m_inputQueue;             ///< Input events pushed by the UI thread
+    std::vector<QueuedInput>                  m_inputEvents;            ///< Input events that are currently dispatched (protected by m_mutex)
+    std::chrono::steady_clock::time_point     m_inputTime;              ///< Time of the oldest input event dispatched since the last frame
+    bool                                      m_hasInputTime;           ///< 'true' if m_inputTime is set, else 'false'
+    std::atomic<float>                        m_inputLatency;           ///< Input latency of the last frame (in seconds)
 
     std::unique_ptr<ColorRenderTarget>        m_colorTarget;            ///< Input render target for color attachment
     std::unique_ptr<DepthRenderTarget>        m_depthTarget;            ///< Input render target for depth attachment
     std::unique_ptr<DepthStencilRenderTarget> m_depthStencilTarget;     ///< Input render target for combined depth stencil attachment
     std::unique_ptr<StencilRenderTarget>      m_stencilTarget;          ///< Input render target for stencil attachment
+
+    SlotBindings                              m_slotBindings;           ///< Cached slots of the render stage
 };
 
 
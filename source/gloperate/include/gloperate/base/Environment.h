@@ -4,6 +4,9 @@
 
 #include <vector>
 #include <string>
+#include <map>
+#include <mutex>
+#include <functional>
 
 #include <cppexpose/reflection/Object.h>
 #include <cppexpose/signal/Signal.h>
@@ -12,7 +15,10 @@
 #include <gloperate/base/ResourceManager.h>
 #include <gloperate/base/System.h>
 #include <gloperate/base/TimerManager.h>
+#include <gloperate/base/ThreadPool.h>
 #include <gloperate/input/InputManager.h>
+#include <gloperate/rendering/FramebufferCache.h>
+#include <gloperate/rendering/RenderTargetPool.h>
 
 
 namespace cppexpose
@@ -49,7 +55,7 @@ class GLOPERATE_API Environment : public cppexpose::Object
 
 
 public:
-    cppexpose::Signal<int> exitApplication;   ///< Called when application shall exit
+    cppexpose::Signal<int> exitApplication; ///< Called when application shall exit
 
 
 public:
@@ -115,6 +121,42 @@ public:
     TimerManager * timerManager();
     //@}
 
+    //@{
+    /**
+    *  @brief
+    *    Get thread pool
+    *
+    *  @return
+    *    Thread pool for CPU work (never null)
+    */
+    const ThreadPool * threadPool() const;
+    ThreadPool * threadPool();
+    //@}
+
+    //@{
+    /**
+    *  @brief
+    *    Get framebuffer cache
+    *
+    *  @return
+    *    Framebuffer cache shared by all stages (never null)
+    */
+    const FramebufferCache * framebufferCache() const;
+    FramebufferCache * framebufferCache();
+    //@}
+
+    //@{
+    /**
+    *  @brief
+    *    Get render target pool
+    *
+    *  @return
+    *    Render target textures shared by all stages (never null)
+    */
+    const RenderTargetPool * renderTargetPool() const;
+    RenderTargetPool * renderTargetPool();
+    //@}
+
     //@{
     /**
     *  @brief
@@ -182,6 +224,53 @@ public:
     *    Exit code (default: 0)
     */
     void exit(int exitCode = 0);
+
+    /**
+    *  @brief
+    *    Wake up application
+    *
+    *    This function calls all registered wakeup handlers.
+    *    Windowing backends that block while waiting for events are
+    *    expected to register a handler and resume their event loop,
+    *    e.g., when an asynchronously loaded resource has become ready
+    *    or a scripting timer has been started.
+    *
+    *  @remarks
+    *    This function can be called from any thread.
+    */
+    void wakeup();
+
+    /**
+    *  @brief
+    *    Register wakeup handler
+    *
+    *  @param[in] handler
+    *    Function that is called on wakeup()
+    *
+    *  @return
+    *    Handler ID (always greater than 0)
+    *
+    *  @remarks
+    *    The handler is called from the thread that calls wakeup() while
+    *    the handler list is locked, so it must be thread-safe and must not
+    *    register or remove wakeup handlers itself. This function can be
+    *    called from any thread.
+    */
+    int addWakeupHandler(const std::function<void()> & handler);
+
+    /**
+    *  @brief
+    *    Remove wakeup handler
+    *
+    *  @param[in] id
+    *    Handler ID returned by addWakeupHandler()
+    *
+    *  @remarks
+    *    Waits for a concurrent wakeup() to finish, so the handler is
+    *    never called after this function has returned. This function
+    *    can be called from any thread.
+    */
+    void removeWakeupHandler(int id);
     
     /**
     *  @brief
@@ -253,11 +342,18 @@ protected:
 
 
 protected:
+    std::map<int, std::function<void()>>      m_wakeupHandlers;   ///< Registered wakeup handlers (ID -> handler)
+    int                                       m_nextWakeupId;     ///< ID of the next registered wakeup handler
+    std::mutex                                m_wakeupMutex;      ///< Mutex for accessing the wakeup handlers from any thread (outlives the worker threads)
+
     ComponentManager                          m_componentManager; ///< Manager for plugin libraries and components
     ResourceManager                           m_resourceManager;  ///< Resource manager for loaders/storers
     System                                    m_system;           ///< System functions for scripting
     InputManager                              m_inputManager;     ///< Manager for Devices, -Providers and InputEvents
     TimerManager                              m_timerManager;     ///< Manager for scripting timers
+    ThreadPool                                m_threadPool;       ///< Worker threads for CPU work
+    FramebufferCache                          m_framebufferCache; ///< Framebuffers shared by all stages
+    RenderTargetPool                          m_renderTargetPool; ///< Render target textures shared by all stages
 
     std::vector<Canvas *>                     m_canvases;         ///< List of active canvases
 
@@ -56,6 +56,27 @@ public:
     *    Loaded resource (can be null)
     */
     virtual T * load(const std::string & filename, const cppexpose::Variant & options, std::function<void(int, int)> progress) const = 0;
+
+    /**
+    *  @brief
+    *    Read and decode resource from file without using OpenGL
+    *
+    *  @param[in] filename
+    *    File name
+    *  @param[in] options
+    *    Options for loading resource, see documentation of specific loader for supported options
+    *  @param[in] progress
+    *    Callback function that is invoked on progress (can be empty)
+    *
+    *  @return
+    *    Function that creates the resource on the OpenGL context thread (never empty)
+    *
+    *  @remarks
+    *    This function is called on a worker thread by ResourceManager::loadAsync().
+    *    The default implementation defers the complete loading to the returned
+    *    function. Loaders should override it to do file I/O and decoding up front.
+    */
+    virtual std::function<T *()> prepare(const std::string & filename, const cppexpose::Variant & options, std::function<void(int, int)> progress) const;
 };
 
 
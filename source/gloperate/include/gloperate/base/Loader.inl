@@ -2,6 +2,11 @@
 #pragma once
 
 
+#include <string>
+
+#include <cppexpose/variant/Variant.h>
+
+
 namespace gloperate
 {
 
@@ -17,5 +22,14 @@ Loader<T>::~Loader()
 {
 }
 
+template <typename T>
+std::function<T *()> Loader<T>::prepare(const std::string & filename, const cppexpose::Variant & options, std::function<void(int, int)> progress) const
+{
+    return [this, filename, options, progress] ()
+    {
+        return load(filename, options, progress);
+    };
+}
+
 
 } // namespace gloperate
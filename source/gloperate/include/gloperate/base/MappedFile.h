@@ -0,0 +1,114 @@
+
+#pragma once
+
+
+#include <string>
+#include <cstddef>
+
+#include <gloperate/gloperate_api.h>
+
+
+namespace gloperate
+{
+
+
+/**
+*  @brief
+*    Read-only memory mapping of a file
+*
+*    The file content is mapped into the address space of the process
+*    instead of being copied into a heap buffer. Pages are read from
+*    disk on first access and can be dropped by the operating system
+*    under memory pressure, as they are backed by the file.
+*/
+class GLOPERATE_API MappedFile
+{
+public:
+    /**
+    *  @brief
+    *    Constructor
+    *
+    *  @remarks
+    *    Creates an empty mapping
+    */
+    MappedFile();
+
+    /**
+    *  @brief
+    *    Destructor
+    */
+    ~MappedFile();
+
+    // No copying
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    /**
+    *  @brief
+    *    Map file into memory
+    *
+    *  @param[in] filename
+    *    File name
+    *
+    *  @return
+    *    'true' if the file has been mapped, else 'false'
+    *
+    *  @remarks
+    *    A previous mapping is released. Empty files cannot be mapped.
+    */
+    bool open(const std::string & filename);
+
+    /**
+    *  @brief
+    *    Release mapping
+    */
+    void close();
+
+    /**
+    *  @brief
+    *    Check if a file is mapped
+    *
+    *  @return
+    *    'true' if a file is mapped, else 'false'
+    */
+    bool isValid() const;
+
+    /**
+    *  @brief
+    *    Get mapped file content
+    *
+    *  @return
+    *    Pointer to the first byte (null if no file is mapped)
+    */
+    const char * data() const;
+
+    /**
+    *  @brief
+    *    Get file size
+    *
+    *  @return
+    *    Size of the mapped file (in bytes)
+    */
+    size_t size() const;
+
+    /**
+    *  @brief
+    *    Read file content into memory
+    *
+    *  @remarks
+    *    Touches every page of the mapping, so later accesses do not wait
+    *    for the disk. Call this on a worker thread before the content is
+    *    used on a thread that must not block, e.g., the context thread.
+    *    Pages may still be dropped again under memory pressure.
+    */
+    void prefetch() const;
+
+
+protected:
+    const char * m_data;    ///< Mapped file content (null if no file is mapped)
+    size_t       m_size;    ///< Size of the mapped file (in bytes)
+    void       * m_mapping; ///< Handle of the file mapping object (only used on Windows)
+};
+
+
+} // namespace gloperate
@@ -4,12 +4,20 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
 #include <functional>
+#include <typeindex>
+
+#include <glbinding/ContextHandle.h>
 
 #include <cppexpose/reflection/Object.h>
 #include <cppexpose/variant/Variant.h>
 
 #include <gloperate/gloperate_api.h>
+#include <gloperate/base/AsyncResource.h>
 
 
 namespace gloperate
@@ -17,13 +25,24 @@ namespace gloperate
 
 
 class Environment;
+class ThreadPool;
 class AbstractLoader;
 class AbstractStorer;
+template <typename T>
+class Loader;
 
 
 /**
 *  @brief
 *    Class to help loading/accessing resources (textures, ...)
+*
+*    Resources loaded with loadShared() are cached by type, path, options,
+*    file modification time and OpenGL context. As long as a resource is
+*    in use, further requests return the same object instead of loading
+*    the file again. Modified files are loaded again on the next request.
+*
+*    Resources loaded with loadAsync() are read and decoded on the thread
+*    pool of the environment and are added to the same cache.
 */
 class GLOPERATE_API ResourceManager : public cppexpose::Object
 {
@@ -80,6 +99,61 @@ public:
     template <typename T>
     T * load(const std::string & filename, const cppexpose::Variant & options = cppexpose::Variant(), std::function<void(int, int)> progress = std::function<void(int, int)>()) const;
 
+    /**
+    *  @brief
+    *    Load resource from file or get it from the resource cache
+    *
+    *  @param[in] filename
+    *    File name
+    *  @param[in] options
+    *    Options for loading resource, see documentation of specific loader for supported options
+    *  @param[in] progress
+    *    Callback function that is invoked on progress (can be empty)
+    *
+    *  @return
+    *    Loaded resource (can be null)
+    *
+    *  @remarks
+    *    The resource is shared with all other users that load the same
+    *    file with the same options in the current context, so it must
+    *    not be modified. It is deleted when the last user releases it.
+    */
+    template <typename T>
+    std::shared_ptr<T> loadShared(const std::string & filename, const cppexpose::Variant & options = cppexpose::Variant(), std::function<void(int, int)> progress = std::function<void(int, int)>()) const;
+
+    /**
+    *  @brief
+    *    Load resource from file on a worker thread
+    *
+    *  @param[in] filename
+    *    File name
+    *  @param[in] options
+    *    Options for loading resource, see documentation of specific loader for supported options
+    *
+    *  @return
+    *    Handle to the resource (invalid if no suitable loader exists)
+    *
+    *  @remarks
+    *    Must be called from the thread that holds the OpenGL context in
+    *    which the resource is to be used. If the resource is cached, the
+    *    returned handle is ready immediately. The resource is shared like
+    *    resources loaded with loadShared().
+    */
+    template <typename T>
+    AsyncResource<T> loadAsync(const std::string & filename, const cppexpose::Variant & options = cppexpose::Variant()) const;
+
+    /**
+    *  @brief
+    *    Get number of finished asynchronous loads
+    *
+    *  @return
+    *    Counter that is incremented each time a worker has finished loading
+    *
+    *  @remarks
+    *    Canvases poll this counter to redraw when resources become ready.
+    */
+    unsigned int completedLoads() const;
+
     /**
     *  @brief
     *    Store resource to file
@@ -101,6 +175,128 @@ public:
 
 
 protected:
+    /**
+    *  @brief
+    *    Identification of a cached resource
+    */
+    struct CacheKey
+    {
+        std::type_index          type;             ///< Type of the resource
+        glbinding::ContextHandle context;          ///< OpenGL context that was current when loading
+        std::string              path;             ///< Resolved file path
+        std::string              options;          ///< Serialized loading options
+        unsigned int             modificationTime; ///< Modification time of the file
+
+        bool operator<(const CacheKey & other) const;
+    };
+
+
+protected:
+    /**
+    *  @brief
+    *    Get file extension without the leading dot
+    *
+    *  @param[in] filename
+    *    File name
+    *
+    *  @return
+    *    File extension
+    */
+    static std::string extension(const std::string & filename);
+
+    /**
+    *  @brief
+    *    Find loader for a resource type and file
+    *
+    *  @param[in] filename
+    *    File name
+    *
+    *  @return
+    *    Loader (can be null)
+    *
+    *  @remarks
+    *    The loader for each combination of type and file extension is
+    *    looked up only once.
+    */
+    template <typename T>
+    Loader<T> * findLoader(const std::string & filename) const;
+
+    /**
+    *  @brief
+    *    Find loader for a resource type and file extension without locking
+    *
+    *  @param[in] type
+    *    Resource type
+    *  @param[in] ext
+    *    File extension
+    *  @param[in] isLoader
+    *    Function that checks if a loader supports the resource type
+    *
+    *  @return
+    *    Loader (can be null)
+    */
+    AbstractLoader * findLoader(const std::type_index & type, const std::string & ext, const std::function<bool(AbstractLoader *)> & isLoader) const;
+
+    /**
+    *  @brief
+    *    Compose cache key for a resource
+    *
+    *  @param[in] type
+    *    Resource type
+    *  @param[in] filename
+    *    File name
+    *  @param[in] options
+    *    Options for loading resource
+    *
+    *  @return
+    *    Cache key
+    */
+    static CacheKey cacheKey(const std::type_index & type, const std::string & filename, const cppexpose::Variant & options);
+
+    /**
+    *  @brief
+    *    Get cached resource
+    *
+    *  @param[in] key
+    *    Cache key
+    *
+    *  @return
+    *    Resource (null if not cached or already deleted)
+    */
+    std::shared_ptr<void> cachedResource(const CacheKey & key) const;
+
+    /**
+    *  @brief
+    *    Add resource to the cache
+    *
+    *  @param[in] key
+    *    Cache key
+    *  @param[in] resource
+    *    Loaded resource (must NOT be null!)
+    *
+    *  @return
+    *    Cached resource, which differs from the given one if another thread has cached the same resource first
+    *
+    *  @remarks
+    *    Entries of resources that have been deleted meanwhile are removed.
+    */
+    std::shared_ptr<void> cacheResource(const CacheKey & key, const std::shared_ptr<void> & resource) const;
+
+    /**
+    *  @brief
+    *    Run loading task on the loader threads
+    *
+    *  @param[in] task
+    *    Loading task (must NOT be empty!)
+    *
+    *  @remarks
+    *    Loads run on threads of their own instead of the thread pool of
+    *    the environment. A long load would otherwise occupy a worker
+    *    while the context thread waits for CPU-only stages queued
+    *    behind it.
+    */
+    void submitLoad(std::function<void()> task) const;
+
     /**
     *  @brief
     *    Update list of available loaders and storers
@@ -115,9 +311,14 @@ protected:
 
 
 protected:
-    Environment                                        * m_environment; ///< Gloperate environment (must NOT be null!)
-    mutable std::vector<std::unique_ptr<AbstractLoader>> m_loaders;     ///< Available loaders
-    mutable std::vector<std::unique_ptr<AbstractStorer>> m_storers;     ///< Available storers
+    Environment                                                               * m_environment;    ///< Gloperate environment (must NOT be null!)
+    mutable std::vector<std::unique_ptr<AbstractLoader>>                        m_loaders;        ///< Available loaders
+    mutable std::vector<std::unique_ptr<AbstractStorer>>                        m_storers;        ///< Available storers
+    mutable std::map<std::pair<std::type_index, std::string>, AbstractLoader *> m_loaderIndex;    ///< Loader for each resource type and file extension (null if none)
+    mutable std::map<CacheKey, std::weak_ptr<void>>                             m_cache;          ///< Resources currently in use
+    mutable std::mutex                                                          m_mutex;          ///< Mutex for loaders, loader index and cache
+    mutable std::atomic<unsigned int>                                           m_completedLoads; ///< Number of finished asynchronous loads
+    std::unique_ptr<ThreadPool>                                                 m_loadThreads;    ///< Threads for asynchronous loads, separate from stage processing
 };
 
 
@@ -2,6 +2,9 @@
 #pragma once
 
 
+#include <typeinfo>
+#include <memory>
+
 #include <cppfs/FilePath.h>
 
 #include <gloperate/base/Loader.h>
@@ -16,42 +19,102 @@ namespace gloperate
 template <typename T>
 T * ResourceManager::load(const std::string & filename, const cppexpose::Variant & options, std::function<void(int, int)> progress) const
 {
-    // Lazy initialization of loaders
-    if (m_loaders.size() == 0) {
-        updateComponents();
+    // Find suitable loader
+    auto loader = findLoader<T>(filename);
+    if (!loader) {
+        // No suitable loader found
+        return nullptr;
     }
 
-    // Get file extension
-    std::string ext = cppfs::FilePath(filename).extension();
-    auto pos = ext.find_last_of('.');
-    if (pos != std::string::npos)
-    {
-        ext = ext.substr(pos + 1);
+    // Use loader
+    return loader->load(filename, options, progress);
+}
+
+template <typename T>
+std::shared_ptr<T> ResourceManager::loadShared(const std::string & filename, const cppexpose::Variant & options, std::function<void(int, int)> progress) const
+{
+    const auto key = cacheKey(typeid(T), filename, options);
+
+    // Return resource that is still in use
+    if (auto cached = cachedResource(key)) {
+        return std::static_pointer_cast<T>(cached);
+    }
+
+    // Load resource without holding the lock
+    auto resource = std::shared_ptr<T>(load<T>(filename, options, progress));
+    if (!resource) {
+        return nullptr;
+    }
+
+    return std::static_pointer_cast<T>(cacheResource(key, resource));
+}
+
+template <typename T>
+AsyncResource<T> ResourceManager::loadAsync(const std::string & filename, const cppexpose::Variant & options) const
+{
+    const auto key = cacheKey(typeid(T), filename, options);
+
+    // Return resource that is still in use
+    if (auto cached = cachedResource(key)) {
+        return AsyncResource<T>(std::static_pointer_cast<T>(cached));
     }
 
     // Find suitable loader
-    for (const auto & loader : m_loaders) {
-        // Check loader type
-        Loader<T> * concreteLoader = dynamic_cast<Loader<T> *>(loader.get());
-        if (concreteLoader) {
-            // Check if filetype is supported
-            if (concreteLoader->canLoad(ext)) {
-                // Use loader
-                return concreteLoader->load(filename, options, progress);
-            }
-        }
+    auto loader = findLoader<T>(filename);
+    if (!loader) {
+        return AsyncResource<T>();
     }
 
-    // No suitable loader found
-    return nullptr;
+    auto state = std::make_shared<typename AsyncResource<T>::State>();
+
+    // Add resource to the cache once it has been created on the context thread
+    state->finish = [this, key] (const std::shared_ptr<T> & resource)
+    {
+        return std::static_pointer_cast<T>(cacheResource(key, resource));
+    };
+
+    // Read and decode file on a worker thread
+    submitLoad([loader, filename, options, state] ()
+    {
+        // The progress callback is stored in state->create, so it must not own the state
+        std::weak_ptr<typename AsyncResource<T>::State> weakState = state;
+
+        state->create = loader->prepare(filename, options, [weakState] (int current, int total)
+        {
+            if (auto lockedState = weakState.lock())
+            {
+                lockedState->current = current;
+                lockedState->total   = total;
+            }
+        });
+
+        state->ready = true;
+    });
+
+    return AsyncResource<T>(state);
+}
+
+template <typename T>
+Loader<T> * ResourceManager::findLoader(const std::string & filename) const
+{
+    const auto loader = findLoader(typeid(T), extension(filename), [] (AbstractLoader * candidate)
+    {
+        return dynamic_cast<Loader<T> *>(candidate) != nullptr;
+    });
+
+    return static_cast<Loader<T> *>(loader);
 }
 
 template <typename T>
 bool ResourceManager::store(const std::string & filename, T * resource, const cppexpose::Variant & options, std::function<void(int, int)> progress) const
 {
     // Lazy initialization of storers
-    if (m_storers.size() == 0) {
-        updateComponents();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_loaders.size() == 0 && m_storers.size() == 0) {
+            updateComponents();
+        }
     }
 
     // Get file extension
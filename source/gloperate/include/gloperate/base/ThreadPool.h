@@ -0,0 +1,117 @@
+
+#pragma once
+
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <gloperate/gloperate_api.h>
+
+
+namespace gloperate
+{
+
+
+/**
+*  @brief
+*    Pool of worker threads for CPU work
+*
+*    The thread pool executes tasks that do not require an OpenGL
+*    context, e.g., CPU-only stages or decoding of resources.
+*    Worker threads are started lazily on the first submitted task.
+*/
+class GLOPERATE_API ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+
+
+public:
+    /**
+    *  @brief
+    *    Check if the calling thread is a worker of any thread pool
+    *
+    *  @return
+    *    'true' if called from a worker thread, else 'false'
+    *
+    *  @remarks
+    *    Code running on a worker must not block on other tasks
+    *    of the pool, as this can exhaust all workers.
+    */
+    static bool isWorkerThread();
+
+
+public:
+    /**
+    *  @brief
+    *    Constructor
+    *
+    *  @param[in] numThreads
+    *    Number of worker threads (0 for one less than the number of hardware threads)
+    */
+    ThreadPool(unsigned int numThreads = 0);
+
+    /**
+    *  @brief
+    *    Destructor
+    *
+    *  @remarks
+    *    Waits for all pending tasks to finish.
+    */
+    ~ThreadPool();
+
+    // No copying
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+
+    /**
+    *  @brief
+    *    Get number of worker threads
+    *
+    *  @return
+    *    Number of worker threads (can be 0 on single core machines)
+    */
+    unsigned int numThreads() const;
+
+    /**
+    *  @brief
+    *    Submit task for execution on a worker thread
+    *
+    *  @param[in] task
+    *    Task (must NOT be empty!)
+    *
+    *  @remarks
+    *    If the pool has no worker threads, the task is executed immediately.
+    */
+    void submit(Task task);
+
+
+protected:
+    /**
+    *  @brief
+    *    Start worker threads if not already running
+    */
+    void startThreads();
+
+    /**
+    *  @brief
+    *    Main loop of a worker thread
+    */
+    void run();
+
+
+protected:
+    unsigned int             m_numThreads; ///< Number of worker threads
+    std::vector<std::thread> m_threads;    ///< Worker threads (empty until first task)
+    std::deque<Task>         m_tasks;      ///< Pending tasks
+    std::mutex               m_mutex;      ///< Mutex for tasks and state
+    std::condition_variable  m_condition;  ///< Signals new tasks or shutdown to the workers
+    bool                     m_stopped;    ///< 'true' if the pool is shutting down, else 'false'
+};
+
+
+} // namespace gloperate
@@ -3,6 +3,9 @@
 
 
 #include <map>
+#include <vector>
+#include <memory>
+#include <cstdint>
 
 #include <cppexpose/reflection/Object.h>
 
@@ -19,6 +22,12 @@ class Environment;
 /**
 *  @brief
 *    Manager for scripting timers
+*
+*    Pending timers are kept in a min-heap ordered by their deadline,
+*    so an update only touches timers that are due. Single-shot timers
+*    are deleted after they have fired, and stopped timers are deleted
+*    immediately, or after their callback has returned if they are
+*    stopped from within it.
 */
 class GLOPERATE_API TimerManager : public cppexpose::Object
 {
@@ -28,14 +37,16 @@ public:
         bool                active;     ///< 'true' if timer is active, else 'false'
         bool                singleShot; ///< 'true' if timer fires only once, else 'false'
         float               interval;   ///< Interval (in seconds)
-        float               remaining;  ///< Remaining time (in seconds)
+        double              deadline;   ///< Time at which the timer fires next (in seconds, see TimerManager::time())
+        std::uint64_t       sequence;   ///< Sequence number of the current schedule (identifies valid heap entries)
         cppexpose::Function func;       ///< Script function which is called
 
         Timer()
         : active(false)
         , singleShot(false)
         , interval(0.0f)
-        , remaining(0.0f)
+        , deadline(0.0)
+        , sequence(0)
         {
         }
 
@@ -89,6 +100,58 @@ public:
     */
     void update(float delta);
 
+    /**
+    *  @brief
+    *    Get time until the next timer fires
+    *
+    *  @return
+    *    Time (in seconds) until the next active timer fires, 0 if a timer is due, and a negative value if no timer is active
+    *
+    *  @remarks
+    *    Event loops can use this to block until the next timer is due
+    *    instead of polling. The deadline is read from the top of the
+    *    timer heap in constant time.
+    */
+    float remainingTime() const;
+
+    /**
+    *  @brief
+    *    Get timer time
+    *
+    *  @return
+    *    Sum of all time deltas passed to update() (in seconds)
+    */
+    double time() const;
+
+    /**
+    *  @brief
+    *    Get number of timers
+    *
+    *  @return
+    *    Number of active timers
+    */
+    size_t timerCount() const;
+
+
+protected:
+    /**
+    *  @brief
+    *    Entry of the timer heap
+    *
+    *  @remarks
+    *    Entries are not removed when a timer is stopped or rescheduled.
+    *    Instead, outdated entries are detected by their sequence number
+    *    and skipped.
+    */
+    struct HeapEntry
+    {
+        double        deadline; ///< Deadline of the timer (in seconds)
+        std::uint64_t sequence; ///< Sequence number of the schedule
+        int           id;       ///< Timer ID
+
+        bool operator>(const HeapEntry & other) const;
+    };
+
 
 protected:
     // Scripting functions
@@ -100,15 +163,21 @@ protected:
 
     // Helper functions
     int  startTimer(const cppexpose::Variant & func, int msec, bool singleShot);
-    void stopTimer(Timer * timer);
-    void updateTimer(Timer * timer, float delta);
+    void stopTimer(int id);
+    void schedule(int id, Timer * timer, double deadline);
+    bool isValid(const HeapEntry & entry) const;
+    void removeInvalidEntries();
 
 
 protected:
-    Environment                         * m_environment; ///< Gloperate environment to which the manager belongs
-    std::map<int, std::unique_ptr<Timer>> m_timers;      ///< List of activated timers
-    int                                   m_nextId;      ///< Next timer ID
-    gloperate::ChronoTimer                m_clock;       ///< Time measurement
+    Environment                         * m_environment;  ///< Gloperate environment to which the manager belongs
+    std::map<int, std::unique_ptr<Timer>> m_timers;       ///< List of activated timers
+    std::vector<HeapEntry>                m_heap;         ///< Min-heap of scheduled timers, ordered by deadline
+    double                                m_time;         ///< Sum of all time deltas (in seconds)
+    std::uint64_t                         m_nextSequence; ///< Next schedule sequence number
+    int                                   m_firingId;     ///< ID of the timer whose callback is currently called (0 if none)
+    int                                   m_nextId;       ///< Next timer ID
+    gloperate::ChronoTimer                m_clock;        ///< Time measurement
 };
 
 
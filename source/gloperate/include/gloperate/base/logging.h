@@ -0,0 +1,52 @@
+
+#pragma once
+
+
+#include <cppassist/logging/logging.h>
+
+#include <gloperate/gloperate_api.h>
+
+
+namespace gloperate
+{
+
+
+/**
+*  @brief
+*    Check if debug messages of a given level are printed
+*
+*  @param[in] debugLevel
+*    Debug level (see cppassist::debug())
+*
+*  @return
+*    'true' if debug messages of that level are printed, else 'false'
+*/
+inline bool isDebugEnabled(unsigned int debugLevel)
+{
+#ifdef GLOPERATE_DISABLE_DEBUG_LOGGING
+    (void)debugLevel;
+    return false;
+#else
+    return static_cast<int>(cppassist::LogMessage::Debug) + static_cast<int>(debugLevel) <= static_cast<int>(cppassist::verbosityLevel());
+#endif
+}
+
+
+} // namespace gloperate
+
+
+/**
+*  @brief
+*    Print debug message for gloperate
+*
+*    Works like cppassist::debug(LEVEL, "gloperate"), but the streamed
+*    arguments are only evaluated if the debug level is enabled. This
+*    avoids building strings (e.g., qualified slot names) in hot code
+*    paths. If gloperate is configured with OPTION_DEBUG_LOGGING=OFF,
+*    debug messages are removed by the compiler.
+*
+*    Usage:
+*      GLOPERATE_DEBUG(2) << stage->qualifiedName() << ": processing";
+*/
+#define GLOPERATE_DEBUG(LEVEL) \
+    if (!gloperate::isDebugEnabled(LEVEL)) {} else cppassist::debug(LEVEL, "gloperate")
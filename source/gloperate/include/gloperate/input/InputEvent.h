@@ -3,6 +3,7 @@
 
 
 #include <string>
+#include <cstddef>
 
 #include <glm/glm.hpp>
 
@@ -20,6 +21,10 @@ class AbstractDevice;
 /**
  * @brief
  *   A base class representing Events generated by InputDevices
+ *
+ *   Events of all derived types are allocated from a shared pool
+ *   of recycled memory blocks, so high-frequency events like mouse
+ *   moves do not cause a heap allocation each.
  */
 class GLOPERATE_API InputEvent
 {
@@ -81,6 +86,29 @@ public:
     */
     virtual std::string asString() const;
 
+    /**
+    *  @brief
+    *    Allocate memory for an event from the event pool
+    *
+    *  @param[in] size
+    *    Size of the event object (in bytes)
+    *
+    *  @return
+    *    Pointer to the allocated memory
+    */
+    static void * operator new(size_t size);
+
+    /**
+    *  @brief
+    *    Return memory of an event to the event pool
+    *
+    *  @param[in] ptr
+    *    Pointer to the memory (can be null)
+    *  @param[in] size
+    *    Size of the event object (in bytes)
+    */
+    static void operator delete(void * ptr, size_t size);
+
 
 protected:
     Type             m_type;
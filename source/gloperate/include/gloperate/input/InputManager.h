@@ -5,6 +5,11 @@
 #include <memory>
 #include <list>
 #include <map>
+#include <vector>
+#include <string>
+#include <mutex>
+
+#include <glm/vec2.hpp>
 
 #include <cppexpose/reflection/Object.h>
 
@@ -25,6 +30,20 @@ class InputEvent;
 /**
 *  @brief
 *    Manager for input device and consumers
+*
+*    Events are passed on to the registered consumers immediately.
+*    Scripting callbacks are invoked from update(), which is to be called
+*    once per frame from the UI thread. Until then, consecutive mouse
+*    moves, wheel scrolls, and spatial axis events of the same device are
+*    coalesced. Callbacks can subscribe to specific event types, so only
+*    those events are converted for scripting:
+*    \code{.js}
+*
+*        input.onInput(function(device, type, key, modifier, button, x, y, wx, wy) { ... },
+*                      ["MouseButtonPress", "MouseButtonRelease"]);
+*    \endcode
+*
+*    The most recent events are kept in a history of limited depth.
 */
 class GLOPERATE_API InputManager : public cppexpose::Object
 {
@@ -80,20 +99,105 @@ public:
     */
     void onEvent(std::unique_ptr<InputEvent> && event);
 
+    /**
+    *  @brief
+    *    Invoke scripting callbacks for the events received since the last update
+    *
+    *  @remarks
+    *    Must be called from the UI thread.
+    */
+    void update();
+
+    /**
+    *  @brief
+    *    Get maximum number of events kept in the history
+    *
+    *  @return
+    *    History depth
+    */
+    size_t historyDepth() const;
+
+    /**
+    *  @brief
+    *    Set maximum number of events kept in the history
+    *
+    *  @param[in] depth
+    *    History depth (0 to disable the history)
+    */
+    void setHistoryDepth(size_t depth);
+
+    /**
+    *  @brief
+    *    Get recent events
+    *
+    *  @return
+    *    Events in the history, oldest first
+    *
+    *  @remarks
+    *    The pointers are only valid until the next call of onEvent().
+    */
+    std::vector<const InputEvent *> history() const;
+
 
 protected:
+    /**
+    *  @brief
+    *    Scripting callback
+    */
+    struct Callback
+    {
+        cppexpose::Function function; ///< Script function
+        unsigned int        typeMask; ///< Bit mask of subscribed event types
+    };
+
+    /**
+    *  @brief
+    *    Event converted for scripting
+    */
+    struct ScriptEvent
+    {
+        const AbstractDevice * source;   ///< Device that generated the event (only used for coalescing)
+        std::string            device;   ///< Device descriptor
+        int                    type;     ///< Event type (InputEvent::Type)
+        int                    key;      ///< Key (button events)
+        int                    modifier; ///< Modifiers (button events)
+        int                    button;   ///< Mouse button (mouse events)
+        glm::ivec2             pos;      ///< Mouse position (mouse events)
+        glm::vec2              delta;    ///< Accumulated wheel delta (mouse events)
+    };
+
+
+protected:
+    /**
+    *  @brief
+    *    Add event to the history
+    *
+    *  @param[in] event
+    *    Event (must NOT be null)
+    *
+    *  @remarks
+    *    Must be called with m_mutex locked.
+    */
+    void addToHistory(std::unique_ptr<InputEvent> && event);
+
     // Scripting functions
-    int  scr_onInput(const cppexpose::Variant & func);
+    int  scr_onInput(const cppexpose::Variant & func, const cppexpose::Variant & types);
 
 
 protected:
-    Environment                                      * m_environment; ///< Gloperate environment to which the manager belongs
+    Environment                                      * m_environment;    ///< Gloperate environment to which the manager belongs
     std::list<AbstractEventConsumer *>                 m_consumers;
     std::list<std::unique_ptr<AbstractDeviceProvider>> m_deviceProviders;
     std::list<AbstractDevice *>                        m_devices;
-    std::list<std::unique_ptr<InputEvent>>             m_events;
-    std::map<int, cppexpose::Function>                 m_callbacks;
-    int                                                m_nextId;      ///< Next callback ID
+    std::vector<std::unique_ptr<InputEvent>>           m_history;        ///< Ring buffer of recent events
+    size_t                                             m_historyStart;   ///< Index of the oldest event in m_history
+    size_t                                             m_historySize;    ///< Number of events in m_history
+    std::map<int, Callback>                            m_callbacks;
+    unsigned int                                       m_callbackTypes;  ///< Bit mask of event types subscribed by any callback
+    std::vector<ScriptEvent>                           m_scriptEvents;   ///< Events to be passed to the scripting callbacks on the next update
+    std::vector<ScriptEvent>                           m_dispatchEvents; ///< Events that are currently passed to the scripting callbacks
+    mutable std::mutex                                 m_mutex;          ///< Mutex for history and script events (events may arrive from the render thread)
+    int                                                m_nextId;         ///< Next callback ID
 };
 
 
@@ -24,6 +24,16 @@ namespace gloperate
 /**
 *  @brief
 *    File loader for '.raw' files
+*
+*    Files are memory-mapped and streamed level by level to the texture
+*    through a pixel unpack buffer, so the image data is never copied into
+*    a heap buffer. The internal format is taken from the 'internalFormat'
+*    property of '.glraw' files or derived from format and type.
+*
+*    Besides the properties written by glraw, '.glraw' files may contain
+*    'levels' (number of mipmap levels, stored one after another) and
+*    'layers' (number of layers of a 2D texture array). For compressed
+*    images, the size of level n > 0 is given by the property 'size<n>'.
 */
 class GLOPERATE_API GlrawTextureLoader : public gloperate::Loader<globjects::Texture>
 {
@@ -62,32 +72,33 @@ public:
 
     // Virtual gloperate::Loader<globjects::Texture> functions
     virtual globjects::Texture * load(const std::string & filename, const cppexpose::Variant & options, std::function<void(int, int)> progress) const override;
+    virtual std::function<globjects::Texture *()> prepare(const std::string & filename, const cppexpose::Variant & options, std::function<void(int, int)> progress) const override;
 
 
 protected:
     /**
     *  @brief
-    *    Create Texture from .glraw file
+    *    Map .glraw file and read its header
     *
     *  @param[in] filename
     *    path of the .glraw file
     *
     *  @return
-    *    Loaded texture, null on error
+    *    Function that creates the texture, returning null on error
     */
-    globjects::Texture * loadGLRawImage(const std::string & filename) const;
+    std::function<globjects::Texture *()> prepareGLRawImage(const std::string & filename) const;
 
     /**
     *  @brief
-    *    Create Texture from .raw file
+    *    Map .raw file
     *
     *  @param[in] filename
     *    path of the .raw file
     *
     *  @return
-    *    Loaded texture, null on error
+    *    Function that creates the texture, returning null on error
     */
-    globjects::Texture * loadRawImage(const std::string & filename) const;
+    std::function<globjects::Texture *()> prepareRawImage(const std::string & filename) const;
 
 
 protected:
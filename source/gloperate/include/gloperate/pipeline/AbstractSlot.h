@@ -2,6 +2,9 @@
 #pragma once
 
 
+#include <atomic>
+#include <thread>
+
 #include <cppexpose/reflection/AbstractProperty.h>
 
 #include <gloperate/gloperate_api.h>
@@ -268,6 +271,16 @@ public:
     */
     virtual void onValueInvalidated() = 0;
 
+    /**
+    *  @brief
+    *    Emit value changed notification for the current value
+    *
+    *  @remarks
+    *    Used to deliver notifications of outputs that have been
+    *    held back while their stage was processed on a worker thread.
+    */
+    virtual void promoteValueChanged() = 0;
+
     /**
     *  @brief
     *    Check if the Slot is a slot of any type given by the template argument list
@@ -296,12 +309,37 @@ protected:
     */
     void initSlot(SlotType slotType, Stage * parent);
 
+    /**
+    *  @brief
+    *    Mark slot as being invalidated on the current thread
+    *
+    *  @return
+    *    'true' if the mark has been set, 'false' if the slot is already
+    *    being invalidated on the current thread (cyclic dependency)
+    *
+    *  @remarks
+    *    The slot is stamped with the id of the invalidating thread, so the
+    *    check takes constant time regardless of the depth of the chain.
+    *    If another thread holds the stamp, the mark is kept in a list of
+    *    the current thread instead, so a cycle is detected on every thread.
+    *    Every successful call has to be followed by endInvalidation().
+    */
+    bool beginInvalidation();
+
+    /**
+    *  @brief
+    *    Remove the mark set by beginInvalidation()
+    */
+    void endInvalidation();
+
 
 protected:
     SlotType m_slotType; ///< Type or role of the slot (input or output)
     bool     m_dynamic;  ///< 'true' if slot has been added dynamically, else 'false'
     bool     m_required; ///< Is the data required?
     bool     m_feedback; ///< Does the slot contain a feedback connection?
+
+    std::atomic<std::thread::id> m_invalidatingThread; ///< Thread that is currently invalidating the slot (default id if none)
 };
 
 
@@ -2,10 +2,6 @@
 #pragma once
 
 
-#include <map>
-#include <thread>
-#include <mutex>
-
 #include <gloperate/gloperate_api.h>
 #include <gloperate/pipeline/Slot.h>
 
@@ -91,12 +87,6 @@ protected:
 
     // Virtual AbstractProperty interface
     virtual void onOptionChanged(const std::string & option) override;
-
-
-protected:
-    // Data
-    std::map<std::thread::id, bool> m_cycleGuard; ///< Protection against cyclic propagation of change-events (one per thread to be thread-safe)
-    std::recursive_mutex            m_cycleMutex; ///< Mutex for accessing the cycle guard map
 };
 
 
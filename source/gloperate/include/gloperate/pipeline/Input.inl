@@ -4,6 +4,8 @@
 
 #include <cppassist/logging/logging.h>
 
+#include <gloperate/base/logging.h>
+
 
 namespace gloperate
 {
@@ -29,33 +31,16 @@ Input<T>::~Input()
 template <typename T>
 void Input<T>::onValueInvalidated()
 {
-    cppassist::debug(3, "gloperate") << this->qualifiedName() << ": input invalidated";
-
-    std::lock_guard<std::recursive_mutex> lock(this->m_cycleMutex);
-
-    // Get current thread ID
-    std::thread::id this_id = std::this_thread::get_id();
-
-    // Initialize guard for the current thread
-    if (this->m_cycleGuard.find(this_id) == this->m_cycleGuard.end())
-    {
-        this->m_cycleGuard[this_id] = false;
-    }
+    GLOPERATE_DEBUG(3) << this->qualifiedName() << ": input invalidated";
 
-    // Check if this slot has already been invoked in the current recursion
-    if (this->m_cycleGuard[this_id])
+    // Check if this slot has already been invoked in the current recursion on this thread
+    if (!this->beginInvalidation())
     {
-        // Reset guard
-        this->m_cycleGuard[this_id] = false;
-
         // Stop recursion here to avoid endless recursion
-        cppassist::debug(4, "gloperate") << this->qualifiedName() << ": detected cyclic dependency";
+        GLOPERATE_DEBUG(4) << this->qualifiedName() << ": detected cyclic dependency";
         return;
     }
 
-    // Raise guard
-    this->m_cycleGuard[this_id] = true;
-
     // Emit signal
     this->valueInvalidated();
 
@@ -68,13 +53,13 @@ void Input<T>::onValueInvalidated()
     }
 
     // Reset guard
-    this->m_cycleGuard[this_id] = false;
+    this->endInvalidation();
 }
 
 template <typename T>
 void Input<T>::onValueChanged(const T & value)
 {
-    cppassist::debug(3, "gloperate") << this->qualifiedName() << ": input changed value";
+    GLOPERATE_DEBUG(3) << this->qualifiedName() << ": input changed value";
 
     this->setChanged(true);
 
@@ -2,6 +2,10 @@
 #pragma once
 
 
+#include <gloperate/base/logging.h>
+#include <gloperate/pipeline/Stage.h>
+
+
 namespace gloperate
 {
 
@@ -48,7 +52,14 @@ void Output<T>::onRequiredChanged()
 template <typename T>
 void Output<T>::onValueInvalidated()
 {
-    cppassist::debug(3, "gloperate") << this->qualifiedName() << ": output invalidated";
+    GLOPERATE_DEBUG(3) << this->qualifiedName() << ": output invalidated";
+
+    // Hold back notification while the stage is processed on a worker thread
+    Stage * stage = this->parentStage();
+    if (stage && stage->deferOutputNotification(this))
+    {
+        return;
+    }
 
     // Emit signal
     this->valueInvalidated();
@@ -58,8 +69,15 @@ void Output<T>::onValueInvalidated()
 template <typename T>
 void Output<T>::onValueChanged(const T & value)
 {
-    cppassist::debug(3, "gloperate") << this->qualifiedName() << ": output changed value";
-    
+    GLOPERATE_DEBUG(3) << this->qualifiedName() << ": output changed value";
+
+    // Hold back notification while the stage is processed on a worker thread
+    Stage * stage = this->parentStage();
+    if (stage && stage->deferOutputNotification(this))
+    {
+        return;
+    }
+
     // Emit signal
     this->valueChanged(value);
 }
@@ -4,6 +4,7 @@
 
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 
 #include <gloperate/pipeline/Stage.h>
@@ -33,6 +34,10 @@ namespace gloperate
 *      invalidated, so any change of input data will propagate through the
 *      pipeline immediately and invalidate all outputs that, directly or
 *      indirectly, depend on that input.
+*    - To change many inputs at once, e.g., when applying a preset, a
+*      transaction can be opened. Values are then applied immediately,
+*      but change notifications and invalidation are deferred until the
+*      transaction is committed and run only once per input and stage.
 */
 class GLOPERATE_API Pipeline : public Stage
 {
@@ -127,6 +132,81 @@ public:
     */
     void invalidateStageOrder();
 
+    /**
+    *  @brief
+    *    Invalidate cached dependencies of a stage
+    *
+    *  @param[in] stage
+    *    Stage whose input connections have changed (must NOT be null!)
+    *
+    *  @remarks
+    *    Only the dependencies of the given stage are recomputed
+    *    upon next usage. Also invalidates the sorted stage order.
+    */
+    void invalidateStageDependencies(Stage * stage);
+
+    /**
+    *  @brief
+    *    Get the interval of the stage order in which the render targets of a stage are used
+    *
+    *  @param[in] stage
+    *    Stage that produces render targets or textures (must NOT be null!)
+    *  @param[out] first
+    *    Index of the first stage that writes or reads the render targets
+    *    (the stage itself if they are not used)
+    *  @param[out] last
+    *    Index of the last stage that directly or indirectly reads the render targets
+    *
+    *  @return
+    *    'true' if the lifetime is known, 'false' if the stages are not sorted,
+    *    the stage is not part of the pipeline, its render targets are used
+    *    outside of the current frame of this pipeline (by outputs of the
+    *    pipeline or feedback inputs), or they are used by a stage that is
+    *    not always processed and could therefore read stale contents
+    *
+    *  @remarks
+    *    Render targets are followed through stages that pass on render
+    *    targets or textures, e.g., rasterization or blit stages. The result
+    *    is cached until the stages are resorted; at that time, the outputs
+    *    of all stages that requested their lifetime are invalidated.
+    */
+    bool renderTargetLifetime(Stage * stage, size_t & first, size_t & last);
+
+    /**
+    *  @brief
+    *    Open a transaction
+    *
+    *  @remarks
+    *    Transactions are held by the outermost pipeline and can be nested.
+    *    While a transaction is open, input values are set immediately, but
+    *    stages are notified about changed inputs and their outputs are
+    *    invalidated only when the outermost transaction is committed.
+    *    The pipeline must not be processed and slots must not be removed
+    *    while a transaction is open.
+    */
+    void beginTransaction();
+
+    /**
+    *  @brief
+    *    Commit a transaction
+    *
+    *  @remarks
+    *    When the outermost transaction is committed, inputValueChanged()
+    *    is handled once for each changed input and the outputs of each
+    *    affected stage are invalidated once, including stages that
+    *    are reached only through the invalidation cascade.
+    */
+    void commitTransaction();
+
+    /**
+    *  @brief
+    *    Check if a transaction is open
+    *
+    *  @return
+    *    'true' if a transaction is open on the outermost pipeline, else 'false'
+    */
+    bool inTransaction() const;
+
     // Virtual Stage interface
     virtual bool isPipeline() const override;
 
@@ -135,15 +215,118 @@ protected:
     /**
     *  @brief
     *    Sort stages by their dependencies
+    *
+    *  @remarks
+    *    Runs in linear time of the number of stages and connections.
+    *    Only the dependencies of stages that have been invalidated
+    *    since the last sort are recomputed.
     */
     void sortStages();
 
+    /**
+    *  @brief
+    *    Recompute the direct dependencies of a stage
+    *
+    *  @param[in] stage
+    *    Stage (must NOT be null!)
+    */
+    void updateStageDependencies(Stage * stage);
+
+    /**
+    *  @brief
+    *    Process stages one after another in sorted order
+    */
+    void processStagesSerially();
+
+    /**
+    *  @brief
+    *    Process stages in dependency order, running CPU-only stages on worker threads
+    *
+    *  @remarks
+    *    Stages that are not CPU-only are processed on the calling
+    *    thread, which holds the OpenGL context. A stage is started
+    *    only after all stages it depends on have finished.
+    *    The stages must have been sorted successfully.
+    *    An exception thrown by a stage on a worker thread is
+    *    rethrown on the calling thread after all running stages
+    *    have finished; remaining stages are not processed.
+    */
+    void processStagesConcurrently();
+
     /**
     *  @brief
     *    Common implementation of addStage(Stage *) and addStage(std::unique_ptr<Stage> &&)
     */
     void registerStage(Stage * stage);
 
+    /**
+    *  @brief
+    *    Get outermost pipeline
+    *
+    *  @return
+    *    Outermost pipeline containing this pipeline (or this pipeline itself)
+    */
+    Pipeline * outermostPipeline();
+
+    /**
+    *  @brief
+    *    Remember changed input until the transaction is committed
+    *
+    *  @param[in] stage
+    *    Stage to which the input belongs (must NOT be null!)
+    *  @param[in] slot
+    *    Input slot which has changed its value (must NOT be null!)
+    */
+    void deferInputValueChanged(Stage * stage, AbstractSlot * slot);
+
+    /**
+    *  @brief
+    *    Remember stage whose outputs are invalidated when the transaction is committed
+    *
+    *  @param[in] stage
+    *    Stage (must NOT be null!)
+    */
+    void deferInvalidateOutputs(Stage * stage);
+
+    /**
+    *  @brief
+    *    Drop deferred notifications of a stage and its substages
+    *
+    *  @param[in] stage
+    *    Stage that is about to be removed (must NOT be null!)
+    */
+    void discardDeferred(Stage * stage);
+
+    /**
+    *  @brief
+    *    Drop deferred notification of an input
+    *
+    *  @param[in] slot
+    *    Input that is about to be removed (must NOT be null!)
+    */
+    void discardDeferred(AbstractSlot * slot);
+
+    /**
+    *  @brief
+    *    Assign transaction pipeline to a stage and all of its substages
+    *
+    *  @param[in] stage
+    *    Stage (must NOT be null!)
+    *  @param[in] pipeline
+    *    Outermost pipeline with an open transaction (can be null)
+    */
+    static void setTransactionPipeline(Stage * stage, Pipeline * pipeline);
+
+    /**
+    *  @brief
+    *    Deliver deferred notifications and invalidate affected stages
+    *
+    *  @remarks
+    *    Must be called on the outermost pipeline while the transaction
+    *    is still open, so that the invalidation cascade is deferred as well.
+    */
+    void flushTransaction();
+
     // Virtual Stage interface
     virtual void onContextInit(AbstractGLContext * context) override;
     virtual void onContextDeinit(AbstractGLContext * context) override;
@@ -153,9 +336,17 @@ protected:
 
 
 protected:
-    std::vector<Stage *>                     m_stages;    ///< List of topologically sorted stages in the pipeline
-    std::unordered_map<std::string, Stage *> m_stagesMap; ///< Map of names -> stages
-    bool                                     m_sorted;    ///< Have the stages of the pipeline already been sorted?
+    std::vector<Stage *>                                   m_stages;                ///< List of topologically sorted stages in the pipeline
+    std::unordered_map<std::string, Stage *>               m_stagesMap;             ///< Map of names -> stages
+    std::unordered_map<Stage *, std::vector<Stage *>>      m_dependencies;          ///< Cached direct dependencies of each stage (stage -> stages it requires)
+    std::unordered_set<Stage *>                            m_dirtyDependencies;     ///< Stages whose cached dependencies have to be recomputed
+    bool                                                   m_sorted;                ///< Have the stages of the pipeline already been sorted?
+    std::unordered_map<Stage *, std::pair<size_t, size_t>> m_renderTargetLifetimes; ///< Cached render target lifetimes (stage -> first and last stage index, last is the maximum value if the render targets escape)
+    unsigned int                                           m_transactionDepth;      ///< Number of nested open transactions (only used on the outermost pipeline)
+    std::vector<std::pair<Stage *, AbstractSlot *>>        m_deferredInputs;        ///< Changed inputs to be delivered on commit (stage, slot), in order of their first change
+    std::unordered_set<AbstractSlot *>                     m_deferredInputSet;      ///< Inputs contained in m_deferredInputs that have not been delivered yet
+    std::vector<Stage *>                                   m_deferredStages;        ///< Stages whose outputs are invalidated on commit, in order of their first invalidation
+    std::unordered_set<Stage *>                            m_deferredStageSet;      ///< Stages contained in m_deferredStages
 };
 
 
@@ -152,6 +152,7 @@ public:
     virtual bool hasChanged() const override;
     virtual void setChanged(bool hasChanged) override;
     virtual void onRequiredChanged() override;
+    virtual void promoteValueChanged() override;
 
     // Virtual Typed<T> interface
     virtual T value() const override;
@@ -6,6 +6,7 @@
 
 #include <cppexpose/typed/Typed.h>
 
+#include <gloperate/base/logging.h>
 #include <gloperate/pipeline/Stage.h>
 #include <gloperate/pipeline/Slot.h>
 
@@ -75,7 +76,7 @@ bool Slot<T>::connect(Slot<T> * source)
 {
     assert(source != nullptr);
 
-    cppassist::debug(2, "gloperate") << this->qualifiedName() << ": connect slot " << source->qualifiedName();
+    GLOPERATE_DEBUG(2) << this->qualifiedName() << ": connect slot " << source->qualifiedName();
 
     // Check if source is valid
     if (!source) {
@@ -148,7 +149,7 @@ bool Slot<T>::connect(AbstractSlot * source)
     // Check if source is valid and compatible data container
     if (!source || !isCompatible(source))
     {
-        cppassist::debug(2, "gloperate") << this->qualifiedName() << ": connect slot failed for " << source->qualifiedName();
+        GLOPERATE_DEBUG(2) << this->qualifiedName() << ": connect slot failed for " << source->qualifiedName();
         return false;
     }
 
@@ -164,7 +165,7 @@ void Slot<T>::disconnect()
     m_valueConnection = cppexpose::ScopedConnection();
     m_validConnection = cppexpose::ScopedConnection();
 
-    cppassist::debug(2, "gloperate") << this->qualifiedName() << ": disconnect slot";
+    GLOPERATE_DEBUG(2) << this->qualifiedName() << ": disconnect slot";
 
     // Emit events
     this->promoteConnection();
@@ -226,6 +227,12 @@ void Slot<T>::onRequiredChanged()
     promoteRequired();
 }
 
+template <typename T>
+void Slot<T>::promoteValueChanged()
+{
+    this->onValueChanged(*this->ptr());
+}
+
 template <typename T>
 T Slot<T>::value() const
 {
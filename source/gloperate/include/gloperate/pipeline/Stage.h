@@ -42,6 +42,7 @@ class Output;
 class GLOPERATE_API Stage : public cppexpose::Object
 {
     friend class Canvas;
+    friend class Pipeline;
 
 
 public:
@@ -83,12 +84,12 @@ public:
 
 
 public:
-    cppexpose::Signal<AbstractSlot *>     inputAdded;    ///< Called when an input slot has been added
-    cppexpose::Signal<AbstractSlot *>     inputRemoved;  ///< Called when an input slot has been removed
-    cppexpose::Signal<AbstractSlot *>     outputAdded;   ///< Called when an output slot has been added
-    cppexpose::Signal<AbstractSlot *>     outputRemoved; ///< Called when an output slot has been removed
-    cppexpose::Signal<AbstractSlot *>     inputChanged;  ///< Called when an input slot has changed its value or options
-    cppexpose::Signal<uint64_t, uint64_t> timeMeasured;  ///< Called when the timing has been measured
+    cppexpose::Signal<AbstractSlot *>               inputAdded;    ///< Called when an input slot has been added
+    cppexpose::Signal<AbstractSlot *>               inputRemoved;  ///< Called when an input slot has been removed
+    cppexpose::Signal<AbstractSlot *>               outputAdded;   ///< Called when an output slot has been added
+    cppexpose::Signal<AbstractSlot *>               outputRemoved; ///< Called when an output slot has been removed
+    cppexpose::Signal<AbstractSlot *>               inputChanged;  ///< Called when an input slot has changed its value or options
+    cppexpose::Signal<uint64_t, uint64_t, uint64_t> timeMeasured; ///< Called when the timing of a process() call has been measured (process index, CPU time, GPU time)
 
 
 public:
@@ -228,6 +229,9 @@ public:
     *    By default, all outputs are invalidated when any input
     *    value of the stage has changed. This behavior can
     *    be overridden with the onInputValueChanged method.
+    *    While a transaction is open on the outermost pipeline,
+    *    the notification is deferred until the transaction
+    *    is committed (see Pipeline::beginTransaction()).
     */
     void inputValueChanged(AbstractSlot * slot);
 
@@ -257,6 +261,23 @@ public:
     */
     void inputOptionsChanged(AbstractSlot * slot);
 
+    /**
+    *  @brief
+    *    Hold back the notification of an output while the stage is processed on a worker thread
+    *
+    *  @param[in] output
+    *    Output slot which has changed its value or has been invalidated
+    *
+    *  @return
+    *    'true' if the notification is held back, 'false' if it has to be emitted now
+    *
+    *  @remarks
+    *    Held back notifications are delivered on the context thread after
+    *    the stage has finished, so that connected stages are never notified
+    *    from a worker thread (see cpuOnly()).
+    */
+    bool deferOutputNotification(AbstractSlot * output);
+
     /**
     *  @brief
     *    Check if stage is always processed
@@ -288,9 +309,45 @@ public:
     */
     void setAlwaysProcessed(bool alwaysProcess);
 
+    /**
+    *  @brief
+    *    Check if stage is CPU-only
+    *
+    *  @return
+    *    'true' if stage is CPU-only, else 'false'
+    *
+    *  @remarks
+    *    A CPU-only stage does not issue any OpenGL calls in onProcess()
+    *    and only accesses its own slots and state. Its parent pipeline
+    *    may therefore process it on a worker thread, concurrently to
+    *    other stages it does not depend on. Notifications of its outputs
+    *    are held back and delivered on the context thread after the stage
+    *    has finished. Other signals emitted during processing, including
+    *    'timeMeasured', are emitted from the worker thread. Stages that
+    *    take part in feedback connections are always processed on the
+    *    context thread.
+    */
+    bool cpuOnly() const;
+
+    /**
+    *  @brief
+    *    Set if stage is CPU-only
+    *
+    *  @param[in] cpuOnly
+    *    'true' if stage is CPU-only, else 'false'
+    *
+    *  @see
+    *    cpuOnly()
+    */
+    void setCPUOnly(bool cpuOnly);
+
     /**
     *  @brief
     *    Invalidate all outputs
+    *
+    *  @remarks
+    *    While a transaction is open on the outermost pipeline,
+    *    the outputs are invalidated when the transaction is committed.
     */
     void invalidateOutputs();
 
@@ -661,7 +718,8 @@ public:
     *    duration in nanoseconds
     *
     *  @remarks
-    *    To be consistent with 'lastGPUTime', this value is one iteration (i.e. frame) late.
+    *    To be consistent with 'lastGPUTime', this value belongs to
+    *    the most recent frame for which GPU results are available.
     */
     std::uint64_t lastCPUTime() const;
 
@@ -673,7 +731,12 @@ public:
     *    duration in nanoseconds
     *
     *  @remarks
-    *    Due to the async nature of GPU processing, this value is one iteration (i.e. frame) late.
+    *    Due to the async nature of GPU processing, this value is
+    *    one or more iterations (i.e. frames) late. Use the signal
+    *    'timeMeasured' to get the process index a measurement belongs to.
+    *    The process index counts the measured process() calls of this
+    *    stage only, so it does not match the indices of other stages or
+    *    frames if the stage is not processed in every frame.
     */
     std::uint64_t lastGPUTime() const;
 
@@ -700,6 +763,31 @@ public:
     */
     virtual void setTimeMeasurement(bool enabled, bool recursive = false);
 
+    /**
+    *  @brief
+    *    Get number of frames that can be in flight for time measurements
+    *
+    *  @return
+    *    Number of query pairs used for GPU time measurements
+    */
+    unsigned int timeMeasurementQueryCount() const;
+
+    /**
+    *  @brief
+    *    Set number of frames that can be in flight for time measurements
+    *
+    *  @param[in] count
+    *    Number of query pairs used for GPU time measurements (must be > 0)
+    *
+    *  @remarks
+    *    GPU timer queries are never waited for. Instead, their results
+    *    are polled at the beginning of each process() and reported via
+    *    'timeMeasured' as soon as they are available. If all query pairs
+    *    are still in flight, the GPU time of that frame is not measured.
+    *    Previous measurement values are set to 0.
+    */
+    void setTimeMeasurementQueryCount(unsigned int count);
+
 
 protected:
     /**
@@ -826,18 +914,88 @@ protected:
     */
     void registerOutput(AbstractSlot * output);
 
+    /**
+    *  @brief
+    *    Create OpenGL query objects for the current query count
+    *
+    *  @remarks
+    *    Must be called with an active OpenGL context.
+    */
+    void createTimeQueries();
+
+    /**
+    *  @brief
+    *    Release OpenGL query objects
+    *
+    *  @remarks
+    *    Must be called with an active OpenGL context.
+    */
+    void destroyTimeQueries();
+
+    /**
+    *  @brief
+    *    Emit measurements of all finished process() calls without blocking
+    */
+    void collectTimeMeasurements();
+
+    /**
+    *  @brief
+    *    Get pipeline that holds an open transaction for this stage
+    *
+    *  @return
+    *    Outermost pipeline containing the stage (or the stage itself),
+    *    if it has an open transaction, else null
+    *
+    *  @remarks
+    *    The pipeline is assigned to all of its stages when the transaction
+    *    is opened, so this does not need to walk up the stage hierarchy.
+    */
+    Pipeline * transactionPipeline() const;
+
+    /**
+    *  @brief
+    *    Deliver output notifications and time measurements that have been held back during processing
+    *
+    *  @remarks
+    *    Must be called on the context thread after the stage has
+    *    been processed on a worker thread.
+    */
+    void promoteDeferredOutputs();
+
+
+protected:
+    /**
+    *  @brief
+    *    Query pair for one measured process() call
+    */
+    struct TimeQuery
+    {
+        unsigned int startQuery;   ///< OpenGL timestamp query issued before onProcess
+        unsigned int endQuery;     ///< OpenGL timestamp query issued after onProcess
+        uint64_t     processIndex; ///< Index of the measured process() call
+        uint64_t     cpuDuration;  ///< Time spent in onProcess during the measured call (in nanoseconds)
+    };
+
 
 protected:
     Environment * m_environment;    ///< Gloperate environment to which the stage belongs
     bool          m_alwaysProcess;  ///< Is the stage always processed?
-
-    bool                        m_timeMeasurement;      ///< Status of time measurements for CPU and GPU
-    bool                        m_useQueryPairOne;      ///< Flag indicating which queries are currently used
-    bool                        m_resultAvailable;      ///< Flag indicating whether a measurement from previous frames is available for report
-    std::array<unsigned int, 4> m_queries;              ///< OpenGL query objects (front/back; start/end)
-    uint64_t                    m_lastCPUDuration;      ///< Time spent in onProcess last frame (in nanoseconds)
-    uint64_t                    m_currentCPUDuration;   ///< Time spent in onProcess current frame (in nanoseconds)
-    uint64_t                    m_lastGPUDuration;      ///< Time for GPU commands issued during onProcess (in nanoseconds)
+    bool          m_cpuOnly;        ///< Can the stage be processed without OpenGL context on a worker thread?
+
+    bool                        m_deferOutputs;    ///< Hold back output notifications, as the stage is processed on a worker thread
+    std::vector<AbstractSlot *> m_deferredOutputs; ///< Outputs with held back notifications, in order of their first change
+    bool                        m_deferredTiming;  ///< Has a time measurement been held back, as timeMeasured must be emitted on the context thread?
+
+    Pipeline * m_transactionPipeline; ///< Outermost pipeline while it has an open transaction, else null
+
+    bool                   m_timeMeasurement;    ///< Status of time measurements for CPU and GPU
+    unsigned int           m_timeQueryCount;     ///< Number of query pairs (i.e., frames in flight) used for time measurements
+    std::vector<TimeQuery> m_timeQueries;        ///< Ring of OpenGL query pairs (empty if not created)
+    size_t                 m_oldestTimeQuery;    ///< Index of the oldest pending query pair in the ring
+    size_t                 m_pendingTimeQueries; ///< Number of query pairs with pending results
+    uint64_t               m_processIndex;       ///< Index of the next measured process() call of this stage
+    uint64_t               m_lastCPUDuration;    ///< Time spent in onProcess in the last reported frame (in nanoseconds)
+    uint64_t               m_lastGPUDuration;    ///< Time for GPU commands issued during onProcess in the last reported frame (in nanoseconds)
 
     std::vector<AbstractSlot *>                     m_inputs;     ///< List of inputs
     std::unordered_map<std::string, AbstractSlot *> m_inputsMap;  ///< Map of names and inputs
@@ -59,8 +59,8 @@ public:
 
 protected:
     std::unique_ptr<Drawable>          m_drawable;  ///< Underlying drawable object
-    std::unique_ptr<globjects::Buffer> m_vertices;  ///< Vertex buffer
-    std::unique_ptr<globjects::Buffer> m_texCoords; ///< Texture coordinate buffer
+    std::shared_ptr<globjects::Buffer> m_vertices;  ///< Vertex buffer (shared with other shapes of the same size)
+    std::shared_ptr<globjects::Buffer> m_texCoords; ///< Texture coordinate buffer (shared with other boxes)
 };
 
 
@@ -3,6 +3,7 @@
 
 
 #include <vector>
+#include <memory>
 #include <unordered_map>
 #include <array>
 #include <cstdint>
@@ -27,9 +28,49 @@ namespace gloperate
 */
 enum class DrawMode : unsigned int
 {
-    Arrays,             ///< Dispatch to glDrawArrays
-    ElementsIndices,    ///< Dispatch to glDrawElements using a CPU index buffer
-    ElementsIndexBuffer ///< Dispatch to glDrawElements using a GPU index buffer
+    Arrays,              ///< Dispatch to glDrawArrays
+    ElementsIndices,     ///< Dispatch to glDrawElements using a CPU index buffer (uploaded once to the GPU)
+    ElementsIndexBuffer, ///< Dispatch to glDrawElements using a GPU index buffer
+    ArraysIndirect,      ///< Dispatch to glMultiDrawArraysIndirect using a GPU command buffer
+    ElementsIndirect     ///< Dispatch to glMultiDrawElementsIndirect using a GPU command buffer and index buffer
+};
+
+
+/**
+*  @brief
+*    Command for DrawMode::ArraysIndirect (layout defined by OpenGL)
+*/
+struct GLOPERATE_API DrawArraysIndirectCommand
+{
+    gl::GLuint count;         ///< Number of vertices
+    gl::GLuint instanceCount; ///< Number of instances
+    gl::GLuint first;         ///< Index of the first vertex
+    gl::GLuint baseInstance;  ///< Index of the first instance (used for instanced vertex attributes)
+};
+
+
+/**
+*  @brief
+*    Command for DrawMode::ElementsIndirect (layout defined by OpenGL)
+*/
+struct GLOPERATE_API DrawElementsIndirectCommand
+{
+    gl::GLuint count;         ///< Number of indices
+    gl::GLuint instanceCount; ///< Number of instances
+    gl::GLuint firstIndex;    ///< Position of the first index
+    gl::GLint  baseVertex;    ///< Value added to each index
+    gl::GLuint baseInstance;  ///< Index of the first instance (used for instanced vertex attributes)
+};
+
+
+/**
+*  @brief
+*    Range of vertices or indices of a drawable, e.g., a submesh
+*/
+struct GLOPERATE_API DrawRange
+{
+    gl::GLint   first; ///< Position of the first vertex or index
+    gl::GLsizei count; ///< Number of vertices or indices
 };
 
 
@@ -45,6 +86,12 @@ enum class DrawMode : unsigned int
 *    - glDrawArrays
 *    - glDrawElements using CPU index buffer
 *    - glDrawElements using GPU index buffer
+*    - glMultiDrawArraysIndirect using GPU command buffer
+*    - glMultiDrawElementsIndirect using GPU command buffer
+*
+*    If an instance count other than 1 is set, glDrawArrays and glDrawElements
+*    are replaced by their instanced variants. Per-instance vertex attributes
+*    are configured using setAttributeBindingDivisor().
 *
 *    Supported buffer arrangements:
 *    - Separate buffer per vertex attribute
@@ -223,6 +270,45 @@ public:
     */
     void drawElements(gl::GLenum mode, gl::GLsizei count, gl::GLenum type, globjects::Buffer * indices) const;
 
+    /**
+    *  @brief
+    *    Draw geometry by rendering all commands of the command buffer
+    *
+    *  @remarks
+    *    Triggers a glMultiDrawArraysIndirect draw call with the currently
+    *    configured primitive mode and command buffer.
+    */
+    void drawArraysIndirect() const;
+
+    /**
+    *  @brief
+    *    Draw geometry by rendering all commands of the command buffer, override primitive mode
+    *
+    *  @param[in] mode
+    *    Primitive mode to be used for this specific draw call
+    */
+    void drawArraysIndirect(gl::GLenum mode) const;
+
+    /**
+    *  @brief
+    *    Draw geometry by index-based rendering of all commands of the command buffer
+    *
+    *  @remarks
+    *    Triggers a glMultiDrawElementsIndirect draw call with the currently
+    *    configured primitive mode, command buffer, and index buffer. If no
+    *    GPU index buffer is set, the CPU index buffer is used.
+    */
+    void drawElementsIndirect() const;
+
+    /**
+    *  @brief
+    *    Draw geometry by index-based rendering of all commands of the command buffer, override primitive mode
+    *
+    *  @param[in] mode
+    *    Primitive mode to be used for this specific draw call
+    */
+    void drawElementsIndirect(gl::GLenum mode) const;
+
     /**
     *  @brief
     *    Get vertex count
@@ -245,6 +331,38 @@ public:
     */
     void setSize(gl::GLsizei size);
 
+    /**
+    *  @brief
+    *    Get draw ranges
+    *
+    *  @return
+    *    Configured ranges of vertices or indices (can be empty)
+    */
+    const std::vector<DrawRange> & ranges() const;
+
+    /**
+    *  @brief
+    *    Set draw ranges
+    *
+    *  @param[in] ranges
+    *    Ranges of vertices or indices, e.g., one per submesh
+    *
+    *  @remarks
+    *    Ranges refer to vertices for DrawMode::Arrays and
+    *    DrawMode::ArraysIndirect and to indices otherwise.
+    *    They do not affect draw().
+    */
+    void setRanges(const std::vector<DrawRange> & ranges);
+
+    /**
+    *  @brief
+    *    Draw a single range with the configured draw mode and primitive mode
+    *
+    *  @param[in] index
+    *    Index of the range (must be valid!)
+    */
+    void drawRange(size_t index) const;
+
     /**
     *  @brief
     *    Get primitive mode
@@ -263,6 +381,80 @@ public:
     */
     void setPrimitiveMode(gl::GLenum mode);
 
+    /**
+    *  @brief
+    *    Get instance count
+    *
+    *  @return
+    *    Number of instances rendered by each non-indirect draw call
+    */
+    gl::GLsizei instanceCount() const;
+
+    /**
+    *  @brief
+    *    Set instance count
+    *
+    *  @param[in] instanceCount
+    *    Number of instances rendered by each non-indirect draw call (default: 1)
+    */
+    void setInstanceCount(gl::GLsizei instanceCount);
+
+    /**
+    *  @brief
+    *    Get command buffer
+    *
+    *  @return
+    *    Command buffer for indirect draw calls (can be null)
+    */
+    globjects::Buffer * commandBuffer() const;
+
+    /**
+    *  @brief
+    *    Set command buffer
+    *
+    *  @param[in] buffer
+    *    Command buffer, containing DrawArraysIndirectCommand or DrawElementsIndirectCommand entries (must NOT be null!)
+    *  @param[in] commandCount
+    *    Number of commands
+    *
+    *  @remarks
+    *    The buffer is not owned by the drawable.
+    */
+    void setCommandBuffer(globjects::Buffer * buffer, gl::GLsizei commandCount);
+
+    /**
+    *  @brief
+    *    Get command count
+    *
+    *  @return
+    *    Number of commands rendered by indirect draw calls
+    */
+    gl::GLsizei commandCount() const;
+
+    /**
+    *  @brief
+    *    Set commands for DrawMode::ArraysIndirect
+    *
+    *  @param[in] commands
+    *    Draw commands
+    *
+    *  @remarks
+    *    The commands are uploaded to a command buffer owned by the drawable.
+    */
+    void setCommands(const std::vector<DrawArraysIndirectCommand> & commands);
+
+    /**
+    *  @brief
+    *    Set commands for DrawMode::ElementsIndirect
+    *
+    *  @param[in] commands
+    *    Draw commands
+    *
+    *  @remarks
+    *    The commands are uploaded to a command buffer owned by the drawable.
+    */
+    void setCommands(const std::vector<DrawElementsIndirectCommand> & commands);
+
     /**
     *  @brief
     *    Set vertex buffer data
@@ -412,6 +604,10 @@ public:
     *
     *  @param[in] indices
     *    CPU index buffer (needs to be of type GL_UNSIGNED_INT).
+    *
+    *  @remarks
+    *    The indices are uploaded once to a GPU buffer owned by the drawable,
+    *    which is used for all draw calls with DrawMode::ElementsIndices.
     */
     void setIndices(const std::vector<std::uint32_t> & indices);
 
@@ -489,6 +685,17 @@ public:
     */
     void setAttributeBindingFormatL(size_t bindingIndex, gl::GLint size, gl::GLenum type, gl::GLuint relativeOffset);
 
+    /**
+    *  @brief
+    *    Set instance divisor for vertex attribute binding
+    *
+    *  @param[in] bindingIndex
+    *    Binding index
+    *  @param[in] divisor
+    *    Number of instances that share one value (0 for per-vertex attributes)
+    */
+    void setAttributeBindingDivisor(size_t bindingIndex, gl::GLuint divisor);
+
     /**
     *  @brief
     *    Associate vertex attribute binding with a vertex shader attribute input index
@@ -525,6 +732,77 @@ public:
     void enableAllAttributeBindings();
 
 
+protected:
+    /**
+    *  @brief
+    *    Draw geometry by index-based rendering using the index buffer of a draw mode
+    *
+    *  @param[in] drawMode
+    *    Draw mode that selects the index buffer
+    *  @param[in] mode
+    *    Primitive mode
+    *
+    *  @remarks
+    *    Nothing is drawn if the draw mode has no index buffer.
+    */
+    void drawElements(DrawMode drawMode, gl::GLenum mode) const;
+
+    /**
+    *  @brief
+    *    Draw all commands of the command buffer using the index buffer of a draw mode
+    *
+    *  @param[in] drawMode
+    *    Draw mode that selects the index buffer
+    *  @param[in] mode
+    *    Primitive mode
+    *
+    *  @remarks
+    *    Nothing is drawn if the draw mode has no index buffer.
+    */
+    void drawElementsIndirect(DrawMode drawMode, gl::GLenum mode) const;
+
+    /**
+    *  @brief
+    *    Get index buffer used by a draw mode
+    *
+    *  @param[in] drawMode
+    *    Draw mode
+    *  @param[out] type
+    *    Type of the indices
+    *
+    *  @return
+    *    GPU index buffer or uploaded CPU index buffer (null if no indices have been set)
+    */
+    globjects::Buffer * activeIndexBuffer(DrawMode drawMode, gl::GLenum & type) const;
+
+    /**
+    *  @brief
+    *    Bind index buffer to the vertex array
+    *
+    *  @param[in] buffer
+    *    Index buffer (can be null)
+    *
+    *  @remarks
+    *    The binding is part of the vertex array state and is only changed if the buffer differs.
+    */
+    void bindElementBuffer(globjects::Buffer * buffer) const;
+
+    /**
+    *  @brief
+    *    Dispatch glDrawElements or its instanced variant
+    *
+    *  @param[in] mode
+    *    Primitive mode
+    *  @param[in] count
+    *    Number of indices
+    *  @param[in] type
+    *    Type of the indices
+    *  @param[in] indices
+    *    Offset into the bound index buffer, or pointer to CPU indices if no index buffer is bound
+    */
+    void dispatchElements(gl::GLenum mode, gl::GLsizei count, gl::GLenum type, const void * indices) const;
+
+
 protected:
     std::unique_ptr<globjects::VertexArray>        m_vao;     ///< The VertexArray used for the vertex shader input specification and draw call triggering
     std::unordered_map<size_t, globjects::Buffer*> m_buffers; ///< The collection of all buffers associated with this geometry. (Note: this class can be used without storing actual buffers here)
@@ -535,6 +813,14 @@ protected:
     gl::GLenum                 m_indexBufferType; ///< The configured GPU index buffer type of the currently set index buffer.
     globjects::Buffer*         m_indexBuffer;     ///< The configured GPU index buffer that is used if no specific index buffer in passed in the draw method.
     std::vector<std::uint32_t> m_indices;         ///< The configured CPU index buffer that is used if no specific index buffer in passed in the draw method (Note: implied GL_UNSIGNED_INT as index buffer type).
+    std::vector<DrawRange>     m_ranges;          ///< The configured draw ranges, e.g., one per submesh.
+    gl::GLsizei                m_instanceCount;   ///< The configured number of instances per non-indirect draw call.
+    globjects::Buffer*         m_commandBuffer;   ///< The configured GPU command buffer for indirect draw calls.
+    gl::GLsizei                m_commandCount;    ///< The configured number of commands in the command buffer.
+
+    std::unique_ptr<globjects::Buffer> m_indicesBuffer;      ///< GPU copy of the CPU index buffer (created by setIndices()).
+    std::unique_ptr<globjects::Buffer> m_ownCommandBuffer;   ///< Command buffer created by setCommands().
+    mutable globjects::Buffer*         m_boundElementBuffer; ///< Index buffer currently bound to the vertex array.
 };
 
 
@@ -0,0 +1,245 @@
+
+#pragma once
+
+
+#include <vector>
+#include <map>
+#include <utility>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <atomic>
+
+#include <glbinding/gl/types.h>
+#include <glbinding/ContextHandle.h>
+
+#include <gloperate/gloperate_api.h>
+
+
+namespace globjects
+{
+    class Framebuffer;
+    class Renderbuffer;
+    class Texture;
+}
+
+
+namespace gloperate
+{
+
+
+class AbstractRenderTarget;
+
+
+/**
+*  @brief
+*    Cache of framebuffer objects shared by all stages of an environment
+*
+*    Framebuffers are identified by their OpenGL context, the set of
+*    attachments and the draw buffers. A framebuffer is created and
+*    configured once on the first request and its completeness is
+*    checked only then. Subsequent requests for the same configuration
+*    return the same framebuffer without changing any OpenGL state.
+*
+*    Framebuffers reference their attachments by OpenGL object. Owners of
+*    textures and renderbuffers that may be used as render targets have to
+*    call remove() before deleting them, otherwise a new object allocated at
+*    the same address would be matched with a stale framebuffer. All
+*    framebuffers of a context are released using clear() (this is done by
+*    the canvas when the render stage is replaced or the context is
+*    deinitialized).
+*
+*    The number of framebuffers per context is bounded; the least recently
+*    used framebuffers are released when the bound is exceeded.
+*/
+class GLOPERATE_API FramebufferCache
+{
+public:
+    /**
+    *  @brief
+    *    Single framebuffer attachment
+    */
+    struct GLOPERATE_API Attachment
+    {
+        gl::GLenum                attachment;   ///< Attachment point (e.g., GL_COLOR_ATTACHMENT0)
+        globjects::Texture      * texture;      ///< Attached texture (can be null)
+        globjects::Renderbuffer * renderbuffer; ///< Attached renderbuffer (can be null)
+
+        bool operator==(const Attachment & other) const;
+        bool operator<(const Attachment & other) const;
+    };
+
+
+public:
+    /**
+    *  @brief
+    *    Get attachment of a render target that requires a user-defined framebuffer
+    *
+    *  @param[in] index
+    *    Color attachment index (ignored for depth and stencil render targets)
+    *  @param[in] renderTarget
+    *    Render target (must NOT be null)
+    *  @param[out] attachment
+    *    Attachment of the render target
+    *
+    *  @return
+    *    'true' if the render target has a texture or renderbuffer attached, else 'false'
+    */
+    static bool attachment(size_t index, const AbstractRenderTarget * renderTarget, Attachment & attachment);
+
+
+public:
+    /**
+    *  @brief
+    *    Constructor
+    */
+    FramebufferCache();
+
+    /**
+    *  @brief
+    *    Destructor
+    */
+    ~FramebufferCache();
+
+    // No copying
+    FramebufferCache(const FramebufferCache &) = delete;
+    FramebufferCache & operator=(const FramebufferCache &) = delete;
+
+    /**
+    *  @brief
+    *    Get framebuffer for a set of attachments in the current context
+    *
+    *  @param[in] attachments
+    *    Attachments
+    *  @param[in] drawBuffers
+    *    Draw buffers (if empty, draw buffers are left to the caller)
+    *
+    *  @return
+    *    Configured framebuffer (never null)
+    *
+    *  @remarks
+    *    Must be called with an active OpenGL context.
+    */
+    globjects::Framebuffer * framebuffer(const std::vector<Attachment> & attachments, const std::vector<gl::GLenum> & drawBuffers);
+
+    /**
+    *  @brief
+    *    Release all framebuffers of the current context
+    *
+    *  @remarks
+    *    Must be called with an active OpenGL context.
+    */
+    void clear();
+
+    /**
+    *  @brief
+    *    Release all framebuffers that have a texture attached
+    *
+    *  @param[in] texture
+    *    Texture that is about to be deleted
+    *
+    *  @remarks
+    *    Framebuffers of the current context are deleted immediately,
+    *    framebuffers of other contexts are deleted on the next
+    *    request from their context. Therefore, this can also be
+    *    called without an active OpenGL context.
+    */
+    void remove(const globjects::Texture * texture);
+
+    /**
+    *  @brief
+    *    Release all framebuffers that have a renderbuffer attached
+    *
+    *  @param[in] renderbuffer
+    *    Renderbuffer that is about to be deleted
+    *
+    *  @see remove(const globjects::Texture *)
+    */
+    void remove(const globjects::Renderbuffer * renderbuffer);
+
+    /**
+    *  @brief
+    *    Get generation of the cache
+    *
+    *  @return
+    *    Generation, incremented each time framebuffers are released
+    *
+    *  @remarks
+    *    Users that keep pointers to cached framebuffers have to
+    *    request them again if the generation has changed.
+    */
+    unsigned int generation() const;
+
+
+protected:
+    /**
+    *  @brief
+    *    Identification of a cached framebuffer
+    */
+    struct Key
+    {
+        glbinding::ContextHandle context;     ///< OpenGL context
+        std::vector<Attachment>  attachments; ///< Attachments
+        std::vector<gl::GLenum>  drawBuffers; ///< Draw buffers
+
+        bool operator<(const Key & other) const;
+    };
+
+    /**
+    *  @brief
+    *    Cached framebuffer
+    */
+    struct Entry
+    {
+        std::unique_ptr<globjects::Framebuffer> framebuffer; ///< Framebuffer
+        unsigned long long                      lastUse;     ///< Time of the last request
+    };
+
+
+protected:
+    /**
+    *  @brief
+    *    Release all framebuffers that reference an attachment
+    *
+    *  @param[in] predicate
+    *    Returns 'true' for attachments that are about to be deleted
+    *
+    *  @remarks
+    *    The mutex must be locked by the caller.
+    */
+    void removeIf(const std::function<bool(const Attachment &)> & predicate);
+
+    /**
+    *  @brief
+    *    Delete framebuffers of the current context that have been released from another context
+    *
+    *  @remarks
+    *    The mutex must be locked by the caller.
+    */
+    void deleteOrphans();
+
+    /**
+    *  @brief
+    *    Release least recently used framebuffers of the current context until the bound is met
+    *
+    *  @remarks
+    *    The mutex must be locked by the caller.
+    */
+    void trim();
+
+
+protected:
+    static const size_t s_maxFramebuffers; ///< Maximum number of cached framebuffers per context
+
+
+protected:
+    std::map<Key, Entry>                  m_framebuffers; ///< Cached framebuffers
+    std::vector<std::pair<glbinding::ContextHandle, std::unique_ptr<globjects::Framebuffer>>>
+                                          m_orphans;      ///< Released framebuffers waiting for their context
+    unsigned long long                    m_time;         ///< Logical time, incremented on each request
+    std::mutex                            m_mutex;        ///< Mutex for accessing the cache from several render threads
+    std::atomic<unsigned int>             m_generation;   ///< Generation, incremented each time framebuffers are released
+};
+
+
+} // namespace gloperate
@@ -4,6 +4,7 @@
 
 #include <array>
 #include <vector>
+#include <cstdint>
 #include <unordered_map>
 
 #include <glm/vec3.hpp>
@@ -29,7 +30,13 @@ public:
     *  @brief
     *    Data type for faces
     */
-    using Face = std::array<gl::GLushort, 3>;
+    using Face = std::array<gl::GLuint, 3>;
+
+    /**
+    *  @brief
+    *    Maximum number of refinement iterations (655362 vertices)
+    */
+    static const gl::GLsizei MaxIterations = 8;
 
 
 public:
@@ -88,7 +95,7 @@ public:
     *    Create and refine geometry
     *
     *  @param[in] iterations
-    *    Number of refinement iterations
+    *    Number of refinement iterations (clamped to [0, MaxIterations])
     */
     void generateGeometry(gl::GLsizei iterations = 0);
 
@@ -127,7 +134,7 @@ public:
     *  @return
     *    Index array (describes a list of triangles)
     */
-    const std::vector<std::array<gl::GLushort, 3>> & indices() const;
+    const std::vector<Face> & indices() const;
 
 
 private:
@@ -151,11 +158,11 @@ private:
     *  @return
     *    Index of the new point
     */
-    static gl::GLushort split(
-        gl::GLushort a
-    ,   gl::GLushort b
+    static gl::GLuint split(
+        gl::GLuint a
+    ,   gl::GLuint b
     ,   std::vector<glm::vec3> & points
-    ,   std::unordered_map<glm::uint, gl::GLushort> & cache);
+    ,   std::unordered_map<std::uint64_t, gl::GLuint> & cache);
 
 
 private:
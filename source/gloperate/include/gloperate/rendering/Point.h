@@ -42,8 +42,8 @@ public:
 
 protected:
     std::unique_ptr<Drawable>          m_drawable;  ///< Underlying drawable object
-    std::unique_ptr<globjects::Buffer> m_vertices;  ///< Vertex buffer
-    std::unique_ptr<globjects::Buffer> m_texCoords; ///< Texture coordinate buffer
+    std::shared_ptr<globjects::Buffer> m_vertices;  ///< Vertex buffer (shared with other points)
+    std::shared_ptr<globjects::Buffer> m_texCoords; ///< Texture coordinate buffer (shared with other points)
 };
 
 
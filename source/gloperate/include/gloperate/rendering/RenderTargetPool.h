@@ -0,0 +1,201 @@
+
+#pragma once
+
+
+#include <vector>
+#include <memory>
+#include <mutex>
+
+#include <glbinding/gl/types.h>
+#include <glbinding/ContextHandle.h>
+
+#include <gloperate/gloperate_api.h>
+
+
+namespace globjects
+{
+    class Texture;
+}
+
+
+namespace gloperate
+{
+
+
+class FramebufferCache;
+
+
+/**
+*  @brief
+*    Pool of render target textures shared by all stages of an environment
+*
+*    Textures are identified by their OpenGL context, size and format.
+*    A texture is allocated once and handed out again as long as its
+*    owner requests the same size and format, so unchanged render targets
+*    are not re-specified on every process.
+*
+*    Owners that only use their texture during a known interval of the
+*    stage order of a pipeline can pass that interval as lifetime. Textures
+*    are then shared between owners of the same pipeline whose lifetimes do
+*    not overlap (memory aliasing). Owners without a lifetime always get an
+*    exclusive texture.
+*
+*    Released textures are kept for reuse up to a fixed number per context.
+*    All textures of the current context have to be released using clear()
+*    before the context is destroyed (this is done by the canvas).
+*/
+class GLOPERATE_API RenderTargetPool
+{
+public:
+    /**
+    *  @brief
+    *    Interval of the stage order in which a texture is used
+    */
+    struct GLOPERATE_API Lifetime
+    {
+        const void * scope; ///< Scope in which first and last are comparable, e.g., the pipeline (null for exclusive use)
+        size_t       first; ///< Index of the first stage that uses the texture
+        size_t       last;  ///< Index of the last stage that uses the texture
+
+        /**
+        *  @brief
+        *    Check if two lifetimes overlap
+        *
+        *  @param[in] other
+        *    Other lifetime
+        *
+        *  @return
+        *    'true' if textures with both lifetimes cannot be shared, else 'false'
+        */
+        bool overlaps(const Lifetime & other) const;
+    };
+
+
+public:
+    /**
+    *  @brief
+    *    Constructor
+    *
+    *  @param[in] framebufferCache
+    *    Framebuffer cache that is notified when textures are deleted (must NOT be null!)
+    */
+    RenderTargetPool(FramebufferCache * framebufferCache);
+
+    /**
+    *  @brief
+    *    Destructor
+    */
+    ~RenderTargetPool();
+
+    // No copying
+    RenderTargetPool(const RenderTargetPool &) = delete;
+    RenderTargetPool & operator=(const RenderTargetPool &) = delete;
+
+    /**
+    *  @brief
+    *    Acquire texture in the current context
+    *
+    *  @param[in] owner
+    *    Owner of the texture (must NOT be null!)
+    *  @param[in] width
+    *    Width of the texture
+    *  @param[in] height
+    *    Height of the texture
+    *  @param[in] internalFormat
+    *    OpenGL internal image format
+    *  @param[in] format
+    *    OpenGL image format
+    *  @param[in] type
+    *    OpenGL data type
+    *  @param[in] lifetime
+    *    Interval in which the owner uses the texture
+    *
+    *  @return
+    *    Texture (never null)
+    *
+    *  @remarks
+    *    A texture previously acquired by the owner is released, unless
+    *    it still matches the request, in which case it is returned again.
+    *    The contents of a texture shared with other owners are undefined
+    *    at the start of the lifetime. Must be called with an active
+    *    OpenGL context.
+    */
+    globjects::Texture * acquire(const void * owner, int width, int height, gl::GLenum internalFormat, gl::GLenum format, gl::GLenum type, const Lifetime & lifetime = { nullptr, 0, 0 });
+
+    /**
+    *  @brief
+    *    Release texture of an owner
+    *
+    *  @param[in] owner
+    *    Owner of the texture
+    *
+    *  @remarks
+    *    Must be called with an active OpenGL context.
+    */
+    void release(const void * owner);
+
+    /**
+    *  @brief
+    *    Delete all textures of the current context
+    *
+    *  @remarks
+    *    Must be called with an active OpenGL context.
+    */
+    void clear();
+
+
+protected:
+    /**
+    *  @brief
+    *    Owner of a texture together with its lifetime
+    */
+    struct Reservation
+    {
+        const void * owner;    ///< Owner
+        Lifetime     lifetime; ///< Interval in which the owner uses the texture
+    };
+
+    /**
+    *  @brief
+    *    Pooled texture
+    */
+    struct Entry
+    {
+        glbinding::ContextHandle            context;        ///< OpenGL context
+        int                                 width;          ///< Width of the texture
+        int                                 height;         ///< Height of the texture
+        gl::GLenum                          internalFormat; ///< OpenGL internal image format
+        gl::GLenum                          format;         ///< OpenGL image format
+        gl::GLenum                          type;           ///< OpenGL data type
+        std::unique_ptr<globjects::Texture> texture;        ///< Texture
+        std::vector<Reservation>            reservations;   ///< Current owners (empty if the texture is free)
+        unsigned int                        lastUse;        ///< Time stamp of the last release, used to delete the oldest free textures first
+    };
+
+
+protected:
+    /**
+    *  @brief
+    *    Remove reservation of an owner without locking
+    *
+    *  @param[in] owner
+    *    Owner of the texture
+    */
+    void releaseReservation(const void * owner);
+
+    /**
+    *  @brief
+    *    Delete the oldest free textures of the current context exceeding the limit
+    */
+    void trim();
+
+
+protected:
+    FramebufferCache   * m_framebufferCache; ///< Framebuffer cache that references pooled textures
+    std::vector<Entry>   m_entries;          ///< Pooled textures
+    unsigned int         m_time;             ///< Time stamp counter for releases
+    std::mutex           m_mutex;            ///< Mutex for accessing the pool from several render threads
+};
+
+
+} // namespace gloperate
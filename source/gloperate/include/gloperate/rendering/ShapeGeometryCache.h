@@ -0,0 +1,113 @@
+
+#pragma once
+
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <functional>
+
+#include <glm/vec4.hpp>
+
+#include <glbinding/ContextHandle.h>
+
+#include <gloperate/gloperate_api.h>
+#include <gloperate/rendering/ShapeType.h>
+
+
+namespace globjects
+{
+    class Buffer;
+}
+
+
+namespace gloperate
+{
+
+
+/**
+*  @brief
+*    Process-wide cache of vertex and index buffers of basic shapes
+*
+*    Buffers are identified by their OpenGL context, shape type, a
+*    component name (e.g., "vertices"), and up to four shape parameters
+*    (e.g., dimensions and subdivision level). Parameters that do not
+*    affect a component, such as the dimensions for texture coordinates,
+*    should be zero, so that the component is shared by all shapes of
+*    that type.
+*
+*    The cache does not own the buffers. A buffer is deleted when the last
+*    shape that uses it is destroyed, which has to happen while its context
+*    is current.
+*/
+class GLOPERATE_API ShapeGeometryCache
+{
+public:
+    /**
+    *  @brief
+    *    Get cache instance
+    *
+    *  @return
+    *    Process-wide cache
+    */
+    static ShapeGeometryCache & instance();
+
+
+public:
+    /**
+    *  @brief
+    *    Get buffer for the current context
+    *
+    *  @param[in] type
+    *    Shape type
+    *  @param[in] component
+    *    Component name
+    *  @param[in] parameters
+    *    Shape parameters that affect the buffer content
+    *  @param[in] initialize
+    *    Function that uploads the buffer content, called only on cache misses
+    *
+    *  @return
+    *    Shared buffer (never null)
+    */
+    std::shared_ptr<globjects::Buffer> buffer(ShapeType type, const std::string & component, const glm::vec4 & parameters, const std::function<void(globjects::Buffer *)> & initialize);
+
+
+protected:
+    /**
+    *  @brief
+    *    Key of a cached buffer
+    */
+    struct Key
+    {
+        glbinding::ContextHandle context;    ///< OpenGL context
+        ShapeType                type;       ///< Shape type
+        std::string              component;  ///< Component name
+        glm::vec4                parameters; ///< Shape parameters
+
+        bool operator<(const Key & other) const;
+    };
+
+
+protected:
+    /**
+    *  @brief
+    *    Constructor
+    */
+    ShapeGeometryCache();
+
+    /**
+    *  @brief
+    *    Destructor
+    */
+    ~ShapeGeometryCache();
+
+
+protected:
+    std::map<Key, std::weak_ptr<globjects::Buffer>> m_buffers; ///< Buffers that are in use
+    std::mutex                                      m_mutex;   ///< Mutex for accessing the cache
+};
+
+
+} // namespace gloperate
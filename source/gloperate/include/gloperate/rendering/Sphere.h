@@ -18,6 +18,11 @@ namespace gloperate
 /**
 *  @brief
 *    Sphere drawable
+*
+*    The sphere is approximated by a refined icosahedron. Vertex buffers
+*    are shared by all spheres with the same radius and subdivision level,
+*    index and texture coordinate buffers by all spheres with the same
+*    subdivision level (see ShapeGeometryCache).
 */
 class GLOPERATE_API Sphere : public Shape
 {
@@ -30,8 +35,10 @@ public:
     *    Sphere radius
     *  @param[in] options
     *    Shape options
+    *  @param[in] subdivisions
+    *    Number of refinement iterations of the icosahedron (level of detail, clamped to [0, Icosahedron::MaxIterations])
     */
-    Sphere(float radius = 1.0f, cppassist::Flags<ShapeOption> options = ShapeOption::None);
+    Sphere(float radius = 1.0f, cppassist::Flags<ShapeOption> options = ShapeOption::None, unsigned int subdivisions = 5);
 
     /**
     *  @brief
@@ -39,16 +46,25 @@ public:
     */
     virtual ~Sphere();
 
+    /**
+    *  @brief
+    *    Get subdivision level
+    *
+    *  @return
+    *    Number of refinement iterations of the icosahedron
+    */
+    unsigned int subdivisions() const;
+
     // Virtual AbstractDrawable functions
     virtual void draw() const override;
 
 
 protected:
-    std::unique_ptr<Icosahedron>       m_icosahedron; ///< Refinable icosahedron
-    std::unique_ptr<Drawable>          m_drawable;    ///< Underlying drawable object
-    std::unique_ptr<globjects::Buffer> m_vertices;    ///< Vertex buffer
-    std::unique_ptr<globjects::Buffer> m_texCoords;   ///< Texture coordinate buffer
-    std::unique_ptr<globjects::Buffer> m_indices;     ///< Index buffer
+    unsigned int                       m_subdivisions; ///< Number of refinement iterations of the icosahedron
+    std::unique_ptr<Drawable>          m_drawable;     ///< Underlying drawable object
+    std::shared_ptr<globjects::Buffer> m_vertices;     ///< Vertex buffer (shared with other spheres of the same radius and level)
+    std::shared_ptr<globjects::Buffer> m_texCoords;    ///< Texture coordinate buffer (shared with other spheres of the same level)
+    std::shared_ptr<globjects::Buffer> m_indices;      ///< Index buffer (shared with other spheres of the same level)
 };
 
 
@@ -84,6 +84,12 @@ protected:
     virtual void onContextDeinit(AbstractGLContext * context) override;
     virtual void onProcess() override;
 
+    /**
+    *  @brief
+    *    Release cached framebuffers that reference the internal textures
+    */
+    void releaseFramebuffers();
+
 
 protected:
     std::unique_ptr<globjects::Texture>           m_colorTexture; ///< Internal color texture
@@ -4,6 +4,7 @@
 
 #include <cppexpose/plugin/plugin_api.h>
 
+#include <glm/vec2.hpp>
 #include <glm/vec4.hpp>
 
 #include <globjects/Framebuffer.h>
@@ -81,11 +82,9 @@ protected:
 
 protected:
     std::unique_ptr<globjects::Framebuffer>       m_defaultFBO;         ///< Intermediate default FBO
-    std::unique_ptr<globjects::Framebuffer>       m_sourceFBO;          ///< Intermediate source FBO
-    std::unique_ptr<globjects::Framebuffer>       m_targetFBO;          ///< Intermediate target FBO
-    std::unique_ptr<globjects::Framebuffer>       m_intermediateFBO;    ///< Intermediate FBO for same-target blitting
     std::unique_ptr<gloperate::ColorRenderTarget> m_intermediateTarget; ///< Intermediate render target for same-target blitting
     std::unique_ptr<globjects::Renderbuffer>      m_intermediateBuffer; ///< Intermediate render buffer for same-target blitting
+    glm::ivec2                                    m_intermediateSize;   ///< Size of the intermediate render buffer storage
 };
 
 
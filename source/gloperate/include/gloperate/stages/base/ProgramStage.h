@@ -83,7 +83,7 @@ protected:
 protected:
     // OpenGL objects
     std::unique_ptr<globjects::Program>             m_program; ///< Program object
-    std::vector<std::unique_ptr<globjects::Shader>> m_shaders; ///< collection of self created shaders for later removal
+    std::vector<std::shared_ptr<globjects::Shader>> m_shaders; ///< Shaders loaded from files (shared with other users of the resource cache)
 
     // Signal connections
     cppexpose::ScopedConnection m_inputAddedConnection;
@@ -2,6 +2,9 @@
 #pragma once
 
 
+#include <array>
+#include <vector>
+
 #include <cppexpose/plugin/plugin_api.h>
 #include <cppexpose/signal/ScopedConnection.h>
 
@@ -17,6 +20,8 @@
 
 namespace globjects
 {
+    class AbstractUniform;
+    class Buffer;
     class Program;
     class State;
 }
@@ -42,6 +47,39 @@ class RenderPass;
 *    globjects::Texture  -  textures are attached via their input name
 *    globjects::Buffer   -  buffers are added as shader storage buffers
 *    uniforms of type T  -  other types are added as uniforms via their input name
+*
+*    Camera and model matrices are set as individual uniforms (e.g.,
+*    'modelViewProjectionMatrix') if the program uses them. Alternatively,
+*    a program can declare the following uniform block, which is uploaded
+*    once per process and bound to uniform buffer binding point 0:
+*    \code{.glsl}
+*
+*        layout (std140) uniform Transforms
+*        {
+*            mat4 viewProjectionMatrix;
+*            mat4 viewProjectionInvertedMatrix;
+*            mat4 viewMatrix;
+*            mat4 viewInvertedMatrix;
+*            mat4 projectionMatrix;
+*            mat4 projectionInvertedMatrix;
+*            mat4 modelMatrix;
+*            mat4 modelViewProjectionMatrix;
+*            mat4 modelViewProjectionInvertedMatrix;
+*            mat4 modelViewMatrix;
+*            mat4 modelViewInvertedMatrix;
+*            mat3 normalMatrix;
+*            mat3 modelNormalMatrix;
+*        };
+*    \endcode
+*
+*    The input 'tileMatrix' is multiplied onto the projection of the
+*    camera (tileMatrix * projection), so that all camera-dependent
+*    matrices render only a part of the image. It is set by the
+*    ImageExporter when an image is rendered tile by tile.
+*
+*    Uniform handles are resolved only when the program or the set of
+*    dynamic inputs changes, so processing does not need string lookups
+*    or type comparisons.
 */
 class GLOPERATE_API RenderPassStage : public Stage
 {
@@ -63,6 +101,7 @@ public:
     Input<globjects::Program *>          program;     ///< The program used for rendering
     Input<gloperate::Camera *>           camera;      ///< The input camera
     Input<glm::mat4>                     modelMatrix; ///< Transformation matrix
+    Input<glm::mat4>                     tileMatrix;  ///< Matrix applied after the camera projection (e.g., set by ImageExporter for tiled rendering)
 
     Input<bool>       depthTest; ///< Enable depth test?
     Input<bool>       depthMask; ///< Enable writing to the depth buffer?
@@ -111,6 +150,51 @@ public:
     Input<T> & createNewUniformInput(const std::string & name, const T & defaultValue = T());
 
 
+protected:
+    /**
+    *  @brief
+    *    Matrices provided to the program
+    */
+    enum Transform
+    {
+        ViewProjectionMatrix = 0,
+        ViewProjectionInvertedMatrix,
+        ViewMatrix,
+        ViewInvertedMatrix,
+        ProjectionMatrix,
+        ProjectionInvertedMatrix,
+        ModelMatrix,
+        ModelViewProjectionMatrix,
+        ModelViewProjectionInvertedMatrix,
+        ModelViewMatrix,
+        ModelViewInvertedMatrix,
+        NormalMatrix,
+        ModelNormalMatrix,
+        TransformCount
+    };
+
+    /**
+    *  @brief
+    *    Resolved uniform of a dynamic input
+    */
+    struct UniformBinding
+    {
+        AbstractSlot               * input;                                               ///< Dynamic input
+        globjects::AbstractUniform * uniform;                                             ///< Uniform of the program
+        void                      (* apply)(globjects::AbstractUniform *, AbstractSlot *); ///< Sets the input value to the uniform
+    };
+
+    /**
+    *  @brief
+    *    Resolved texture input
+    */
+    struct TextureBinding
+    {
+        AbstractSlot               * input;   ///< Dynamic input of type globjects::Texture *
+        globjects::AbstractUniform * uniform; ///< Sampler uniform of the program
+    };
+
+
 protected:
     // Virtual Stage interface
     virtual void onProcess() override;
@@ -118,13 +202,39 @@ protected:
     virtual void onContextDeinit(AbstractGLContext * content) override;
 
     // Helper functions
-    void setUniformValue(globjects::Program * program, AbstractSlot * input);
+
+    /**
+    *  @brief
+    *    Resolve uniforms of dynamic inputs and matrices for the current program
+    */
+    void updateBindings();
+
+    /**
+    *  @brief
+    *    Compute matrices and set them to the program
+    *
+    *  @param[in] camera
+    *    Camera (can be null)
+    *  @param[in] hasModelMatrix
+    *    'true' if a model matrix is set, else 'false'
+    */
+    void updateTransforms(Camera * camera, bool hasModelMatrix);
 
 
 protected:
     // OpenGL objects
-    std::unique_ptr<gloperate::RenderPass> m_renderPass;  ///< The created render pass
-    std::unique_ptr<globjects::State>      m_beforeState; ///< OpenGL states for rendering
+    std::unique_ptr<gloperate::RenderPass> m_renderPass;      ///< The created render pass
+    std::unique_ptr<globjects::State>      m_beforeState;     ///< OpenGL states for rendering
+    std::unique_ptr<globjects::Buffer>     m_transformBuffer; ///< Uniform buffer for the 'Transforms' block
+
+    // Binding table
+    globjects::Program                                      * m_boundProgram;       ///< Program the bindings have been resolved for (can be null)
+    bool                                                      m_bindingsValid;      ///< 'false' if the bindings have to be resolved again, else 'true'
+    std::vector<UniformBinding>                               m_uniformBindings;    ///< Uniforms of dynamic inputs
+    std::vector<TextureBinding>                               m_textureBindings;    ///< Texture inputs
+    std::vector<AbstractSlot *>                               m_bufferBindings;     ///< Shader storage buffer inputs
+    std::array<globjects::AbstractUniform *, TransformCount> m_transformUniforms;  ///< Matrix uniforms used by the program (null if unused)
+    bool                                                      m_useTransformBlock;  ///< 'true' if the program declares the 'Transforms' block, else 'false'
 
     // Signal connections
     cppexpose::ScopedConnection m_inputAddedConnection;
@@ -90,6 +90,8 @@ protected:
     std::unique_ptr<gloperate::ColorRenderTarget>   m_colorRenderTarget;   ///< The color render target
     std::unique_ptr<gloperate::DepthRenderTarget>   m_depthRenderTarget;   ///< The depth render target
     std::unique_ptr<gloperate::StencilRenderTarget> m_stencilRenderTarget; ///< The stencil render target
+    gl::GLenum                                      m_internalFormat;      ///< Internal format of the allocated storage (GL_NONE if not allocated)
+    glm::ivec2                                      m_size;                ///< Size of the allocated storage
 };
 
 
@@ -76,7 +76,7 @@ protected:
 
 
 protected:
-    std::unique_ptr<globjects::Shader> m_shader; ///< Shader object
+    std::shared_ptr<globjects::Shader> m_shader; ///< Shader object (shared with other users of the resource cache)
 };
 
 
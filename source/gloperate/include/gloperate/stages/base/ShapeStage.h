@@ -40,12 +40,13 @@ public:
 
 public:
     // Inputs
-    Input<gloperate::ShapeType> shapeType; ///< Type of shape to create
-    Input<float>                width;     ///< Width of the shape
-    Input<float>                height;    ///< Height of the shape
-    Input<float>                depth;     ///< Depth of the shape
-    Input<float>                radius;    ///< Depth of the shape
-    Input<bool>                 texCoords; ///< If 'true', texture coordinates are generated, else 'false'
+    Input<gloperate::ShapeType> shapeType;    ///< Type of shape to create
+    Input<float>                width;        ///< Width of the shape
+    Input<float>                height;       ///< Height of the shape
+    Input<float>                depth;        ///< Depth of the shape
+    Input<float>                radius;       ///< Depth of the shape
+    Input<int>                  subdivisions; ///< Subdivision level of spheres (level of detail)
+    Input<bool>                 texCoords;    ///< If 'true', texture coordinates are generated, else 'false'
 
     // Outputs
     Output<gloperate::AbstractDrawable *> drawable; ///< Shape drawable
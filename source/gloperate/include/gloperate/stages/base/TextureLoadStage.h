@@ -10,6 +10,7 @@
 
 #include <gloperate/gloperate-version.h>
 #include <gloperate/base/ExtendedProperties.h>
+#include <gloperate/base/AsyncResource.h>
 #include <gloperate/pipeline/Stage.h>
 #include <gloperate/pipeline/Input.h>
 #include <gloperate/pipeline/Output.h>
@@ -22,6 +23,10 @@ namespace gloperate
 /**
 *  @brief
 *    Stage that loads a texture from a file
+*
+*    If loading is asynchronous, the file is read on a worker thread and
+*    the stage outputs the previous texture or an empty placeholder until
+*    the texture has been loaded.
 */
 class GLOPERATE_API TextureLoadStage : public Stage
 {
@@ -39,10 +44,11 @@ public:
 
 public:
     // Inputs
-    Input<cppfs::FilePath>       filename; ///< Texture filename
+    Input<cppfs::FilePath>       filename;     ///< Texture filename
+    Input<bool>                  asynchronous; ///< Load texture on a worker thread? (default: true)
 
     // Outputs
-    Output<globjects::Texture *> texture;  ///< Texture object
+    Output<globjects::Texture *> texture;      ///< Texture object
 
 
 public:
@@ -70,9 +76,21 @@ protected:
     virtual void onContextDeinit(AbstractGLContext * context) override;
     virtual void onProcess() override;
 
+    /**
+    *  @brief
+    *    Update texture output
+    *
+    *  @param[in] newTexture
+    *    Texture (must NOT be null!)
+    */
+    void setTexture(const std::shared_ptr<globjects::Texture> & newTexture);
+
 
 protected:
-    std::unique_ptr<globjects::Texture> m_texture; ///< Texture
+    std::shared_ptr<globjects::Texture> m_texture;     ///< Texture (shared with other users of the resource cache)
+    std::shared_ptr<globjects::Texture> m_placeholder; ///< Empty texture used until loading has finished or if loading has failed
+    AsyncResource<globjects::Texture>   m_loading;     ///< Texture that is being loaded
+    std::string                         m_path;        ///< Path of the texture that is being loaded
 };
 
 
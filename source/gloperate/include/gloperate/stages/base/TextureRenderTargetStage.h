@@ -32,6 +32,15 @@ class StencilRenderTarget;
 /**
 *  @brief
 *    Stage that creates an empty texture with a specified size and format as render target
+*
+*    Textures are acquired from the render target pool of the environment
+*    and are only reallocated if size or format change. If the render target
+*    is marked as transient, its texture may be shared with other transient
+*    render targets of the same pipeline whose lifetimes do not overlap.
+*    A transient render target must be completely rendered in every frame
+*    before it is read, as its contents are not preserved between frames.
+*    Therefore, textures are only shared if all stages that use the render
+*    target are always processed (see Stage::setAlwaysProcessed()).
 */
 class GLOPERATE_API TextureRenderTargetStage : public gloperate::Stage
 {
@@ -53,6 +62,7 @@ public:
     Input<gl::GLenum> format;         ///< OpenGL image format
     Input<gl::GLenum> type;           ///< OpenGL data type
     Input<glm::vec4>  size;           ///< Viewport size (only z and w component is used as width and height)
+    Input<bool>       transient;      ///< If 'true', the texture may be shared with render targets of other stages (default: false)
 
     // Outputs
     Output<globjects::Texture *>             texture;             ///< Texture
@@ -88,7 +98,7 @@ protected:
 
 
 protected:
-    std::unique_ptr<globjects::Texture>             m_texture;             ///< The created texture
+    globjects::Texture                            * m_texture;             ///< The texture acquired from the render target pool (can be null)
     std::unique_ptr<gloperate::ColorRenderTarget>   m_colorRenderTarget;   ///< The color render target
     std::unique_ptr<gloperate::DepthRenderTarget>   m_depthRenderTarget;   ///< The depth render target
     std::unique_ptr<gloperate::StencilRenderTarget> m_stencilRenderTarget; ///< The stencil render target
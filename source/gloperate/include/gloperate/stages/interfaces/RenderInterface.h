@@ -7,6 +7,7 @@
 #include <gloperate/pipeline/Input.h>
 #include <gloperate/pipeline/Output.h>
 #include <gloperate/base/ExtendedProperties.h>
+#include <gloperate/rendering/FramebufferCache.h>
 
 
 namespace globjects
@@ -100,6 +101,10 @@ public:
     *
     *  @remarks
     *    allRenderTargetsCompatible() is expected to return 'true'.
+    *
+    *    User-defined framebuffers are taken from the framebuffer cache of the
+    *    environment. If the render targets did not change since the last call,
+    *    the same framebuffer is returned without any OpenGL calls.
     */
     globjects::Framebuffer * obtainFBO() const;
 
@@ -133,6 +138,27 @@ public:
     */
     static globjects::Framebuffer * obtainFBO(size_t index, AbstractRenderTarget * renderTarget, globjects::Framebuffer * fbo, globjects::Framebuffer * defaultFBO);
 
+    /**
+    *  @brief
+    *    Get a cached framebuffer containing one render target as attachment
+    *
+    *  @param[in] index
+    *    The next color attachment index
+    *  @param[in] renderTarget
+    *    The render target to attach
+    *  @param[in] cache
+    *    The framebuffer cache used for user-defined attachments (must NOT be null)
+    *  @param[in] defaultFBO
+    *    The default framebuffer used for default framebuffer attachments
+    *
+    *  @return
+    *    The matching framebuffer; either a cached framebuffer or defaultFBO, depending on the type of the render target attachment
+    *
+    *  @remarks
+    *    The draw buffers of the returned framebuffer are not configured.
+    */
+    static globjects::Framebuffer * obtainFBO(size_t index, AbstractRenderTarget * renderTarget, FramebufferCache * cache, globjects::Framebuffer * defaultFBO);
+
     /**
     *  @brief
     *    Get the vector of all registered color render target inputs
@@ -485,8 +511,14 @@ public:
 
 
 protected:
+    Stage                                           * m_stage;                           ///< Stage the interface belongs to
     std::unique_ptr<globjects::Framebuffer>           m_defaultFBO;                      ///< Default FBO for configuration
-    std::unique_ptr<globjects::Framebuffer>           m_fbo;                             ///< Intermediate FBO for configuration
+    mutable globjects::Framebuffer                  * m_fbo;                             ///< Cached FBO of the last call to obtainFBO() (can be null)
+    mutable unsigned int                              m_fboGeneration;                   ///< Generation of the framebuffer cache when m_fbo was obtained
+    mutable std::vector<FramebufferCache::Attachment> m_attachments;                     ///< Attachments of m_fbo
+    mutable std::vector<gl::GLenum>                   m_drawBuffers;                     ///< Draw buffers of m_fbo
+    mutable std::vector<FramebufferCache::Attachment> m_nextAttachments;                 ///< Attachments of the current call to obtainFBO()
+    mutable std::vector<gl::GLenum>                   m_nextDrawBuffers;                 ///< Draw buffers of the current call to obtainFBO()
     std::vector<Input <ColorRenderTarget        *> *> m_colorRenderTargetInputs;         ///< List of input color render targets
     std::vector<Input <DepthRenderTarget        *> *> m_depthRenderTargetInputs;         ///< List of input depth render targets
     std::vector<Input <DepthStencilRenderTarget *> *> m_depthStencilRenderTargetInputs;  ///< List of input depth-stencil render targets
@@ -2,6 +2,8 @@
 #pragma once
 
 
+#include <vector>
+
 #include <cppexpose/plugin/plugin_api.h>
 
 #include <gloperate/gloperate-version.h>
@@ -26,6 +28,11 @@ struct Light;
 /**
 *  @brief
 *    Stage that takes Light objects as inputs and creates texture buffers containing information of all lights
+*
+*    Buffers and textures are created once per context. On each process,
+*    only lights that differ from the previously uploaded ones are written,
+*    merged into contiguous ranges. The buffers are reallocated only if
+*    the number of valid lights changes.
 */
 class GLOPERATE_API LightBufferTextureStage : public Stage
 {
@@ -85,6 +92,19 @@ protected:
     // Helper functions
     void setupBufferTextures();
 
+    /**
+    *  @brief
+    *    Upload a range of lights to the buffers
+    *
+    *  @param[in] lights
+    *    Lights
+    *  @param[in] first
+    *    Index of the first light to be uploaded
+    *  @param[in] count
+    *    Number of lights to be uploaded
+    */
+    void uploadLights(const std::vector<Light> & lights, size_t first, size_t count);
+
 
 protected:
     std::unique_ptr<globjects::Texture> m_colorTypeTexture;   ///< Buffer texture for color & type information
@@ -95,6 +115,7 @@ protected:
     std::unique_ptr<globjects::Buffer>  m_attenuationBuffer;  ///< Buffer for attenuation information
 
     std::vector< Input<Light> * > m_lightInputs; ///< Light inputs
+    std::vector<Light>            m_lights;      ///< Lights currently stored in the buffers
 };
 
 
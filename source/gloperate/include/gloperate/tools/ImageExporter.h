@@ -3,6 +3,10 @@
 
 
 #include <string>
+#include <vector>
+#include <fstream>
+
+#include <glm/mat4x4.hpp>
 
 #include <globjects/Texture.h>
 #include <globjects/Framebuffer.h>
@@ -24,6 +28,21 @@ class ResourceManager;
 /**
 *  @brief
 *    Tool to export images (screenshots) from a canvas
+*
+*    Images larger than the maximum tile size are rendered tile by tile.
+*    For each tile, the viewport of the canvas is set to the tile size
+*    and all inputs 'tileMatrix' (glm::mat4) of the render stage and its
+*    substages that are not connected are set to a matrix that maps the
+*    clip space of the image onto the current tile. Stages multiply it
+*    onto their projection matrix (tileMatrix * projection), which is done
+*    by RenderPassStage for all camera matrices. If no stage has such an
+*    input, only images that fit into a single tile can be exported.
+*
+*    Tiled images are written directly into the output file, so only one
+*    tile is kept in memory at a time. This is supported for binary
+*    PPM files ('.ppm', top-down) and raw RGB files ('.raw', bottom-up,
+*    as expected by OpenGL). Other file formats are passed on to the
+*    resource manager and therefore limited to a single tile.
 */
 class GLOPERATE_API ImageExporter
 {
@@ -78,6 +97,111 @@ public:
     */
     void save(ContextHandling contextHandling = ActivateContext);
 
+    /**
+    *  @brief
+    *    Get maximum tile size
+    *
+    *  @return
+    *    Maximum width and height (in pixels) of a tile
+    */
+    int maxTileSize() const;
+
+    /**
+    *  @brief
+    *    Set maximum tile size
+    *
+    *  @param[in] maxTileSize
+    *    Maximum width and height (in pixels) of a tile
+    *
+    *  @remarks
+    *    The tile size is additionally limited by the OpenGL implementation
+    *    (GL_MAX_VIEWPORT_DIMS, GL_MAX_TEXTURE_SIZE, GL_MAX_RENDERBUFFER_SIZE).
+    */
+    void setMaxTileSize(int maxTileSize);
+
+
+protected:
+    /**
+    *  @brief
+    *    Determine maximum tile size supported by the current context
+    *
+    *  @return
+    *    Maximum tile size (in pixels)
+    */
+    int supportedTileSize() const;
+
+    /**
+    *  @brief
+    *    Compute the matrix that maps the clip space of the image onto a tile
+    *
+    *  @param[in] width
+    *    Image width (in pixels)
+    *  @param[in] height
+    *    Image height (in pixels)
+    *  @param[in] x
+    *    Horizontal position (in pixels, from left) of the tile in the image
+    *  @param[in] y
+    *    Vertical position (in pixels, from bottom) of the tile in the image
+    *
+    *  @return
+    *    Tile matrix
+    *
+    *  @remarks
+    *    The projection is assumed to be computed for the viewport of a tile,
+    *    scaling horizontally by the inverse of its aspect ratio.
+    */
+    glm::mat4 computeTileMatrix(int width, int height, int x, int y) const;
+
+    /**
+    *  @brief
+    *    Create output textures and FBO for the given tile size
+    *
+    *  @param[in] width
+    *    Tile width (in pixels)
+    *  @param[in] height
+    *    Tile height (in pixels)
+    */
+    void createFramebuffer(int width, int height);
+
+    /**
+    *  @brief
+    *    Render the current tile into the output FBO
+    */
+    void renderTile();
+
+    /**
+    *  @brief
+    *    Open output file and write file header
+    *
+    *  @param[out] file
+    *    Output file stream
+    *  @param[in] width
+    *    Width (in pixels) of output image
+    *  @param[in] height
+    *    Height (in pixels) of output image
+    *
+    *  @return
+    *    'true' if the file could be opened, else 'false'
+    */
+    bool openFile(std::ofstream & file, int width, int height);
+
+    /**
+    *  @brief
+    *    Write the current tile into the output file
+    *
+    *  @param[in] file
+    *    Output file stream
+    *  @param[in] width
+    *    Width (in pixels) of output image
+    *  @param[in] height
+    *    Height (in pixels) of output image
+    *  @param[in] x
+    *    Horizontal position (in pixels, from left) of the tile in the image
+    *  @param[in] y
+    *    Vertical position (in pixels, from bottom) of the tile in the image
+    */
+    void writeTile(std::ofstream & file, int width, int height, int x, int y);
+
 
 protected:
     // Configuration
@@ -86,6 +210,14 @@ protected:
     int           m_width;
     int           m_height;
     int           m_renderIterations;
+    int           m_maxTileSize;
+
+    // Tile data
+    int                        m_tileWidth;   ///< Width of a tile (in pixels)
+    int                        m_tileHeight;  ///< Height of a tile (in pixels)
+    bool                       m_topDown;     ///< 'true' if rows are stored top-down in the output file, else 'false'
+    std::streamoff             m_dataOffset;  ///< Offset of the image data in the output file
+    std::vector<unsigned char> m_tileData;    ///< Pixel data of the current tile
 
     // OpenGl objects
     std::unique_ptr<globjects::Framebuffer>  m_fbo;
@@ -9,6 +9,7 @@
 #include <cppassist/memory/make_unique.h>
 
 #include <gloperate/base/ChronoTimer.h>
+#include <gloperate/base/logging.h>
 
 
 namespace 
@@ -53,7 +54,7 @@ AutoTimer::~AutoTimer()
     // shorten the time to nearest time unit
     double deltaf = static_cast<double>(delta.count()) / pow(1000.0, unitPrecision);
 
-    cppassist::debug("gloperate") << m_info << " took "
+    GLOPERATE_DEBUG(0) << m_info << " took "
         << std::setprecision(4) << deltaf << unit
         << " (timer_" << std::setfill('0') << std::setw(2) << m_index << ").";
 
@@ -2,6 +2,7 @@
 #include <gloperate/base/Canvas.h>
 
 #include <functional>
+#include <cassert>
 #include <algorithm>
 
 #include <glm/glm.hpp>
@@ -18,10 +19,12 @@
 
 #include <gloperate/base/Environment.h>
 #include <gloperate/base/ComponentManager.h>
+#include <gloperate/base/logging.h>
 #include <gloperate/pipeline/Pipeline.h>
 #include <gloperate/pipeline/Slot.h>
 #include <gloperate/input/MouseDevice.h>
 #include <gloperate/input/KeyboardDevice.h>
+#include <gloperate/input/InputManager.h>
 #include <gloperate/rendering/ColorRenderTarget.h>
 #include <gloperate/rendering/DepthRenderTarget.h>
 #include <gloperate/rendering/DepthStencilRenderTarget.h>
@@ -50,15 +53,20 @@ Canvas::Canvas(Environment * environment)
 , m_openGLContext(nullptr)
 , m_initialized(false)
 , m_timeDelta(0.0f)
+, m_completedLoads(0)
 , m_blitStage(cppassist::make_unique<BlitStage>(environment, "FinalBlit"))
 , m_mouseDevice(cppassist::make_unique<MouseDevice>(m_environment->inputManager(), "mouse"))
 , m_keyboardDevice(cppassist::make_unique<KeyboardDevice>(m_environment->inputManager(), "keyboard"))
 , m_replaceStage(false)
+, m_transactionDepth(0)
 , m_rendered(false)
+, m_hasInputTime(false)
+, m_inputLatency(0.0f)
 , m_colorTarget(cppassist::make_unique<ColorRenderTarget>())
 , m_depthTarget(cppassist::make_unique<DepthRenderTarget>())
 , m_depthStencilTarget(cppassist::make_unique<DepthStencilRenderTarget>())
 , m_stencilTarget(cppassist::make_unique<StencilRenderTarget>())
+, m_slotBindings()
 {
     // Register functions
     addFunction("onStageInputChanged", this, &Canvas::scr_onStageInputChanged);
@@ -74,6 +82,7 @@ Canvas::Canvas(Environment * environment)
     addFunction("getSlot",             this, &Canvas::scr_getSlot);
     addFunction("getValue",            this, &Canvas::scr_getValue);
     addFunction("setValue",            this, &Canvas::scr_setValue);
+    addFunction("setValues",           this, &Canvas::scr_setValues);
 
     // Register canvas
     m_environment->registerCanvas(this);
@@ -107,15 +116,40 @@ Stage * Canvas::renderStage()
 
 void Canvas::setRenderStage(std::unique_ptr<Stage> && stage)
 {
+    // Commit open transactions on the old stage
+    if (m_renderStage && m_renderStage->isPipeline())
+    {
+        for (unsigned int i = 0; i < m_transactionDepth; i++)
+        {
+            static_cast<Pipeline *>(m_renderStage.get())->commitTransaction();
+        }
+    }
+
     // Save old stage
     m_oldStage = std::move(m_renderStage);
 
     // Set stage
     m_renderStage = std::move(stage);
 
+    // Continue open transactions on the new stage
+    if (m_renderStage->isPipeline())
+    {
+        for (unsigned int i = 0; i < m_transactionDepth; i++)
+        {
+            static_cast<Pipeline *>(m_renderStage.get())->beginTransaction();
+        }
+    }
+
     // Connect to changes on the stage's input slots
     m_inputChangedConnection = m_renderStage->inputChanged.connect(this, &Canvas::stageInputChanged);
 
+    // Look up slots again only when slots are added or removed
+    invalidateSlotBindings();
+    m_slotBindings.inputAdded    = m_renderStage->inputAdded.connect([this] (AbstractSlot *) { invalidateSlotBindings(); });
+    m_slotBindings.inputRemoved  = m_renderStage->inputRemoved.connect([this] (AbstractSlot *) { invalidateSlotBindings(); });
+    m_slotBindings.outputAdded   = m_renderStage->outputAdded.connect([this] (AbstractSlot *) { invalidateSlotBindings(); });
+    m_slotBindings.outputRemoved = m_renderStage->outputRemoved.connect([this] (AbstractSlot *) { invalidateSlotBindings(); });
+
     // Issue a redraw
     m_replaceStage = true;
     redraw();
@@ -132,6 +166,37 @@ void Canvas::loadRenderStage(const std::string & name)
     }
 }
 
+void Canvas::beginTransaction()
+{
+    std::lock_guard<std::recursive_mutex> lock(this->m_mutex);
+
+    m_transactionDepth++;
+
+    if (m_renderStage && m_renderStage->isPipeline())
+    {
+        static_cast<Pipeline *>(m_renderStage.get())->beginTransaction();
+    }
+}
+
+void Canvas::commitTransaction()
+{
+    std::lock_guard<std::recursive_mutex> lock(this->m_mutex);
+
+    assert(m_transactionDepth > 0);
+
+    if (m_transactionDepth == 0)
+    {
+        return;
+    }
+
+    m_transactionDepth--;
+
+    if (m_renderStage && m_renderStage->isPipeline())
+    {
+        static_cast<Pipeline *>(m_renderStage.get())->commitTransaction();
+    }
+}
+
 const AbstractGLContext * Canvas::openGLContext() const
 {
     return m_openGLContext;
@@ -149,7 +214,7 @@ void Canvas::setOpenGLContext(AbstractGLContext * context)
     // Deinitialize renderer in old context
     if (m_openGLContext)
     {
-        cppassist::debug(2, "gloperate") << "deinitContext()";
+        GLOPERATE_DEBUG(2) << "deinitContext()";
 
         if (m_renderStage)
         {
@@ -158,13 +223,17 @@ void Canvas::setOpenGLContext(AbstractGLContext * context)
 
         m_blitStage->deinitContext(m_openGLContext);
 
+        // Release shared framebuffers and render targets of the old context
+        m_environment->framebufferCache()->clear();
+        m_environment->renderTargetPool()->clear();
+
         m_openGLContext = nullptr;
     }
 
     // Initialize renderer in new context
     if (context)
     {
-        cppassist::debug(2, "gloperate") << "initContext()";
+        GLOPERATE_DEBUG(2) << "initContext()";
 
         m_openGLContext = context;
 
@@ -186,6 +255,12 @@ void Canvas::updateTime()
 {
     std::lock_guard<std::recursive_mutex> lock(this->m_mutex);
 
+    // Dispatch input events that have been queued while rendering
+    dispatchInputEvents();
+
+    // Invoke scripting callbacks for input events
+    m_environment->inputManager()->update();
+
     // In multithreaded viewers, updateTime() might get called several times
     // before render(). Therefore, the time delta is accumulated until the
     // pipeline is actually rendered, and then reset by the method render().
@@ -204,12 +279,20 @@ void Canvas::updateTime()
     }
 
     // Update timing
-    auto slotTimeDelta = m_renderStage->findInput<float>([](Input<float>* input) { return input->name() == "timeDelta"; });
+    auto slotTimeDelta = slotBindings().timeDelta;
     if (slotTimeDelta)
     {
         slotTimeDelta->setValue(m_timeDelta);
     }
 
+    // Redraw when asynchronously loaded resources have become ready
+    const auto completedLoads = m_environment->resourceManager()->completedLoads();
+    if (completedLoads != m_completedLoads)
+    {
+        m_completedLoads = completedLoads;
+        this->redraw();
+    }
+
     // Check if a redraw is required
     checkRedraw();
 
@@ -231,7 +314,7 @@ void Canvas::setViewport(const glm::vec4 & deviceViewport)
     }
 
     // Promote new viewport
-    auto slotViewport = m_renderStage->findInput<glm::vec4>([](Input<glm::vec4>* input) { return input->name() == "viewport"; });
+    auto slotViewport = slotBindings().viewport;
     if (slotViewport) slotViewport->setValue(m_viewport);
 
     // Check if a redraw is required
@@ -250,8 +333,10 @@ void Canvas::render(globjects::Framebuffer * targetFBO)
     // Reset time delta
     m_timeDelta = 0.0f;
 
-    auto fboName = targetFBO->hasName() ? targetFBO->name() : std::to_string(targetFBO->id());
-    cppassist::debug(2, "gloperate") << "render(); " << "targetFBO: " << fboName;
+    GLOPERATE_DEBUG(2) << "render(); " << "targetFBO: " << (targetFBO->hasName() ? targetFBO->name() : std::to_string(targetFBO->id()));
+
+    // Dispatch pending input events before the frame is rendered
+    dispatchInputEvents();
 
     // Abort if not initialized
     if (!m_initialized || !m_renderStage)
@@ -268,6 +353,9 @@ void Canvas::render(globjects::Framebuffer * targetFBO)
             // Deinitialize old stage
             m_oldStage->deinitContext(m_openGLContext);
 
+            // Release shared framebuffers that may refer to render targets of the old stage
+            m_environment->framebufferCache()->clear();
+
             // Destroy old stage
             m_oldStage = nullptr;
         }
@@ -276,13 +364,14 @@ void Canvas::render(globjects::Framebuffer * targetFBO)
         m_renderStage->initContext(m_openGLContext);
 
         // Promote viewport information
-        auto slotViewport = m_renderStage->findInput<glm::vec4>([](Input<glm::vec4>* input) { return input->name() == "viewport"; });
+        auto slotViewport = slotBindings().viewport;
         if (slotViewport) slotViewport->setValue(m_viewport);
 
         // Mark output as required
-        m_renderStage->forAllOutputs<ColorRenderTarget *>([](Output<ColorRenderTarget *> * output) {
+        for (auto output : slotBindings().colorTargetOutputs)
+        {
             output->setRequired(true);
-        });
+        }
 
         // Replace finished
         m_replaceStage = false;
@@ -343,33 +432,41 @@ void Canvas::render(globjects::Framebuffer * targetFBO)
     }
 
     // Update render stage input render targets
-    m_renderStage->forAllInputs<gloperate::ColorRenderTarget *>([this](Input<ColorRenderTarget *> * input) {
+    const auto & bindings = slotBindings();
+
+    for (auto input : bindings.colorTargetInputs)
+    {
         input->setValue(m_colorTarget.get());
-    });
-    m_renderStage->forAllInputs<gloperate::DepthRenderTarget *>([this](Input<DepthRenderTarget *> * input) {
+    }
+    for (auto input : bindings.depthTargetInputs)
+    {
         input->setValue(m_depthTarget.get());
-    });
-    m_renderStage->forAllInputs<gloperate::DepthStencilRenderTarget *>([this](Input<DepthStencilRenderTarget *> * input) {
+    }
+    for (auto input : bindings.depthStencilTargetInputs)
+    {
         input->setValue(m_depthStencilTarget.get());
-    });
-    m_renderStage->forAllInputs<gloperate::StencilRenderTarget *>([this](Input<StencilRenderTarget *> * input) {
+    }
+    for (auto input : bindings.stencilTargetInputs)
+    {
         input->setValue(m_stencilTarget.get());
-    });
+    }
 
     // Render
     m_renderStage->process();
 
-    auto colorOutput = m_renderStage->findOutput<gloperate::ColorRenderTarget *>([this](Output<ColorRenderTarget *> * output) {
+    // Bindings may have changed during processing
+    const auto & outputBindings = slotBindings();
+
+    const auto colorOutputIt = std::find_if(outputBindings.colorTargetOutputs.begin(), outputBindings.colorTargetOutputs.end(), [](Output<ColorRenderTarget *> * output) {
         return **output != nullptr;
     });
+    const auto colorOutput = colorOutputIt != outputBindings.colorTargetOutputs.end() ? *colorOutputIt : nullptr;
 
     // Check if a blit pass is necessary
     if (colorOutput)
     {
         // Get viewport
-        const auto viewport = m_renderStage->findOutput<glm::vec4>([this](Output<glm::vec4> *) {
-            return true;
-        });
+        const auto viewport = outputBindings.viewportOutput;
 
         // Check if either viewport or color output target are different than the input
         const auto viewportDiffering = viewport && glm::distance(**viewport, m_viewport) > glm::epsilon<float>();
@@ -386,86 +483,178 @@ void Canvas::render(globjects::Framebuffer * targetFBO)
         }
     }
 
+    // Measure time from the oldest input event to the end of this frame
+    updateInputLatency();
+
     // Signal that a frame has been rendered
     m_rendered = true;
 }
 
 void Canvas::promoteKeyPress(int key, int modifier)
 {
-    std::lock_guard<std::recursive_mutex> lock(this->m_mutex);
-
-    cppassist::debug(2, "gloperate") << "keyPressed(" << key << ", " << modifier << ")";
+    GLOPERATE_DEBUG(2) << "keyPressed(" << key << ", " << modifier << ")";
 
     // Promote keyboard event
-    m_keyboardDevice->keyPress(key, modifier);
-
-    // Check if a redraw is required
-    checkRedraw();
+    queueInputEvent({ QueuedInput::Type::KeyPress, key, modifier, glm::ivec2(0), glm::vec2(0.0f), std::chrono::steady_clock::now() });
 }
 
 void Canvas::promoteKeyRelease(int key, int modifier)
 {
-    std::lock_guard<std::recursive_mutex> lock(this->m_mutex);
-
-    cppassist::debug(2, "gloperate") << "keyReleased(" << key << ", " << modifier << ")";
+    GLOPERATE_DEBUG(2) << "keyReleased(" << key << ", " << modifier << ")";
 
     // Promote keyboard event
-    m_keyboardDevice->keyRelease(key, modifier);
-
-    // Check if a redraw is required
-    checkRedraw();
+    queueInputEvent({ QueuedInput::Type::KeyRelease, key, modifier, glm::ivec2(0), glm::vec2(0.0f), std::chrono::steady_clock::now() });
 }
 
 void Canvas::promoteMouseMove(const glm::ivec2 & pos, int modifier)
 {
-    std::lock_guard<std::recursive_mutex> lock(this->m_mutex);
-
-    cppassist::debug(2, "gloperate") << "mouseMoved(" << pos.x << ", " << pos.y << ")";
+    GLOPERATE_DEBUG(2) << "mouseMoved(" << pos.x << ", " << pos.y << ")";
 
     // Promote mouse event
-    m_mouseDevice->move(pos, modifier);
-
-    // Check if a redraw is required
-    checkRedraw();
+    queueInputEvent({ QueuedInput::Type::MouseMove, 0, modifier, pos, glm::vec2(0.0f), std::chrono::steady_clock::now() });
 }
 
 void Canvas::promoteMousePress(int button, const glm::ivec2 & pos, int modifier)
 {
-    std::lock_guard<std::recursive_mutex> lock(this->m_mutex);
-
-    cppassist::debug(2, "gloperate") << "mousePressed(" << button << ", " << pos.x << ", " << pos.y << ")";
+    GLOPERATE_DEBUG(2) << "mousePressed(" << button << ", " << pos.x << ", " << pos.y << ")";
 
     // Promote mouse event
-    m_mouseDevice->buttonPress(button, pos, modifier);
-
-    // Check if a redraw is required
-    checkRedraw();
+    queueInputEvent({ QueuedInput::Type::MousePress, button, modifier, pos, glm::vec2(0.0f), std::chrono::steady_clock::now() });
 }
 
 void Canvas::promoteMouseRelease(int button, const glm::ivec2 & pos, int modifier)
 {
-    std::lock_guard<std::recursive_mutex> lock(this->m_mutex);
+    GLOPERATE_DEBUG(2) << "mouseReleased(" << button << ", " << pos.x << ", " << pos.y << ")";
+
+    // Promote mouse event
+    queueInputEvent({ QueuedInput::Type::MouseRelease, button, modifier, pos, glm::vec2(0.0f), std::chrono::steady_clock::now() });
+}
 
-    cppassist::debug(2, "gloperate") << "mouseReleased(" << button << ", " << pos.x << ", " << pos.y << ")";
+void Canvas::promoteMouseWheel(const glm::vec2 & delta, const glm::ivec2 & pos, int modifier)
+{
+    GLOPERATE_DEBUG(2) << "mouseWheel(" << delta.x << ", " << delta.y << ", " << pos.x << ", " << pos.y << ")";
 
     // Promote mouse event
-    m_mouseDevice->buttonRelease(button, pos, modifier);
+    queueInputEvent({ QueuedInput::Type::MouseWheel, 0, modifier, pos, delta, std::chrono::steady_clock::now() });
+}
 
-    // Check if a redraw is required
-    checkRedraw();
+float Canvas::inputLatency() const
+{
+    return m_inputLatency;
 }
 
-void Canvas::promoteMouseWheel(const glm::vec2 & delta, const glm::ivec2 & pos, int modifier)
+void Canvas::queueInputEvent(const QueuedInput & event)
 {
-    std::lock_guard<std::recursive_mutex> lock(this->m_mutex);
+    bool dispatched = false;
 
-    cppassist::debug(2, "gloperate") << "mouseWheel(" << delta.x << ", " << delta.y << ", " << pos.x << ", " << pos.y << ")";
+    // If the queue is full, wait for the render thread and dispatch synchronously
+    while (!m_inputQueue.push(event))
+    {
+        std::lock_guard<std::recursive_mutex> lock(this->m_mutex);
+        dispatched = dispatchInputEvents() || dispatched;
+    }
 
-    // Promote mouse event
-    m_mouseDevice->wheelScroll(delta, pos, modifier);
+    // Dispatch immediately, unless a frame is currently being rendered.
+    // In that case, the events are dispatched by render() or updateTime().
+    std::unique_lock<std::recursive_mutex> lock(this->m_mutex, std::try_to_lock);
+
+    if (!lock.owns_lock())
+    {
+        return;
+    }
+
+    dispatched = dispatchInputEvents() || dispatched;
 
     // Check if a redraw is required
-    checkRedraw();
+    if (dispatched)
+    {
+        checkRedraw();
+    }
+}
+
+bool Canvas::dispatchInputEvents()
+{
+    // Take the event list, as dispatching may re-enter this function
+    std::vector<QueuedInput> events;
+    events.swap(m_inputEvents);
+
+    QueuedInput event;
+    while (m_inputQueue.pop(event))
+    {
+        events.push_back(event);
+    }
+
+    if (events.empty())
+    {
+        m_inputEvents.swap(events);
+        return false;
+    }
+
+    // Remember the oldest event for measuring the input latency
+    if (!m_hasInputTime)
+    {
+        m_inputTime    = events.front().time;
+        m_hasInputTime = true;
+    }
+
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        const QueuedInput & current = events[i];
+
+        switch (current.type)
+        {
+        case QueuedInput::Type::KeyPress:
+            m_keyboardDevice->keyPress(current.code, current.modifier);
+            break;
+
+        case QueuedInput::Type::KeyRelease:
+            m_keyboardDevice->keyRelease(current.code, current.modifier);
+            break;
+
+        case QueuedInput::Type::MouseMove:
+            // Coalesce consecutive mouse moves
+            if (i + 1 < events.size() && events[i + 1].type == QueuedInput::Type::MouseMove)
+            {
+                break;
+            }
+
+            m_mouseDevice->move(current.pos, current.modifier);
+            break;
+
+        case QueuedInput::Type::MousePress:
+            m_mouseDevice->buttonPress(current.code, current.pos, current.modifier);
+            break;
+
+        case QueuedInput::Type::MouseRelease:
+            m_mouseDevice->buttonRelease(current.code, current.pos, current.modifier);
+            break;
+
+        case QueuedInput::Type::MouseWheel:
+            m_mouseDevice->wheelScroll(current.delta, current.pos, current.modifier);
+            break;
+        }
+    }
+
+    // Keep the allocated memory for the next call
+    events.clear();
+    m_inputEvents.swap(events);
+
+    return true;
+}
+
+void Canvas::updateInputLatency()
+{
+    if (m_hasInputTime)
+    {
+        m_inputLatency = std::chrono::duration_cast<std::chrono::duration<float>>(std::chrono::steady_clock::now() - m_inputTime).count();
+        m_hasInputTime = false;
+
+        GLOPERATE_DEBUG(2) << "input latency: " << m_inputLatency * 1000.0f << " ms";
+    }
+    else
+    {
+        m_inputLatency = 0.0f;
+    }
 }
 
 void Canvas::checkRedraw()
@@ -493,12 +682,13 @@ void Canvas::checkRedraw()
     }
 
     bool redraw = false;
-    m_renderStage->forAllOutputs<ColorRenderTarget *>([& redraw](Output<ColorRenderTarget *> * output) {
+    for (auto output : slotBindings().colorTargetOutputs)
+    {
         if (**output && !output->isValid())
         {
             redraw = true;
         }
-    });
+    }
 
     if (redraw)
     {
@@ -506,6 +696,64 @@ void Canvas::checkRedraw()
     }
 }
 
+const Canvas::SlotBindings & Canvas::slotBindings()
+{
+    std::lock_guard<std::recursive_mutex> lock(this->m_mutex);
+
+    assert(m_renderStage);
+
+    if (m_slotBindings.valid)
+    {
+        return m_slotBindings;
+    }
+
+    // Find named inputs
+    m_slotBindings.viewport  = m_renderStage->findInput<glm::vec4>([](Input<glm::vec4>* input) { return input->name() == "viewport"; });
+    m_slotBindings.timeDelta = m_renderStage->findInput<float>([](Input<float>* input) { return input->name() == "timeDelta"; });
+
+    // Find viewport output
+    m_slotBindings.viewportOutput = m_renderStage->findOutput<glm::vec4>([](Output<glm::vec4> *) {
+        return true;
+    });
+
+    // Find render target inputs
+    m_slotBindings.colorTargetInputs.clear();
+    m_slotBindings.depthTargetInputs.clear();
+    m_slotBindings.depthStencilTargetInputs.clear();
+    m_slotBindings.stencilTargetInputs.clear();
+
+    m_renderStage->forAllInputs<ColorRenderTarget *>([this](Input<ColorRenderTarget *> * input) {
+        m_slotBindings.colorTargetInputs.push_back(input);
+    });
+    m_renderStage->forAllInputs<DepthRenderTarget *>([this](Input<DepthRenderTarget *> * input) {
+        m_slotBindings.depthTargetInputs.push_back(input);
+    });
+    m_renderStage->forAllInputs<DepthStencilRenderTarget *>([this](Input<DepthStencilRenderTarget *> * input) {
+        m_slotBindings.depthStencilTargetInputs.push_back(input);
+    });
+    m_renderStage->forAllInputs<StencilRenderTarget *>([this](Input<StencilRenderTarget *> * input) {
+        m_slotBindings.stencilTargetInputs.push_back(input);
+    });
+
+    // Find render target outputs
+    m_slotBindings.colorTargetOutputs.clear();
+
+    m_renderStage->forAllOutputs<ColorRenderTarget *>([this](Output<ColorRenderTarget *> * output) {
+        m_slotBindings.colorTargetOutputs.push_back(output);
+    });
+
+    m_slotBindings.valid = true;
+
+    return m_slotBindings;
+}
+
+void Canvas::invalidateSlotBindings()
+{
+    std::lock_guard<std::recursive_mutex> lock(this->m_mutex);
+
+    m_slotBindings.valid = false;
+}
+
 void Canvas::promoteChangedInputs()
 {
     std::lock_guard<std::mutex> lock(this->m_changedInputMutex);
@@ -538,7 +786,10 @@ void Canvas::stageInputChanged(AbstractSlot * slot)
     std::lock_guard<std::mutex> lock(this->m_changedInputMutex);
 
     // Put changed input into list, will be processed on next update
-    m_changedInputs.push_back(slot);
+    if (std::find(m_changedInputs.begin(), m_changedInputs.end(), slot) == m_changedInputs.end())
+    {
+        m_changedInputs.push_back(slot);
+    }
 }
 
 void Canvas::scr_onStageInputChanged(const cppexpose::Variant & func)
@@ -842,6 +1093,38 @@ void Canvas::scr_setValue(const std::string & path, const std::string & slotName
     }
 }
 
+void Canvas::scr_setValues(const std::string & path, const cppexpose::Variant & values)
+{
+    std::lock_guard<std::recursive_mutex> lock(this->m_mutex);
+
+    // Check if a map of slot names and values has been passed
+    const cppexpose::VariantMap * map = values.asMap();
+    if (!map)
+    {
+        return;
+    }
+
+    Stage * stage = getStageObject(path);
+    if (!stage)
+    {
+        return;
+    }
+
+    // Apply all values first, then notify stages once
+    beginTransaction();
+
+    for (const auto & value : *map)
+    {
+        AbstractSlot * slot = stage->getSlot(value.first);
+        if (slot)
+        {
+            slot->fromVariant(value.second);
+        }
+    }
+
+    commitTransaction();
+}
+
 Stage * Canvas::getStageObject(const std::string & path) const
 {
     // Begin with empty stage
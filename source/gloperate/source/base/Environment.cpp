@@ -17,11 +17,15 @@ namespace gloperate
 
 Environment::Environment()
 : cppexpose::Object("gloperate")
+, m_nextWakeupId(1)
 , m_componentManager()
 , m_resourceManager(this)
 , m_system(this)
 , m_inputManager(this)
 , m_timerManager(this)
+, m_threadPool()
+, m_framebufferCache()
+, m_renderTargetPool(&m_framebufferCache)
 , m_scriptContext(nullptr)
 , m_safeMode(false)
 {
@@ -76,6 +80,36 @@ TimerManager * Environment::timerManager()
     return &m_timerManager;
 }
 
+const ThreadPool * Environment::threadPool() const
+{
+    return &m_threadPool;
+}
+
+ThreadPool * Environment::threadPool()
+{
+    return &m_threadPool;
+}
+
+const FramebufferCache * Environment::framebufferCache() const
+{
+    return &m_framebufferCache;
+}
+
+FramebufferCache * Environment::framebufferCache()
+{
+    return &m_framebufferCache;
+}
+
+const RenderTargetPool * Environment::renderTargetPool() const
+{
+    return &m_renderTargetPool;
+}
+
+RenderTargetPool * Environment::renderTargetPool()
+{
+    return &m_renderTargetPool;
+}
+
 const std::vector<Canvas *> & Environment::canvases() const
 {
     return m_canvases;
@@ -137,6 +171,33 @@ void Environment::exit(int exitCode)
     this->exitApplication(exitCode);
 }
 
+void Environment::wakeup()
+{
+    std::lock_guard<std::mutex> lock(m_wakeupMutex);
+
+    for (const auto & handler : m_wakeupHandlers)
+    {
+        handler.second();
+    }
+}
+
+int Environment::addWakeupHandler(const std::function<void()> & handler)
+{
+    std::lock_guard<std::mutex> lock(m_wakeupMutex);
+
+    const int id = m_nextWakeupId++;
+    m_wakeupHandlers[id] = handler;
+
+    return id;
+}
+
+void Environment::removeWakeupHandler(int id)
+{
+    std::lock_guard<std::mutex> lock(m_wakeupMutex);
+
+    m_wakeupHandlers.erase(id);
+}
+
 bool Environment::safeMode() const
 {
     return m_safeMode;
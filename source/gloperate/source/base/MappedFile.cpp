@@ -0,0 +1,161 @@
+
+#include <gloperate/base/MappedFile.h>
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+
+namespace gloperate
+{
+
+
+MappedFile::MappedFile()
+: m_data(nullptr)
+, m_size(0)
+, m_mapping(nullptr)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string & filename)
+{
+    close();
+
+#ifdef WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    // The mapping object keeps the file open
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+
+    if (!mapping)
+    {
+        return false;
+    }
+
+    const void * data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    m_data    = static_cast<const char *>(data);
+    m_size    = static_cast<size_t>(fileSize.QuadPart);
+    m_mapping = mapping;
+#else
+    const int file = ::open(filename.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStatus;
+    if (fstat(file, &fileStatus) != 0 || fileStatus.st_size <= 0)
+    {
+        ::close(file);
+        return false;
+    }
+
+    // The mapping stays valid after closing the file descriptor
+    void * data = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    // Content is usually read once from front to back
+    madvise(data, static_cast<size_t>(fileStatus.st_size), MADV_SEQUENTIAL);
+
+    m_data = static_cast<const char *>(data);
+    m_size = static_cast<size_t>(fileStatus.st_size);
+#endif
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (!m_data)
+    {
+        return;
+    }
+
+#ifdef WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(static_cast<HANDLE>(m_mapping));
+#else
+    munmap(const_cast<char *>(m_data), m_size);
+#endif
+
+    m_data    = nullptr;
+    m_size    = 0;
+    m_mapping = nullptr;
+}
+
+bool MappedFile::isValid() const
+{
+    return m_data != nullptr;
+}
+
+const char * MappedFile::data() const
+{
+    return m_data;
+}
+
+size_t MappedFile::size() const
+{
+    return m_size;
+}
+
+void MappedFile::prefetch() const
+{
+    if (!m_data)
+    {
+        return;
+    }
+
+#ifdef WIN32
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    const auto pageSize = static_cast<size_t>(systemInfo.dwPageSize);
+#else
+    const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    // Let the kernel start reading ahead of the touch pass
+    madvise(const_cast<char *>(m_data), m_size, MADV_WILLNEED);
+#endif
+
+    // Read one byte per page to fault all pages in
+    volatile char sum = 0;
+    for (size_t pos = 0; pos < m_size; pos += pageSize)
+    {
+        sum = sum + m_data[pos];
+    }
+}
+
+
+} // namespace gloperate
@@ -1,27 +1,79 @@
 
 #include <gloperate/base/ResourceManager.h>
 
+#include <cassert>
 #include <algorithm>
+#include <tuple>
+
+#include <cppassist/memory/make_unique.h>
+
+#include <cppfs/fs.h>
+#include <cppfs/FileHandle.h>
+#include <cppfs/FilePath.h>
 
 #include <cppexpose/plugin/ComponentManager.h>
+#include <cppexpose/json/JSON.h>
 
 #include <gloperate/base/Environment.h>
+#include <gloperate/base/ThreadPool.h>
 #include <gloperate/base/Loader.h>
 #include <gloperate/base/Storer.h>
 
 
+namespace
+{
+    // Loads mostly wait for files, so a few threads keep enough of them in flight
+    const unsigned int s_numLoadThreads = 2;
+}
+
+
 namespace gloperate
 {
 
 
+bool ResourceManager::CacheKey::operator<(const CacheKey & other) const
+{
+    return std::tie(type, context, path, options, modificationTime) < std::tie(other.type, other.context, other.path, other.options, other.modificationTime);
+}
+
+std::string ResourceManager::extension(const std::string & filename)
+{
+    std::string ext = cppfs::FilePath(filename).extension();
+    auto pos = ext.find_last_of('.');
+    if (pos != std::string::npos)
+    {
+        ext = ext.substr(pos + 1);
+    }
+
+    return ext;
+}
+
+ResourceManager::CacheKey ResourceManager::cacheKey(const std::type_index & type, const std::string & filename, const cppexpose::Variant & options)
+{
+    const auto file = cppfs::fs::open(filename);
+
+    return CacheKey{
+        type,
+        glbinding::getCurrentContext(),
+        cppfs::FilePath(filename).resolved(),
+        options.isNull() ? std::string() : cppexpose::JSON::stringify(options),
+        file.exists() ? file.modificationTime() : 0u
+    };
+}
+
 ResourceManager::ResourceManager(Environment * environment)
 : cppexpose::Object("resources")
 , m_environment(environment)
+, m_completedLoads(0)
+, m_loadThreads(cppassist::make_unique<ThreadPool>(s_numLoadThreads))
 {
 }
 
 ResourceManager::~ResourceManager()
 {
+    // Finish pending loads, as they use the loaders
+    m_loadThreads = nullptr;
+
     clearComponents();
 }
 
@@ -48,6 +100,105 @@ std::vector<AbstractStorer *> ResourceManager::storers() const
     return storers;
 }
 
+AbstractLoader * ResourceManager::findLoader(const std::type_index & type, const std::string & ext, const std::function<bool(AbstractLoader *)> & isLoader) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Lazy initialization of loaders (loaders must not be replaced while asynchronous loads are running)
+    if (m_loaders.size() == 0 && m_storers.size() == 0)
+    {
+        updateComponents();
+    }
+
+    // Look up loader only once for each type and extension
+    const auto key = std::make_pair(type, ext);
+
+    const auto it = m_loaderIndex.find(key);
+    if (it != m_loaderIndex.end())
+    {
+        return it->second;
+    }
+
+    AbstractLoader * result = nullptr;
+
+    for (const auto & loader : m_loaders)
+    {
+        if (isLoader(loader.get()) && loader->canLoad(ext))
+        {
+            result = loader.get();
+            break;
+        }
+    }
+
+    m_loaderIndex[key] = result;
+
+    return result;
+}
+
+std::shared_ptr<void> ResourceManager::cachedResource(const CacheKey & key) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const auto it = m_cache.find(key);
+    if (it == m_cache.end())
+    {
+        return nullptr;
+    }
+
+    return it->second.lock();
+}
+
+std::shared_ptr<void> ResourceManager::cacheResource(const CacheKey & key, const std::shared_ptr<void> & resource) const
+{
+    assert(resource);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Remove entries of deleted resources
+    for (auto it = m_cache.begin(); it != m_cache.end(); )
+    {
+        if (it->second.expired())
+        {
+            it = m_cache.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // Keep resource of another thread that has loaded the same file first
+    auto & entry = m_cache[key];
+    if (auto existing = entry.lock())
+    {
+        return existing;
+    }
+
+    entry = resource;
+
+    return resource;
+}
+
+unsigned int ResourceManager::completedLoads() const
+{
+    return m_completedLoads;
+}
+
+void ResourceManager::submitLoad(std::function<void()> task) const
+{
+    assert(task);
+
+    m_loadThreads->submit([this, task] ()
+    {
+        task();
+
+        m_completedLoads++;
+
+        // Let the event loop pick up the result
+        m_environment->wakeup();
+    });
+}
+
 void ResourceManager::updateComponents() const
 {
     // Release previous components
@@ -72,6 +223,7 @@ void ResourceManager::updateComponents() const
 
 void ResourceManager::clearComponents() const
 {
+    m_loaderIndex.clear();
     m_loaders.clear();
     m_storers.clear();
 }
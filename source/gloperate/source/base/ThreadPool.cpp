@@ -0,0 +1,120 @@
+
+#include <gloperate/base/ThreadPool.h>
+
+#include <cassert>
+
+
+namespace
+{
+    thread_local bool g_isWorkerThread = false;
+}
+
+
+namespace gloperate
+{
+
+
+bool ThreadPool::isWorkerThread()
+{
+    return g_isWorkerThread;
+}
+
+ThreadPool::ThreadPool(unsigned int numThreads)
+: m_numThreads(numThreads)
+, m_stopped(false)
+{
+    // Leave one hardware thread for the render thread
+    if (m_numThreads == 0)
+    {
+        const auto hardwareThreads = std::thread::hardware_concurrency();
+        m_numThreads = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopped = true;
+    }
+
+    m_condition.notify_all();
+
+    for (auto & thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+unsigned int ThreadPool::numThreads() const
+{
+    return m_numThreads;
+}
+
+void ThreadPool::submit(Task task)
+{
+    assert(task);
+
+    // Execute directly if there are no workers
+    if (m_numThreads == 0)
+    {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        startThreads();
+        m_tasks.push_back(std::move(task));
+    }
+
+    m_condition.notify_one();
+}
+
+void ThreadPool::startThreads()
+{
+    if (!m_threads.empty())
+    {
+        return;
+    }
+
+    m_threads.reserve(m_numThreads);
+    for (unsigned int i = 0; i < m_numThreads; ++i)
+    {
+        m_threads.emplace_back(&ThreadPool::run, this);
+    }
+}
+
+void ThreadPool::run()
+{
+    g_isWorkerThread = true;
+
+    while (true)
+    {
+        Task task;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_condition.wait(lock, [this] ()
+            {
+                return m_stopped || !m_tasks.empty();
+            });
+
+            // Finish pending tasks before shutting down
+            if (m_tasks.empty())
+            {
+                return;
+            }
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+
+} // namespace gloperate
@@ -1,26 +1,36 @@
-
 #include <gloperate/base/TimerManager.h>
 
 #include <algorithm>
+#include <functional>
 
 #include <cppassist/memory/make_unique.h>
 
+#include <gloperate/base/Environment.h>
+
 
-// [TODO] Implement garbage collection of stopped scripting timers.
-//
-// At the moment, scripting timers are only deleted on shutdown.
-// We can't delete timers directly when they are stopped, because the call to timer.stop()
-// may be a result of the callback function itself, which hasn't returned, yet.
-// To avoid deleting a function that is currently being called, we have to defer deletion.
+namespace
+{
+    // Outdated heap entries are purged when they outnumber the timers by this factor
+    const size_t s_maxHeapOverhead = 2;
+}
 
 
 namespace gloperate
 {
 
 
+bool TimerManager::HeapEntry::operator>(const HeapEntry & other) const
+{
+    // Timers with the same deadline fire in the order they have been scheduled
+    return deadline > other.deadline || (deadline == other.deadline && sequence > other.sequence);
+}
+
 TimerManager::TimerManager(Environment * environment)
 : cppexpose::Object("timer")
 , m_environment(environment)
+, m_time(0.0)
+, m_nextSequence(0)
+, m_firingId(0)
 , m_nextId(1)
 {
     // Register functions
@@ -47,15 +57,95 @@ void TimerManager::update()
 
 void TimerManager::update(float delta)
 {
-    for (auto it = m_timers.begin(); it != m_timers.end(); ++it)
+    if (delta < 0.0f)
+    {
+        return;
+    }
+
+    m_time += delta;
+
+    // Timers scheduled from within callbacks are not fired before the next update
+    const auto lastSequence = m_nextSequence;
+
+    std::vector<HeapEntry> postponed;
+
+    while (!m_heap.empty() && m_heap.front().deadline <= m_time)
     {
-        Timer * timer = it->second.get();
+        // Take next due timer
+        std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<HeapEntry>());
+        const HeapEntry entry = m_heap.back();
+        m_heap.pop_back();
 
-        if (timer->active)
+        if (!isValid(entry))
         {
-            updateTimer(timer, delta);
+            continue;
+        }
+
+        if (entry.sequence >= lastSequence)
+        {
+            postponed.push_back(entry);
+            continue;
+        }
+
+        Timer * timer = m_timers.at(entry.id).get();
+
+        // Call timer function. The timer must not be deleted meanwhile,
+        // so stopping it from within the callback is deferred.
+        m_firingId = entry.id;
+
+        std::vector<cppexpose::Variant> params;
+        cppexpose::Variant res = timer->func.call(params);
+
+        m_firingId = 0;
+
+        // Delete or reschedule timer
+        if (timer->singleShot || !timer->active)
+        {
+            m_timers.erase(entry.id);
+        }
+        else
+        {
+            schedule(entry.id, timer, m_time + timer->interval);
         }
     }
+
+    for (const auto & entry : postponed)
+    {
+        m_heap.push_back(entry);
+        std::push_heap(m_heap.begin(), m_heap.end(), std::greater<HeapEntry>());
+    }
+
+    removeInvalidEntries();
+}
+
+float TimerManager::remainingTime() const
+{
+    if (m_heap.empty())
+    {
+        return -1.0f;
+    }
+
+    const float remaining = static_cast<float>(m_heap.front().deadline - m_time);
+
+    if (remaining <= 0.0f)
+    {
+        return 0.0f;
+    }
+
+    // Account for the time since the last update
+    const float elapsed = std::chrono::duration_cast<std::chrono::duration<float>>(m_clock.elapsed()).count();
+
+    return std::max(remaining - elapsed, 0.0f);
+}
+
+double TimerManager::time() const
+{
+    return m_time;
+}
+
+size_t TimerManager::timerCount() const
+{
+    return m_timers.size();
 }
 
 int TimerManager::scr_start(int msec, const cppexpose::Variant & func)
@@ -70,25 +160,30 @@ int TimerManager::scr_once(int msec, const cppexpose::Variant & func)
 
 void TimerManager::scr_stop(int id)
 {
-    // Check timer ID
-    if (m_timers.count(id) < 1) {
-        return;
-    }
-
     // Stop timer
-    Timer * timer = m_timers.at(id).get();
-    stopTimer(timer);
+    stopTimer(id);
+
+    removeInvalidEntries();
 }
 
 void TimerManager::scr_stopAll()
 {
-    // Enumerate all timers
+    // Collect IDs first, as stopping a timer deletes it
+    std::vector<int> ids;
+    ids.reserve(m_timers.size());
+
     for (auto it = m_timers.begin(); it != m_timers.end(); ++it)
     {
-        // Stop timer
-        Timer * timer = it->second.get();
-        stopTimer(timer);
+        ids.push_back(it->first);
+    }
+
+    // Stop all timers
+    for (int id : ids)
+    {
+        stopTimer(id);
     }
+
+    removeInvalidEntries();
 }
 
 int TimerManager::scr_nextTick(const cppexpose::Variant & func)
@@ -110,54 +205,77 @@ int TimerManager::startTimer(const cppexpose::Variant & func, int msec, bool sin
     // Create and start timer
     auto timer = cppassist::make_unique<Timer>();
     timer->interval   = msec / 1000.0f;
-    timer->remaining  = msec / 1000.0f;
     timer->singleShot = singleShot;
     timer->active     = true;
     timer->func       = function;
 
     // Store timer
     int id = m_nextId++;
+    schedule(id, timer.get(), m_time + timer->interval);
     m_timers[id] = std::move(timer);
 
+    // Make sure that a waiting event loop considers the new timer
+    m_environment->wakeup();
+
     // Return timer ID
     return id;
 }
 
-void TimerManager::stopTimer(Timer * timer)
+void TimerManager::stopTimer(int id)
 {
-    timer->active     = false;
-    timer->interval   = 0.0f;
-    timer->remaining  = 0.0f;
-    timer->singleShot = false;
+    // Check timer ID
+    const auto it = m_timers.find(id);
+
+    if (it == m_timers.end())
+    {
+        return;
+    }
+
+    // The timer whose callback is currently called is deleted when the callback has returned
+    if (id == m_firingId)
+    {
+        it->second->active = false;
+        return;
+    }
+
+    // Its heap entry becomes invalid and is skipped
+    m_timers.erase(it);
 }
 
-void TimerManager::updateTimer(Timer * timer, float delta)
+void TimerManager::schedule(int id, Timer * timer, double deadline)
 {
-    if (timer->active && delta >= 0.0f)
+    timer->deadline = deadline;
+    timer->sequence = m_nextSequence++;
+
+    m_heap.push_back({ deadline, timer->sequence, id });
+    std::push_heap(m_heap.begin(), m_heap.end(), std::greater<HeapEntry>());
+}
+
+bool TimerManager::isValid(const HeapEntry & entry) const
+{
+    const auto it = m_timers.find(entry.id);
+
+    return it != m_timers.end() && it->second->active && it->second->sequence == entry.sequence;
+}
+
+void TimerManager::removeInvalidEntries()
+{
+    // Make sure the top of the heap refers to an active timer, so remainingTime() is exact
+    while (!m_heap.empty() && !isValid(m_heap.front()))
     {
-        if (timer->remaining > delta)
-        {
-            timer->remaining -= delta;
-        }
-        else
+        std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<HeapEntry>());
+        m_heap.pop_back();
+    }
+
+    // Rebuild heap if most of its entries are outdated
+    if (m_heap.size() > s_maxHeapOverhead * m_timers.size() + 16)
+    {
+        m_heap.erase(std::remove_if(m_heap.begin(), m_heap.end(), [this] (const HeapEntry & entry)
         {
-            // Timer elapsed
-            std::vector<cppexpose::Variant> params;
-            cppexpose::Variant res = timer->func.call(params);
-
-            // Reset timer
-            if (timer->singleShot)
-            {
-                timer->active     = false;
-                timer->interval   = 0.0f;
-                timer->remaining  = 0.0f;
-                timer->singleShot = false;
-            }
-            else
-            {
-                timer->remaining = timer->interval;
-            }
-        }
+            return !isValid(entry);
+        }), m_heap.end());
+
+        std::make_heap(m_heap.begin(), m_heap.end(), std::greater<HeapEntry>());
     }
 }
 
@@ -2,10 +2,57 @@
 #include <gloperate/input/InputEvent.h>
 
 #include <cassert>
+#include <mutex>
+#include <vector>
+#include <new>
 
 #include <glm/gtx/string_cast.hpp>
 
 
+namespace
+{
+
+
+// Event sizes are rounded up to multiples of the block size
+const size_t s_blockSize = 16;
+
+// Number of size classes, i.e., events up to 256 bytes are pooled
+const size_t s_sizeClasses = 16;
+
+// Maximum number of free blocks that are kept per size class
+const size_t s_maxFreeBlocks = 256;
+
+
+struct EventPool
+{
+    EventPool()
+    {
+        for (auto & blocks : freeBlocks)
+        {
+            blocks.reserve(s_maxFreeBlocks);
+        }
+    }
+
+    std::mutex          mutex;
+    std::vector<void *> freeBlocks[s_sizeClasses];
+};
+
+EventPool & eventPool()
+{
+    // Never destroyed, as events may still be deleted during static destruction
+    static EventPool * pool = new EventPool;
+    return *pool;
+}
+
+size_t sizeClass(size_t size)
+{
+    return (size + s_blockSize - 1) / s_blockSize - 1;
+}
+
+
+} // namespace
+
+
 namespace gloperate
 {
 
@@ -36,5 +83,62 @@ std::string InputEvent::asString() const
     return std::to_string(static_cast<int>(m_type));
 }
 
+void * InputEvent::operator new(size_t size)
+{
+    const size_t index = sizeClass(size);
+
+    if (index >= s_sizeClasses)
+    {
+        return ::operator new(size);
+    }
+
+    // Reuse free block of the same size class
+    auto & pool = eventPool();
+
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+
+        auto & blocks = pool.freeBlocks[index];
+
+        if (!blocks.empty())
+        {
+            void * block = blocks.back();
+            blocks.pop_back();
+
+            return block;
+        }
+    }
+
+    // Allocate the whole block, so it can hold any event of its size class later
+    return ::operator new((index + 1) * s_blockSize);
+}
+
+void InputEvent::operator delete(void * ptr, size_t size)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    const size_t index = sizeClass(size);
+
+    if (index < s_sizeClasses)
+    {
+        auto & pool = eventPool();
+
+        std::lock_guard<std::mutex> lock(pool.mutex);
+
+        auto & blocks = pool.freeBlocks[index];
+
+        if (blocks.size() < s_maxFreeBlocks)
+        {
+            blocks.push_back(ptr);
+            return;
+        }
+    }
+
+    ::operator delete(ptr);
+}
+
 
 } // namespace gloperate
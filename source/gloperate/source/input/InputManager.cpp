@@ -2,6 +2,7 @@
 #include <gloperate/input/InputManager.h>
 
 #include <cassert>
+#include <algorithm>
 
 #include <gloperate/input/AbstractDeviceProvider.h>
 #include <gloperate/input/AbstractDevice.h>
@@ -11,6 +12,66 @@
 #include <gloperate/input/MouseEvent.h>
 
 
+namespace
+{
+
+
+// Names of the event types for scripting (in the order of InputEvent::Type)
+const char * s_typeNames[] =
+{
+    "ButtonPress",
+    "ButtonRelease",
+    "MouseMove",
+    "MouseButtonPress",
+    "MouseButtonRelease",
+    "MouseWheelScroll",
+    "SpatialAxis"
+};
+
+const unsigned int s_typeCount = sizeof(s_typeNames) / sizeof(s_typeNames[0]);
+
+// Bit mask of all event types
+const unsigned int s_allTypes = (1u << s_typeCount) - 1;
+
+// Number of events kept in the history by default
+const size_t s_defaultHistoryDepth = 64;
+
+// Maximum number of events kept for scripting callbacks between two updates
+const size_t s_maxScriptEvents = 1024;
+
+
+unsigned int typeBit(gloperate::InputEvent::Type type)
+{
+    return 1u << static_cast<unsigned int>(type);
+}
+
+unsigned int typeMask(const cppexpose::Variant & name)
+{
+    const auto typeName = name.value<std::string>();
+
+    for (unsigned int i = 0; i < s_typeCount; ++i)
+    {
+        if (typeName == s_typeNames[i])
+        {
+            return 1u << i;
+        }
+    }
+
+    return 0;
+}
+
+bool isMouseEvent(gloperate::InputEvent::Type type)
+{
+    return type == gloperate::InputEvent::Type::MouseMove
+        || type == gloperate::InputEvent::Type::MouseButtonPress
+        || type == gloperate::InputEvent::Type::MouseButtonRelease
+        || type == gloperate::InputEvent::Type::MouseWheelScroll;
+}
+
+
+} // namespace
+
+
 namespace gloperate
 {
 
@@ -18,6 +79,10 @@ namespace gloperate
 InputManager::InputManager(Environment * environment)
 : cppexpose::Object("input")
 , m_environment(environment)
+, m_history(s_defaultHistoryDepth)
+, m_historyStart(0)
+, m_historySize(0)
+, m_callbackTypes(0)
 , m_nextId(1)
 {
     // Register functions
@@ -55,69 +120,185 @@ void InputManager::onEvent(std::unique_ptr<InputEvent> && event)
         consumer->onEvent(event.get());
     }
 
-    for (auto it = m_callbacks.begin(); it != m_callbacks.end(); ++it)
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Convert event for scripting only if a callback has subscribed to its type
+    const auto type = event->type();
+
+    if (m_callbackTypes & typeBit(type))
+    {
+        ScriptEvent * previous = m_scriptEvents.empty() ? nullptr : &m_scriptEvents.back();
+
+        const bool coalesce = previous && previous->source == event->device() && previous->type == static_cast<int>(type) &&
+                              (type == InputEvent::Type::MouseMove || type == InputEvent::Type::MouseWheelScroll || type == InputEvent::Type::SpatialAxis);
+
+        if (coalesce)
+        {
+            // Keep the latest position and accumulate wheel deltas
+            if (isMouseEvent(type))
+            {
+                auto mouseEvent = static_cast<MouseEvent *>(event.get());
+
+                previous->pos    = mouseEvent->pos();
+                previous->delta += mouseEvent->wheelDelta();
+            }
+        }
+        else
+        {
+            ScriptEvent scriptEvent = { event->device(), event->device()->deviceDescriptor(), static_cast<int>(type), 0, 0, 0, glm::ivec2(0), glm::vec2(0.0f) };
+
+            if (type == InputEvent::Type::ButtonPress || type == InputEvent::Type::ButtonRelease)
+            {
+                auto buttonEvent = static_cast<ButtonEvent *>(event.get());
+
+                scriptEvent.key      = buttonEvent->key();
+                scriptEvent.modifier = buttonEvent->modifier();
+            }
+
+            else if (isMouseEvent(type))
+            {
+                auto mouseEvent = static_cast<MouseEvent *>(event.get());
+
+                scriptEvent.button = mouseEvent->button();
+                scriptEvent.pos    = mouseEvent->pos();
+                scriptEvent.delta  = mouseEvent->wheelDelta();
+            }
+
+            // Drop the oldest events if update() is not called
+            if (m_scriptEvents.size() >= s_maxScriptEvents)
+            {
+                m_scriptEvents.erase(m_scriptEvents.begin());
+            }
+
+            m_scriptEvents.push_back(std::move(scriptEvent));
+        }
+    }
+
+    addToHistory(std::move(event));
+}
+
+void InputManager::update()
+{
     {
-        cppexpose::Function & func = it->second;
-        std::string device   = "";
-        std::string type     = "";
-        int         key      = 0;
-        int         modifier = 0;
-        int         button   = 0;
-        int         x        = 0;
-        int         y        = 0;
-        int         wx       = 0;
-        int         wy       = 0;
-
-        device = event->device()->deviceDescriptor();
-
-        if (event->type() == InputEvent::Type::ButtonPress || event->type() == InputEvent::Type::ButtonRelease)
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_scriptEvents.empty())
         {
-            auto buttonEvent = static_cast<ButtonEvent *>(event.get());
-
-                 if (event->type() == InputEvent::Type::ButtonPress)   type = "ButtonPress";
-            else if (event->type() == InputEvent::Type::ButtonRelease) type = "ButtonRelease";
-            key      = buttonEvent->key();
-            modifier = buttonEvent->modifier();
-            button   = 0;
-            x        = 0;
-            y        = 0;
-            wx       = 0;
-            wy       = 0;
+            return;
         }
 
-        else if (event->type() == InputEvent::Type::MouseMove || event->type() == InputEvent::Type::MouseButtonPress || event->type() == InputEvent::Type::MouseButtonRelease)
+        m_dispatchEvents.swap(m_scriptEvents);
+    }
+
+    for (const auto & event : m_dispatchEvents)
+    {
+        const unsigned int bit = 1u << static_cast<unsigned int>(event.type);
+
+        // Arguments are created once and shared by all callbacks
+        const std::vector<cppexpose::Variant> args = {
+            event.device,
+            std::string(s_typeNames[event.type]),
+            event.key,
+            event.modifier,
+            event.button,
+            event.pos.x,
+            event.pos.y,
+            static_cast<int>(event.delta.x),
+            static_cast<int>(event.delta.y)
+        };
+
+        for (auto it = m_callbacks.begin(); it != m_callbacks.end(); ++it)
         {
-            auto mouseEvent = static_cast<MouseEvent *>(event.get());
-
-                 if (event->type() == InputEvent::Type::MouseMove)          type = "MouseMove";
-            else if (event->type() == InputEvent::Type::MouseButtonPress)   type = "MouseButtonPress";
-            else if (event->type() == InputEvent::Type::MouseButtonRelease) type = "MouseButtonRelease";
-            key      = 0;
-            modifier = 0;
-            button   = mouseEvent->button();
-            x        = mouseEvent->pos().x;
-            y        = mouseEvent->pos().y;
-            wx       = mouseEvent->wheelDelta().x;
-            wy       = mouseEvent->wheelDelta().y;
+            if (it->second.typeMask & bit)
+            {
+                it->second.function.call(args);
+            }
         }
+    }
+
+    // Keep the allocated memory for the next update
+    m_dispatchEvents.clear();
+}
+
+size_t InputManager::historyDepth() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_history.size();
+}
+
+void InputManager::setHistoryDepth(size_t depth)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Keep the most recent events
+    std::vector<std::unique_ptr<InputEvent>> history(depth);
+    const size_t count = std::min(depth, m_historySize);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        history[i] = std::move(m_history[(m_historyStart + m_historySize - count + i) % m_history.size()]);
+    }
+
+    m_history      = std::move(history);
+    m_historyStart = 0;
+    m_historySize  = count;
+}
+
+std::vector<const InputEvent *> InputManager::history() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::vector<const InputEvent *> events;
+    events.reserve(m_historySize);
+
+    for (size_t i = 0; i < m_historySize; ++i)
+    {
+        events.push_back(m_history[(m_historyStart + i) % m_history.size()].get());
+    }
+
+    return events;
+}
 
-        func.call({
-            device,
-            type,
-            key,
-            modifier,
-            button,
-            x,
-            y,
-            wx,
-            wy
-        });
+void InputManager::addToHistory(std::unique_ptr<InputEvent> && event)
+{
+    if (m_history.empty())
+    {
+        return;
     }
 
-	m_events.push_back(std::move(event));
+    const size_t capacity = m_history.size();
+
+    // Only the latest position of a device is of interest, so replace the
+    // newest event if it is of the same kind. Wheel deltas are relative
+    // and therefore all kept.
+    const auto type = event->type();
+
+    if (m_historySize > 0 && (type == InputEvent::Type::MouseMove || type == InputEvent::Type::SpatialAxis))
+    {
+        auto & newest = m_history[(m_historyStart + m_historySize - 1) % capacity];
+
+        if (newest->type() == type && newest->device() == event->device())
+        {
+            newest = std::move(event);
+            return;
+        }
+    }
+
+    if (m_historySize < capacity)
+    {
+        m_history[(m_historyStart + m_historySize) % capacity] = std::move(event);
+        m_historySize++;
+    }
+    else
+    {
+        // Overwrite the oldest event
+        m_history[m_historyStart] = std::move(event);
+        m_historyStart = (m_historyStart + 1) % capacity;
+    }
 }
 
-int InputManager::scr_onInput(const cppexpose::Variant & func)
+int InputManager::scr_onInput(const cppexpose::Variant & func, const cppexpose::Variant & types)
 {
     // Check if a function has been passed
     if (!func.hasType<cppexpose::Function>())
@@ -125,14 +306,37 @@ int InputManager::scr_onInput(const cppexpose::Variant & func)
         return -1;
     }
 
+    // Get subscribed event types (all types, if none are given)
+    unsigned int mask = 0;
+
+    if (types.hasType<std::string>())
+    {
+        mask = typeMask(types);
+    }
+    else if (types.hasType<cppexpose::VariantArray>())
+    {
+        for (const auto & type : *types.asArray())
+        {
+            mask |= typeMask(type);
+        }
+    }
+
+    if (mask == 0)
+    {
+        mask = s_allTypes;
+    }
+
     // Get callback function
     cppexpose::Function function = func.value<cppexpose::Function>();
 
-    // Store timer
+    // Store callback
     int id = m_nextId++;
-    m_callbacks[id] = std::move(function);
+    m_callbacks[id] = { std::move(function), mask };
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_callbackTypes |= mask;
 
-    // Return timer ID
+    // Return callback ID
     return id;
 }
 
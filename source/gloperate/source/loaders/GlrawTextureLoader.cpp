@@ -2,22 +2,410 @@
 #include <gloperate/loaders/GlrawTextureLoader.h>
 
 #include <algorithm>
+#include <memory>
+#include <map>
+#include <cstring>
+#include <cstdint>
 
 #include <cppfs/FilePath.h>
 
-#include <cppassist/fs/readfile.h>
-#include <cppassist/fs/RawFile.h>
-#include <cppassist/fs/DescriptiveRawFile.h>
+#include <cppassist/logging/logging.h>
+#include <cppassist/memory/make_unique.h>
 
 #include <cppexpose/variant/Variant.h>
 
 #include <glbinding/gl/enum.h>
+#include <glbinding/gl/bitfield.h>
+#include <glbinding/gl/functions.h>
 
+#include <globjects/Buffer.h>
 #include <globjects/Texture.h>
 
+#include <gloperate/base/MappedFile.h>
 #include <gloperate/loaders/RawFileNameSuffix.h>
 
 
+namespace
+{
+
+
+// Layout of .glraw files as written by glraw and read by cppassist::DescriptiveRawFile:
+// magic number (uint16), offset of the image data (uint64), then properties
+// consisting of type (uint8), null-terminated key and value up to the offset.
+const uint16_t s_magicNumber = 0xC4F3;
+
+enum PropertyType : uint8_t
+{
+    IntType    = 1,
+    DoubleType = 2,
+    StringType = 3
+};
+
+
+/**
+*  @brief
+*    Description of the image data of a file
+*/
+struct ImageLayout
+{
+    int                 width;          ///< Width of level 0
+    int                 height;         ///< Height of level 0
+    int                 layers;         ///< Number of array layers (1 for 2D textures)
+    gl::GLenum          internalFormat; ///< OpenGL internal image format
+    gl::GLenum          format;         ///< OpenGL image format (GL_NONE for compressed images)
+    gl::GLenum          type;           ///< OpenGL data type (GL_NONE for compressed images)
+    std::vector<size_t> levelSizes;     ///< Size of each mipmap level including all layers (in bytes)
+};
+
+
+template <typename T>
+bool readValue(const char * data, size_t end, size_t & pos, T & value)
+{
+    if (pos + sizeof(T) > end)
+    {
+        return false;
+    }
+
+    std::memcpy(&value, data + pos, sizeof(T));
+    pos += sizeof(T);
+
+    return true;
+}
+
+bool readString(const char * data, size_t end, size_t & pos, std::string & value)
+{
+    const auto terminator = static_cast<const char *>(std::memchr(data + pos, '\0', end - pos));
+    if (!terminator)
+    {
+        return false;
+    }
+
+    value.assign(data + pos, terminator);
+    pos = static_cast<size_t>(terminator - data) + 1;
+
+    return true;
+}
+
+bool readGlrawHeader(const char * data, size_t size, size_t & dataOffset, std::map<std::string, int> & intProperties)
+{
+    size_t pos = 0;
+
+    uint16_t magicNumber = 0;
+    uint64_t offset = 0;
+
+    if (!readValue(data, size, pos, magicNumber) || magicNumber != s_magicNumber ||
+        !readValue(data, size, pos, offset) || offset > size)
+    {
+        return false;
+    }
+
+    const auto end = static_cast<size_t>(offset);
+
+    while (pos < end)
+    {
+        uint8_t type = 0;
+        std::string key;
+
+        if (!readValue(data, end, pos, type) || !readString(data, end, pos, key))
+        {
+            return false;
+        }
+
+        bool valid = false;
+
+        switch (type)
+        {
+        case IntType:
+            {
+                int32_t value = 0;
+                valid = readValue(data, end, pos, value);
+                intProperties[key] = value;
+            }
+            break;
+
+        case DoubleType:
+            {
+                double value = 0.0;
+                valid = readValue(data, end, pos, value);
+            }
+            break;
+
+        case StringType:
+            {
+                std::string value;
+                valid = readString(data, end, pos, value);
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        if (!valid)
+        {
+            return false;
+        }
+    }
+
+    dataOffset = end;
+
+    return true;
+}
+
+size_t bytesPerPixel(gl::GLenum format, gl::GLenum type)
+{
+    // Packed types describe a whole pixel
+    switch (type)
+    {
+    case gl::GL_UNSIGNED_BYTE_3_3_2:
+    case gl::GL_UNSIGNED_BYTE_2_3_3_REV:
+        return 1;
+
+    case gl::GL_UNSIGNED_SHORT_5_6_5:
+    case gl::GL_UNSIGNED_SHORT_5_6_5_REV:
+    case gl::GL_UNSIGNED_SHORT_4_4_4_4:
+    case gl::GL_UNSIGNED_SHORT_4_4_4_4_REV:
+    case gl::GL_UNSIGNED_SHORT_5_5_5_1:
+    case gl::GL_UNSIGNED_SHORT_1_5_5_5_REV:
+        return 2;
+
+    case gl::GL_UNSIGNED_INT_8_8_8_8:
+    case gl::GL_UNSIGNED_INT_8_8_8_8_REV:
+    case gl::GL_UNSIGNED_INT_10_10_10_2:
+    case gl::GL_UNSIGNED_INT_2_10_10_10_REV:
+    case gl::GL_UNSIGNED_INT_10F_11F_11F_REV:
+    case gl::GL_UNSIGNED_INT_5_9_9_9_REV:
+    case gl::GL_UNSIGNED_INT_24_8:
+        return 4;
+
+    case gl::GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+        return 8;
+
+    default:
+        break;
+    }
+
+    size_t components = 0;
+    switch (format)
+    {
+    case gl::GL_RED:
+    case gl::GL_GREEN:
+    case gl::GL_BLUE:
+    case gl::GL_RED_INTEGER:
+    case gl::GL_DEPTH_COMPONENT:
+    case gl::GL_STENCIL_INDEX:
+        components = 1;
+        break;
+
+    case gl::GL_RG:
+    case gl::GL_RG_INTEGER:
+        components = 2;
+        break;
+
+    case gl::GL_RGB:
+    case gl::GL_BGR:
+    case gl::GL_RGB_INTEGER:
+    case gl::GL_BGR_INTEGER:
+        components = 3;
+        break;
+
+    case gl::GL_RGBA:
+    case gl::GL_BGRA:
+    case gl::GL_RGBA_INTEGER:
+    case gl::GL_BGRA_INTEGER:
+        components = 4;
+        break;
+
+    default:
+        return 0;
+    }
+
+    switch (type)
+    {
+    case gl::GL_UNSIGNED_BYTE:
+    case gl::GL_BYTE:
+        return components;
+
+    case gl::GL_UNSIGNED_SHORT:
+    case gl::GL_SHORT:
+    case gl::GL_HALF_FLOAT:
+        return components * 2;
+
+    case gl::GL_UNSIGNED_INT:
+    case gl::GL_INT:
+    case gl::GL_FLOAT:
+        return components * 4;
+
+    default:
+        return 0;
+    }
+}
+
+gl::GLenum internalFormat(gl::GLenum format, gl::GLenum type)
+{
+    // Channels of the base internal format
+    static const std::map<gl::GLenum, int> channels =
+    {
+        { gl::GL_RED,   1 },
+        { gl::GL_GREEN, 1 },
+        { gl::GL_BLUE,  1 },
+        { gl::GL_RG,    2 },
+        { gl::GL_RGB,   3 },
+        { gl::GL_BGR,   3 },
+        { gl::GL_RGBA,  4 },
+        { gl::GL_BGRA,  4 }
+    };
+
+    static const std::map<gl::GLenum, std::vector<gl::GLenum>> sizedFormats =
+    {
+        { gl::GL_UNSIGNED_BYTE,  { gl::GL_R8,        gl::GL_RG8,        gl::GL_RGB8,        gl::GL_RGBA8        } },
+        { gl::GL_BYTE,           { gl::GL_R8_SNORM,  gl::GL_RG8_SNORM,  gl::GL_RGB8_SNORM,  gl::GL_RGBA8_SNORM  } },
+        { gl::GL_UNSIGNED_SHORT, { gl::GL_R16,       gl::GL_RG16,       gl::GL_RGB16,       gl::GL_RGBA16       } },
+        { gl::GL_SHORT,          { gl::GL_R16_SNORM, gl::GL_RG16_SNORM, gl::GL_RGB16_SNORM, gl::GL_RGBA16_SNORM } },
+        { gl::GL_HALF_FLOAT,     { gl::GL_R16F,      gl::GL_RG16F,      gl::GL_RGB16F,      gl::GL_RGBA16F      } },
+        { gl::GL_FLOAT,          { gl::GL_R32F,      gl::GL_RG32F,      gl::GL_RGB32F,      gl::GL_RGBA32F      } }
+    };
+
+    const auto channel = channels.find(format);
+    const auto sized   = sizedFormats.find(type);
+
+    if (channel == channels.end() || sized == sizedFormats.end())
+    {
+        // Let the driver choose for other combinations
+        return format == gl::GL_BGRA ? gl::GL_RGBA : (format == gl::GL_BGR ? gl::GL_RGB : format);
+    }
+
+    return sized->second[channel->second - 1];
+}
+
+bool computeLevelSizes(ImageLayout & layout, const std::map<std::string, int> & intProperties, int levels, size_t dataSize)
+{
+    if (layout.width <= 0 || layout.height <= 0 || layout.layers <= 0 || levels <= 0)
+    {
+        return false;
+    }
+
+    const bool compressed = layout.format == gl::GL_NONE;
+    const auto pixelSize = compressed ? 0 : bytesPerPixel(layout.format, layout.type);
+
+    if (!compressed && pixelSize == 0)
+    {
+        return false;
+    }
+
+    size_t total = 0;
+
+    for (int level = 0; level < levels; ++level)
+    {
+        size_t levelSize = 0;
+
+        if (compressed)
+        {
+            // Compressed images store the size of each level
+            const auto it = intProperties.find(level == 0 ? "size" : "size" + std::to_string(level));
+            if (it == intProperties.end() || it->second <= 0)
+            {
+                return false;
+            }
+
+            levelSize = static_cast<size_t>(it->second);
+        }
+        else
+        {
+            const auto width  = static_cast<size_t>(std::max(1, layout.width  >> level));
+            const auto height = static_cast<size_t>(std::max(1, layout.height >> level));
+
+            levelSize = width * height * static_cast<size_t>(layout.layers) * pixelSize;
+        }
+
+        layout.levelSizes.push_back(levelSize);
+        total += levelSize;
+    }
+
+    return total <= dataSize;
+}
+
+globjects::Texture * createTexture(const ImageLayout & layout, const char * data)
+{
+    const bool array = layout.layers > 1;
+    const auto levels = static_cast<int>(layout.levelSizes.size());
+
+    auto texture = globjects::Texture::createDefault(array ? gl::GL_TEXTURE_2D_ARRAY : gl::GL_TEXTURE_2D);
+
+    if (levels > 1)
+    {
+        texture->setParameter(gl::GL_TEXTURE_MIN_FILTER, gl::GL_LINEAR_MIPMAP_LINEAR);
+    }
+
+    texture->setParameter(gl::GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+    // Stream each level through a pixel unpack buffer sized for the largest level
+    const auto bufferSize = *std::max_element(layout.levelSizes.begin(), layout.levelSizes.end());
+
+    auto buffer = cppassist::make_unique<globjects::Buffer>();
+    buffer->setData(static_cast<gl::GLsizeiptr>(bufferSize), nullptr, gl::GL_STREAM_DRAW);
+
+    // Image data is tightly packed, the previous alignment is restored afterwards
+    gl::GLint unpackAlignment = 4;
+    gl::glGetIntegerv(gl::GL_UNPACK_ALIGNMENT, &unpackAlignment);
+
+    gl::glPixelStorei(gl::GL_UNPACK_ALIGNMENT, 1);
+
+    size_t offset = 0;
+
+    for (int level = 0; level < levels; ++level)
+    {
+        const auto size   = layout.levelSizes[level];
+        const auto width  = std::max(1, layout.width  >> level);
+        const auto height = std::max(1, layout.height >> level);
+
+        // Copy level from the mapped file, or upload from the mapping directly if the buffer cannot be mapped
+        const void * pixels = data + offset;
+
+        auto mapped = buffer->mapRange(0, static_cast<gl::GLsizeiptr>(size), gl::GL_MAP_WRITE_BIT | gl::GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (mapped)
+        {
+            std::memcpy(mapped, data + offset, size);
+            buffer->unmap();
+
+            buffer->bind(gl::GL_PIXEL_UNPACK_BUFFER);
+            pixels = nullptr;
+        }
+
+        if (layout.format == gl::GL_NONE)
+        {
+            if (array)
+                texture->compressedImage3D(level, layout.internalFormat, width, height, layout.layers, 0, static_cast<gl::GLsizei>(size), pixels);
+            else
+                texture->compressedImage2D(level, layout.internalFormat, width, height, 0, static_cast<gl::GLsizei>(size), pixels);
+        }
+        else
+        {
+            if (array)
+                texture->image3D(level, layout.internalFormat, width, height, layout.layers, 0, layout.format, layout.type, pixels);
+            else
+                texture->image2D(level, layout.internalFormat, width, height, 0, layout.format, layout.type, pixels);
+        }
+
+        globjects::Buffer::unbind(gl::GL_PIXEL_UNPACK_BUFFER);
+
+        offset += size;
+    }
+
+    gl::glPixelStorei(gl::GL_UNPACK_ALIGNMENT, unpackAlignment);
+
+    return texture.release();
+}
+
+std::function<globjects::Texture *()> failed()
+{
+    return [] () -> globjects::Texture * { return nullptr; };
+}
+
+
+} // namespace
+
+
 namespace gloperate
 {
 
@@ -64,107 +452,127 @@ std::string GlrawTextureLoader::allLoadingTypes() const
     return allTypes;
 }
 
-globjects::Texture * GlrawTextureLoader::load(const std::string & filename, const cppexpose::Variant &, std::function<void(int, int)>) const
+globjects::Texture * GlrawTextureLoader::load(const std::string & filename, const cppexpose::Variant & options, std::function<void(int, int)> progress) const
 {
-    globjects::Texture * texture = nullptr;
+    return prepare(filename, options, progress)();
+}
 
+std::function<globjects::Texture *()> GlrawTextureLoader::prepare(const std::string & filename, const cppexpose::Variant &, std::function<void(int, int)>) const
+{
     cppfs::FilePath filePath(filename);
     if (filePath.extension() == ".glraw")
-        texture = loadGLRawImage(filename);
+        return prepareGLRawImage(filename);
     else if (filePath.extension() == ".raw")
-        texture = loadRawImage(filename);
+        return prepareRawImage(filename);
 
-    return texture;
+    return failed();
 }
 
-globjects::Texture * GlrawTextureLoader::loadGLRawImage(const std::string & filename) const
+std::function<globjects::Texture *()> GlrawTextureLoader::prepareGLRawImage(const std::string & filename) const
 {
-    cppassist::DescriptiveRawFile rawFile;
+    auto file = std::make_shared<MappedFile>();
 
-    if (!rawFile.load(filename))
-        return nullptr;
+    if (!file->open(filename))
+        return failed();
 
-    const int w = rawFile.intProperty("width");
-    const int h = rawFile.intProperty("height");
+    size_t dataOffset = 0;
+    std::map<std::string, int> properties;
 
-    globjects::Texture * texture = globjects::Texture::createDefault(gl::GL_TEXTURE_2D).release();
+    if (!readGlrawHeader(file->data(), file->size(), dataOffset, properties))
+    {
+        cppassist::warning("gloperate") << "Invalid glraw header (" << filename << ")";
+        return failed();
+    }
 
-    if (rawFile.hasIntProperty("format"))
+    const auto property = [&properties] (const std::string & key, int defaultValue)
     {
-        auto format = static_cast<gl::GLenum>(rawFile.intProperty("format"));
-        auto type = static_cast<gl::GLenum>(rawFile.intProperty("type"));
+        const auto it = properties.find(key);
+        return it != properties.end() ? it->second : defaultValue;
+    };
+
+    ImageLayout layout;
+    layout.width  = property("width", 0);
+    layout.height = property("height", 0);
+    layout.layers = property("layers", 1);
 
-        texture->image2D(
-            0,
-            gl::GL_RGBA8,
-            w,
-            h,
-            0,
-            format,
-            type,
-            rawFile.data()
-        );
+    if (properties.count("format"))
+    {
+        layout.format         = static_cast<gl::GLenum>(property("format", 0));
+        layout.type           = static_cast<gl::GLenum>(property("type", 0));
+        layout.internalFormat = static_cast<gl::GLenum>(property("internalFormat", static_cast<int>(internalFormat(layout.format, layout.type))));
     }
     else
     {
-        auto compressedFormat = static_cast<gl::GLenum>(rawFile.intProperty("compressedFormat"));
-        auto size = rawFile.intProperty("size");
+        layout.format         = gl::GL_NONE;
+        layout.type           = gl::GL_NONE;
+        layout.internalFormat = static_cast<gl::GLenum>(property("compressedFormat", 0));
+    }
 
-        texture->compressedImage2D(
-            0,
-            compressedFormat,
-            w,
-            h,
-            0,
-            size,
-            rawFile.data()
-        );
+    if (!computeLevelSizes(layout, properties, property("levels", 1), file->size() - dataOffset))
+    {
+        cppassist::warning("gloperate") << "Image data does not match glraw header (" << filename << ")";
+        return failed();
     }
 
-    return texture;
+    // Read the image data here, so the upload on the context thread does not wait for the disk
+    file->prefetch();
+
+    // Upload on the context thread, the mapping is released afterwards
+    return [file, dataOffset, layout] ()
+    {
+        return createTexture(layout, file->data() + dataOffset);
+    };
 }
 
-globjects::Texture * GlrawTextureLoader::loadRawImage(const std::string & filename) const
+std::function<globjects::Texture *()> GlrawTextureLoader::prepareRawImage(const std::string & filename) const
 {
     RawFileNameSuffix suffix(filename);
 
     if (!suffix.isValid())
-        return nullptr;
+        return failed();
+
+    auto file = std::make_shared<MappedFile>();
+
+    if (!file->open(filename))
+        return failed();
 
-    //read file
-    cppassist::RawFile rawFile;
-    if (!rawFile.load(filename))
-        return nullptr;
+    ImageLayout layout;
+    layout.width  = suffix.width();
+    layout.height = suffix.height();
+    layout.layers = 1;
 
-    globjects::Texture * texture = globjects::Texture::createDefault(gl::GL_TEXTURE_2D).release();
+    std::map<std::string, int> properties;
 
     if (!suffix.compressed())
     {
-        texture->image2D(
-            0,
-            gl::GL_RGBA8,
-            suffix.width(),
-            suffix.height(),
-            0,
-            suffix.format(),
-            suffix.type(),
-            rawFile.data()
-        );
+        layout.format         = suffix.format();
+        layout.type           = suffix.type();
+        layout.internalFormat = internalFormat(layout.format, layout.type);
     }
     else
     {
-        texture->compressedImage2D(
-            0,
-            gl::GL_RGBA8,
-            suffix.width(),
-            suffix.height(),
-            0,
-            rawFile.size(),
-            rawFile.data()
-        );
+        // The type suffix of compressed images names the compressed format
+        layout.format         = gl::GL_NONE;
+        layout.type           = gl::GL_NONE;
+        layout.internalFormat = suffix.type();
+
+        properties["size"] = static_cast<int>(file->size());
+    }
+
+    if (!computeLevelSizes(layout, properties, 1, file->size()))
+    {
+        cppassist::warning("gloperate") << "Image data does not match file name (" << filename << ")";
+        return failed();
     }
 
-    return texture;
+    // Read the image data here, so the upload on the context thread does not wait for the disk
+    file->prefetch();
+
+    // Upload on the context thread, the mapping is released afterwards
+    return [file, layout] ()
+    {
+        return createTexture(layout, file->data());
+    };
 }
 
 
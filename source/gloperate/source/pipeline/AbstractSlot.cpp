@@ -2,11 +2,20 @@
 #include <gloperate/pipeline/AbstractSlot.h>
 
 #include <sstream>
+#include <unordered_set>
 
+#include <gloperate/base/logging.h>
 #include <gloperate/pipeline/Stage.h>
 #include <gloperate/pipeline/Pipeline.h>
 
 
+namespace
+{
+    // Slots that are being invalidated on this thread while another thread holds their stamp
+    thread_local std::unordered_set<const gloperate::AbstractSlot *> t_invalidatingSlots;
+}
+
+
 namespace gloperate
 {
 
@@ -16,6 +25,7 @@ AbstractSlot::AbstractSlot()
 , m_dynamic(false)
 , m_required(false)
 , m_feedback(false)
+, m_invalidatingThread(std::thread::id())
 {
 }
 
@@ -25,6 +35,7 @@ AbstractSlot::AbstractSlot(const cppexpose::Variant & options)
 , m_dynamic(false)
 , m_required(false)
 , m_feedback(false)
+, m_invalidatingThread(std::thread::id())
 {
 }
 
@@ -76,7 +87,7 @@ void AbstractSlot::setRequired(bool required)
 
     m_required = required;
 
-    cppassist::debug(3, "gloperate") << this->qualifiedName() << ": required changed to " << required;
+    GLOPERATE_DEBUG(3) << this->qualifiedName() << ": required changed to " << required;
 
     onRequiredChanged();
 }
@@ -88,7 +99,18 @@ bool AbstractSlot::isFeedback() const
 
 void AbstractSlot::setFeedback(bool feedback)
 {
+    if (m_feedback == feedback)
+    {
+        return;
+    }
+
     m_feedback = feedback;
+
+    // Feedback connections are ignored when sorting stages
+    if (Stage * stage = parentStage())
+    {
+        stage->invalidateInputConnections();
+    }
 }
 
 bool AbstractSlot::isConnected() const
@@ -96,6 +118,39 @@ bool AbstractSlot::isConnected() const
     return source() != nullptr;
 }
 
+bool AbstractSlot::beginInvalidation()
+{
+    const auto thisThread = std::this_thread::get_id();
+
+    // Stamp the slot if no thread is invalidating it
+    auto owner = std::thread::id();
+    if (m_invalidatingThread.compare_exchange_strong(owner, thisThread))
+    {
+        return true;
+    }
+
+    // Already stamped by this thread: cyclic dependency
+    if (owner == thisThread)
+    {
+        return false;
+    }
+
+    // Stamped by another thread: fall back to the marks of this thread
+    return t_invalidatingSlots.insert(this).second;
+}
+
+void AbstractSlot::endInvalidation()
+{
+    // Remove the stamp if this thread has set it, else the fallback mark
+    if (m_invalidatingThread.load() == std::this_thread::get_id())
+    {
+        m_invalidatingThread.store(std::thread::id());
+        return;
+    }
+
+    t_invalidatingSlots.erase(this);
+}
+
 void AbstractSlot::initSlot(SlotType slotType, Stage * parent)
 {
     m_slotType = slotType;
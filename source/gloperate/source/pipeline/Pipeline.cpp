@@ -1,9 +1,16 @@
 
 #include <gloperate/pipeline/Pipeline.h>
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <vector>
-#include <set>
+#include <deque>
+#include <memory>
+#include <sstream>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
 
 #include <cppassist/logging/logging.h>
 #include <cppassist/string/manipulation.h>
@@ -12,20 +19,23 @@
 
 #include <gloperate/base/Environment.h>
 #include <gloperate/base/ComponentManager.h>
+#include <gloperate/base/logging.h>
 #include <gloperate/pipeline/Input.h>
 #include <gloperate/pipeline/Output.h>
+#include <gloperate/rendering/ColorRenderTarget.h>
+#include <gloperate/rendering/DepthRenderTarget.h>
+#include <gloperate/rendering/DepthStencilRenderTarget.h>
+#include <gloperate/rendering/StencilRenderTarget.h>
 
 
 namespace gloperate
 {
 
 
-// [TODO] invalidate sorting when stages or connections change
-
-
 Pipeline::Pipeline(Environment * environment, const std::string & className, const std::string & name)
 : Stage(environment, className, name)
 , m_sorted(false)
+, m_transactionDepth(0)
 {
 }
 
@@ -92,11 +102,13 @@ void Pipeline::registerStage(Stage * stage)
         m_stagesMap.insert(std::make_pair(stage->name(), stage));
     }
 
-    cppassist::debug(1, "gloperate") << stage->qualifiedName() << ": add to pipeline";
+    GLOPERATE_DEBUG(1) << stage->qualifiedName() << ": add to pipeline";
 
-    // Shouldn't be required if each slot of a stage would disconnect from connections
-    // and this would be propagated to the normal stage order invalidation
-    invalidateStageOrder();
+    // Stages added during a transaction take part in it
+    setTransactionPipeline(stage, transactionPipeline());
+
+    // Dependencies of the new stage are computed on next sort
+    invalidateStageDependencies(stage);
 
     // Emit signal
     stageAdded(stage);
@@ -118,15 +130,32 @@ bool Pipeline::removeStage(Stage * stage)
     m_stages.erase(it);
     m_stagesMap.erase(stage->name());
 
-    cppassist::debug(1, "gloperate") << stage->qualifiedName() << ": remove from pipeline";
+    GLOPERATE_DEBUG(1) << stage->qualifiedName() << ": remove from pipeline";
+
+    // Drop deferred notifications, as the stage may be destroyed
+    if (Pipeline * pipeline = transactionPipeline())
+    {
+        pipeline->discardDeferred(stage);
+        setTransactionPipeline(stage, nullptr);
+    }
 
     stageRemoved(stage);
 
     removeProperty(stage);
 
-    // [TODO]
-    // Shouldn't be required if each slot of a stage would disconnect from connections
-    // and this would be propagated to the normal stage order invalidation
+    // Forget dependencies of the removed stage and of all stages that depend on it
+    m_dependencies.erase(stage);
+    m_dirtyDependencies.erase(stage);
+    m_renderTargetLifetimes.erase(stage);
+
+    for (auto & dependencies : m_dependencies)
+    {
+        if (std::find(dependencies.second.begin(), dependencies.second.end(), stage) != dependencies.second.end())
+        {
+            m_dirtyDependencies.insert(dependencies.first);
+        }
+    }
+
     invalidateStageOrder();
 
     return true;
@@ -134,84 +163,299 @@ bool Pipeline::removeStage(Stage * stage)
 
 void Pipeline::invalidateStageOrder()
 {
-    cppassist::debug(1, "gloperate") << this->name() << ": invalidate stage order; resort on next process";
+    GLOPERATE_DEBUG(1) << this->name() << ": invalidate stage order; resort on next process";
     m_sorted = false;
 }
 
+void Pipeline::invalidateStageDependencies(Stage * stage)
+{
+    assert(stage);
+
+    m_dirtyDependencies.insert(stage);
+    invalidateStageOrder();
+}
+
 bool Pipeline::isPipeline() const
 {
     return true;
 }
 
-void Pipeline::sortStages()
+bool Pipeline::renderTargetLifetime(Stage * stage, size_t & first, size_t & last)
 {
-    cppassist::debug("gloperate") << this->qualifiedName() << ": sort stages";
+    assert(stage);
 
-    auto couldBeSorted = true;
-    std::vector<Stage *> sorted;
-    std::set<Stage *> touched;
+    if (!m_sorted)
+    {
+        return false;
+    }
+
+    const auto escaped = std::numeric_limits<size_t>::max();
 
-    std::function<void(Stage *)> addSorted = [&](Stage * stage)
+    // Return cached lifetime
+    const auto cached = m_renderTargetLifetimes.find(stage);
+    if (cached != m_renderTargetLifetimes.end())
     {
-        m_stages.erase(find(m_stages.begin(), m_stages.end(), stage));
-        sorted.push_back(stage);
+        first = cached->second.first;
+        last  = cached->second.second;
+
+        return last != escaped;
+    }
+
+    const auto it = std::find(m_stages.begin(), m_stages.end(), stage);
+    if (it == m_stages.end())
+    {
+        return false;
+    }
+
+    std::unordered_map<const Stage *, size_t> indices;
+    indices.reserve(m_stages.size());
+
+    for (size_t i = 0; i < m_stages.size(); ++i)
+    {
+        indices[m_stages[i]] = i;
+    }
+
+    const auto passesRenderTarget = [] (const AbstractSlot * slot)
+    {
+        return dynamic_cast<const Output<ColorRenderTarget *> *>(slot)        != nullptr
+            || dynamic_cast<const Output<DepthRenderTarget *> *>(slot)        != nullptr
+            || dynamic_cast<const Output<DepthStencilRenderTarget *> *>(slot) != nullptr
+            || dynamic_cast<const Output<StencilRenderTarget *> *>(slot)      != nullptr
+            || dynamic_cast<const Output<globjects::Texture *> *>(slot)       != nullptr;
     };
 
-    std::function<void(Stage *)> visit = [&](Stage * stage)
+    // The producing stage only allocates the render targets, so their contents
+    // are used from the first stage that writes or reads them. Consumers are
+    // sorted after the producer, so an unused render target keeps its index.
+    const auto own = indices[stage];
+
+    first = escaped;
+    last  = own;
+
+    // Follow render targets from the stage to all stages that read them
+    std::vector<const AbstractSlot *>        pending;
+    std::unordered_set<const AbstractSlot *> visited;
+
+    for (auto output : stage->outputs())
     {
-        if (!couldBeSorted)
+        if (passesRenderTarget(output))
         {
-            addSorted(stage);
-            return;
+            pending.push_back(output);
         }
+    }
 
-        if (touched.count(stage) > 0)
+    while (!pending.empty() && last != escaped)
+    {
+        const auto slot = pending.back();
+        pending.pop_back();
+
+        if (!visited.insert(slot).second)
         {
-            cppassist::critical() << "Pipeline is not a directed acyclic graph";
-            couldBeSorted = false;
-            return;
+            continue;
         }
 
-        touched.insert(stage);
+        // Render targets passed out of the pipeline are used after this pipeline
+        for (auto output : outputs())
+        {
+            if (output->source() == slot)
+            {
+                last = escaped;
+            }
+        }
 
-        for (auto stageIt = m_stages.begin(); stageIt != m_stages.end(); /* nop */)
+        for (auto consumer : m_stages)
         {
-            if (!stage->requires(*stageIt, false))
+            for (auto input : consumer->inputs())
             {
-                ++stageIt;
-                continue;
+                if (input->source() != slot)
+                {
+                    continue;
+                }
+
+                // Feedback inputs read the render targets in the next frame
+                if (input->isFeedback())
+                {
+                    last = escaped;
+                }
+
+                // Shared textures are overwritten by other owners, so stages that
+                // skip a frame would leave the contents of another render target
+                if (!consumer->alwaysProcessed())
+                {
+                    last = escaped;
+                }
+
+                first = std::min(first, indices[consumer]);
+                last  = std::max(last,  indices[consumer]);
+
+                for (auto output : consumer->outputs())
+                {
+                    if (passesRenderTarget(output))
+                    {
+                        pending.push_back(output);
+                    }
+                }
             }
+        }
+    }
+
+    if (first == escaped)
+    {
+        first = own;
+    }
+
+    m_renderTargetLifetimes[stage] = std::make_pair(first, last);
 
-            auto nextStage = *stageIt;
-            visit(nextStage);
+    GLOPERATE_DEBUG(2) << stage->qualifiedName() << ": render target lifetime " << first << " - " << (last == escaped ? std::string("escaped") : std::to_string(last));
+
+    return last != escaped;
+}
+
+void Pipeline::sortStages()
+{
+    GLOPERATE_DEBUG(0) << this->qualifiedName() << ": sort stages";
 
-            if (!couldBeSorted)
+    // Update cached dependencies of stages whose connections have changed
+    for (auto stage : m_dirtyDependencies)
+    {
+        updateStageDependencies(stage);
+    }
+
+    m_dirtyDependencies.clear();
+
+    // Count dependencies and collect dependent stages (Kahn's algorithm)
+    std::unordered_map<Stage *, size_t>               inDegree;
+    std::unordered_map<Stage *, std::vector<Stage *>> dependents;
+
+    inDegree.reserve(m_stages.size());
+    dependents.reserve(m_stages.size());
+
+    for (auto stage : m_stages)
+    {
+        inDegree[stage] = 0;
+    }
+
+    for (auto stage : m_stages)
+    {
+        for (auto dependency : m_dependencies[stage])
+        {
+            inDegree[stage]++;
+            dependents[dependency].push_back(stage);
+        }
+    }
+
+    // Start with stages without dependencies, keeping their original order
+    std::deque<Stage *> ready;
+    for (auto stage : m_stages)
+    {
+        if (inDegree[stage] == 0)
+        {
+            ready.push_back(stage);
+        }
+    }
+
+    std::vector<Stage *> sorted;
+    sorted.reserve(m_stages.size());
+
+    while (!ready.empty())
+    {
+        auto stage = ready.front();
+        ready.pop_front();
+
+        sorted.push_back(stage);
+
+        for (auto dependent : dependents[stage])
+        {
+            if (--inDegree[dependent] == 0)
             {
-                addSorted(stage);
-                return;
+                ready.push_back(dependent);
             }
-
-            stageIt = m_stages.begin();
         }
+    }
 
-        addSorted(stage);
-    };
+    // Stages that could not be sorted are part of or depend on a cycle
+    const auto couldBeSorted = sorted.size() == m_stages.size();
 
-    while (!m_stages.empty())
+    if (!couldBeSorted)
     {
-        auto stageIt = m_stages.begin();
-        auto stage = *stageIt;
-        visit(stage);
+        // Follow unresolved dependencies until a stage repeats to find one cycle
+        auto stage = *std::find_if(m_stages.begin(), m_stages.end(), [&inDegree] (Stage * candidate)
+        {
+            return inDegree[candidate] > 0;
+        });
+
+        std::vector<Stage *> path;
+        std::unordered_map<Stage *, size_t> pathIndex;
+
+        while (pathIndex.count(stage) == 0)
+        {
+            pathIndex[stage] = path.size();
+            path.push_back(stage);
+
+            const auto & dependencies = m_dependencies[stage];
+            stage = *std::find_if(dependencies.begin(), dependencies.end(), [&inDegree] (Stage * dependency)
+            {
+                return inDegree[dependency] > 0;
+            });
+        }
+
+        std::stringstream cycle;
+        for (auto i = pathIndex[stage]; i < path.size(); ++i)
+        {
+            cycle << path[i]->qualifiedName() << " -> ";
+        }
+        cycle << stage->qualifiedName();
+
+        cppassist::critical() << "Pipeline is not a directed acyclic graph (cycle: " << cycle.str() << ")";
+
+        // Append the remaining stages in their previous order
+        for (auto remaining : m_stages)
+        {
+            if (inDegree[remaining] > 0)
+            {
+                sorted.push_back(remaining);
+            }
+        }
     }
 
-    cppassist::debug(2, "gloperate") << "Stage order after sorting";
+    GLOPERATE_DEBUG(2) << "Stage order after sorting";
     for (const auto stage : sorted)
     {
-        cppassist::debug(2, "gloperate") << stage->qualifiedName();
+        GLOPERATE_DEBUG(2) << stage->qualifiedName();
     }
 
     m_stages = sorted;
     m_sorted = couldBeSorted;
+
+    // Stages that use render target lifetimes have to acquire their render targets again
+    for (const auto & lifetime : m_renderTargetLifetimes)
+    {
+        lifetime.first->invalidateOutputs();
+    }
+
+    m_renderTargetLifetimes.clear();
+}
+
+void Pipeline::updateStageDependencies(Stage * stage)
+{
+    auto & dependencies = m_dependencies[stage];
+    dependencies.clear();
+
+    for (auto slot : stage->inputs())
+    {
+        if (slot->isFeedback() || !slot->isConnected())
+            continue;
+
+        // Only sibling stages within this pipeline impose an order
+        auto sourceStage = slot->source()->parentStage();
+        if (!sourceStage || sourceStage == stage || sourceStage->parentPipeline() != this)
+            continue;
+
+        if (std::find(dependencies.begin(), dependencies.end(), sourceStage) == dependencies.end())
+        {
+            dependencies.push_back(sourceStage);
+        }
+    }
 }
 
 void Pipeline::onContextInit(AbstractGLContext * context)
@@ -236,6 +480,27 @@ void Pipeline::onProcess()
         sortStages();
     }
 
+    // Use worker threads only for valid stage orders with CPU-only stages,
+    // and never from a worker itself, as waiting there could exhaust the pool
+    const auto threadPool = m_environment->threadPool();
+    const auto concurrent = m_sorted && threadPool->numThreads() > 0 && !ThreadPool::isWorkerThread() &&
+        std::any_of(m_stages.begin(), m_stages.end(), [] (Stage * stage)
+        {
+            return stage->cpuOnly();
+        });
+
+    if (concurrent)
+    {
+        processStagesConcurrently();
+    }
+    else
+    {
+        processStagesSerially();
+    }
+}
+
+void Pipeline::processStagesSerially()
+{
     for (auto stage : m_stages)
     {
         if (stage->needsProcessing()) {
@@ -243,9 +508,400 @@ void Pipeline::onProcess()
         }
         else
         {
-            cppassist::debug(2, "gloperate") << stage->qualifiedName() << ": omit execution";
+            GLOPERATE_DEBUG(2) << stage->qualifiedName() << ": omit execution";
+        }
+    }
+}
+
+void Pipeline::processStagesConcurrently()
+{
+    // Count unfinished dependencies and collect dependent stages
+    std::unordered_map<Stage *, size_t>               pending;
+    std::unordered_map<Stage *, std::vector<Stage *>> dependents;
+
+    for (auto stage : m_stages)
+    {
+        const auto & dependencies = m_dependencies[stage];
+
+        pending[stage] = dependencies.size();
+        for (auto dependency : dependencies)
+        {
+            dependents[dependency].push_back(stage);
+        }
+    }
+
+    // Feedback connections impose no order, so both of their stages
+    // may be busy at the same time. Keep them on the context thread.
+    std::unordered_set<Stage *> feedbackStages;
+    for (auto stage : m_stages)
+    {
+        for (auto input : stage->inputs())
+        {
+            if (!input->isFeedback() || !input->isConnected())
+            {
+                continue;
+            }
+
+            feedbackStages.insert(stage);
+            feedbackStages.insert(input->source()->parentStage());
+        }
+    }
+
+    const auto runsOnWorker = [&feedbackStages] (Stage * stage)
+    {
+        return stage->cpuOnly() && feedbackStages.count(stage) == 0;
+    };
+
+    // Stages whose dependencies have finished, in sorted order
+    std::deque<Stage *> ready;
+    for (auto stage : m_stages)
+    {
+        if (pending[stage] == 0)
+        {
+            ready.push_back(stage);
         }
     }
+
+    // Stages finished by worker threads. The state is shared with the
+    // tasks, as a worker may still hold it when the last stage is collected.
+    struct WorkerState
+    {
+        std::mutex              mutex;
+        std::condition_variable condition;
+        std::vector<Stage *>    finished;
+        std::exception_ptr      exception; ///< First exception thrown by a worker stage
+    };
+
+    const auto state = std::make_shared<WorkerState>();
+
+    size_t numFinished = 0;
+    size_t numRunning  = 0;
+
+    const auto finish = [&] (Stage * stage)
+    {
+        numFinished++;
+
+        for (auto dependent : dependents[stage])
+        {
+            if (--pending[dependent] == 0)
+            {
+                ready.push_back(dependent);
+            }
+        }
+    };
+
+    while (numFinished < m_stages.size())
+    {
+        // Start ready worker stages first, so they run while the context thread is busy
+        std::stable_partition(ready.begin(), ready.end(), runsOnWorker);
+
+        if (!ready.empty())
+        {
+            auto stage = ready.front();
+            ready.pop_front();
+
+            if (!stage->needsProcessing())
+            {
+                GLOPERATE_DEBUG(2) << stage->qualifiedName() << ": omit execution";
+                finish(stage);
+            }
+            else if (runsOnWorker(stage))
+            {
+                numRunning++;
+
+                // Connected stages are notified on this thread once the stage has finished
+                stage->m_deferOutputs = true;
+
+                m_environment->threadPool()->submit([stage, state] ()
+                {
+                    std::exception_ptr exception;
+
+                    try
+                    {
+                        stage->process();
+                    }
+                    catch (...)
+                    {
+                        exception = std::current_exception();
+                    }
+
+                    // The stage is reported as finished in any case, so the context thread never waits for it in vain
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->finished.push_back(stage);
+                    if (exception && !state->exception)
+                    {
+                        state->exception = exception;
+                    }
+                    state->condition.notify_one();
+                });
+            }
+            else
+            {
+                stage->process();
+                finish(stage);
+            }
+        }
+
+        // Collect finished stages, wait for them if there is nothing else to do
+        std::vector<Stage *> finishedStages;
+        std::exception_ptr   exception;
+
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+
+            if (ready.empty() && numRunning > 0)
+            {
+                state->condition.wait(lock, [&state] ()
+                {
+                    return !state->finished.empty();
+                });
+            }
+
+            finishedStages.swap(state->finished);
+            exception = state->exception;
+        }
+
+        for (auto stage : finishedStages)
+        {
+            numRunning--;
+
+            stage->promoteDeferredOutputs();
+            finish(stage);
+        }
+
+        // Abort on the first failed worker stage. Stages that are still running
+        // are waited for, as they must not outlive the processing of the pipeline.
+        if (exception)
+        {
+            while (numRunning > 0)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(state->mutex);
+
+                    state->condition.wait(lock, [&state] ()
+                    {
+                        return !state->finished.empty();
+                    });
+
+                    finishedStages.clear();
+                    finishedStages.swap(state->finished);
+                }
+
+                for (auto stage : finishedStages)
+                {
+                    numRunning--;
+
+                    stage->promoteDeferredOutputs();
+                }
+            }
+
+            std::rethrow_exception(exception);
+        }
+    }
+}
+
+void Pipeline::beginTransaction()
+{
+    Pipeline * pipeline = outermostPipeline();
+
+    // Assign the pipeline to all stages, so they find it without walking up the hierarchy
+    if (pipeline->m_transactionDepth++ == 0)
+    {
+        setTransactionPipeline(pipeline, pipeline);
+    }
+
+    GLOPERATE_DEBUG(2) << pipeline->qualifiedName() << ": begin transaction (depth " << pipeline->m_transactionDepth << ")";
+}
+
+void Pipeline::commitTransaction()
+{
+    Pipeline * pipeline = outermostPipeline();
+
+    assert(pipeline->m_transactionDepth > 0);
+
+    if (pipeline->m_transactionDepth == 0)
+    {
+        return;
+    }
+
+    // Deliver notifications only when the outermost transaction is committed
+    if (pipeline->m_transactionDepth == 1)
+    {
+        pipeline->flushTransaction();
+    }
+
+    if (--pipeline->m_transactionDepth == 0)
+    {
+        setTransactionPipeline(pipeline, nullptr);
+    }
+}
+
+bool Pipeline::inTransaction() const
+{
+    return transactionPipeline() != nullptr;
+}
+
+Pipeline * Pipeline::outermostPipeline()
+{
+    Pipeline * pipeline = this;
+    while (Pipeline * parent = pipeline->parentPipeline())
+    {
+        pipeline = parent;
+    }
+
+    return pipeline;
+}
+
+void Pipeline::deferInputValueChanged(Stage * stage, AbstractSlot * slot)
+{
+    assert(stage);
+    assert(slot);
+
+    if (m_deferredInputSet.insert(slot).second)
+    {
+        m_deferredInputs.push_back(std::make_pair(stage, slot));
+    }
+}
+
+void Pipeline::deferInvalidateOutputs(Stage * stage)
+{
+    assert(stage);
+
+    if (m_deferredStageSet.insert(stage).second)
+    {
+        m_deferredStages.push_back(stage);
+    }
+}
+
+void Pipeline::discardDeferred(Stage * stage)
+{
+    assert(stage);
+
+    // Check if a stage is the given stage or one of its substages
+    const auto isRemoved = [stage] (const Stage * candidate)
+    {
+        for (auto current = candidate; current; current = current->parentPipeline())
+        {
+            if (current == stage)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    // Entries are cleared instead of erased, as the lists may be processed at the moment
+    for (auto & input : m_deferredInputs)
+    {
+        if (input.first && isRemoved(input.first))
+        {
+            m_deferredInputSet.erase(input.second);
+            input = std::make_pair(nullptr, nullptr);
+        }
+    }
+
+    for (auto & candidate : m_deferredStages)
+    {
+        if (candidate && isRemoved(candidate))
+        {
+            m_deferredStageSet.erase(candidate);
+            candidate = nullptr;
+        }
+    }
+}
+
+void Pipeline::discardDeferred(AbstractSlot * slot)
+{
+    assert(slot);
+
+    // Inputs that have already been delivered are not contained in the set anymore
+    if (m_deferredInputSet.erase(slot) == 0)
+    {
+        return;
+    }
+
+    for (auto & input : m_deferredInputs)
+    {
+        if (input.second == slot)
+        {
+            input = std::make_pair(nullptr, nullptr);
+        }
+    }
+}
+
+void Pipeline::setTransactionPipeline(Stage * stage, Pipeline * pipeline)
+{
+    assert(stage);
+
+    stage->m_transactionPipeline = pipeline;
+
+    if (stage->isPipeline())
+    {
+        for (auto substage : static_cast<Pipeline *>(stage)->stages())
+        {
+            setTransactionPipeline(substage, pipeline);
+        }
+    }
+}
+
+void Pipeline::flushTransaction()
+{
+    GLOPERATE_DEBUG(2) << this->qualifiedName() << ": commit transaction (" << m_deferredInputs.size() << " changed inputs)";
+
+    // Both lists grow while they are processed: handlers may change further
+    // inputs, and invalidating outputs reaches the stages downstream, whose
+    // invalidateOutputs() only appends them to the list instead of recursing.
+    // Thereby, each affected stage is invalidated exactly once.
+    size_t numInputs = 0;
+    size_t numStages = 0;
+
+    while (numInputs < m_deferredInputs.size() || numStages < m_deferredStages.size())
+    {
+        // Notify stages about changed inputs
+        for (; numInputs < m_deferredInputs.size(); numInputs++)
+        {
+            const auto input = m_deferredInputs[numInputs];
+
+            // Skip inputs of removed stages
+            if (!input.first)
+            {
+                continue;
+            }
+
+            // Inputs that change again after this point are delivered again
+            m_deferredInputSet.erase(input.second);
+
+            input.first->inputChanged(input.second);
+            input.first->onInputValueChanged(input.second);
+        }
+
+        // Invalidate outputs of affected stages
+        for (; numStages < m_deferredStages.size(); numStages++)
+        {
+            const auto stage = m_deferredStages[numStages];
+
+            // Skip removed stages
+            if (!stage)
+            {
+                continue;
+            }
+
+            GLOPERATE_DEBUG(3) << stage->qualifiedName() << ": invalidateOutputs";
+
+            for (auto output : stage->outputs())
+            {
+                output->invalidate();
+            }
+        }
+    }
+
+    GLOPERATE_DEBUG(2) << this->qualifiedName() << ": invalidated " << m_deferredStages.size() << " stages";
+
+    m_deferredInputs.clear();
+    m_deferredInputSet.clear();
+    m_deferredStages.clear();
+    m_deferredStageSet.clear();
 }
 
 void Pipeline::onInputValueChanged(AbstractSlot *)
@@ -2,6 +2,7 @@
 #include <gloperate/pipeline/Stage.h>
 
 #include <algorithm>
+#include <chrono>
 
 #include <cppassist/string/conversion.h>
 #include <cppassist/logging/logging.h>
@@ -14,19 +15,14 @@
 #include <globjects/Framebuffer.h>
 
 #include <gloperate/base/ExtendedProperties.h>
+#include <gloperate/base/logging.h>
 #include <gloperate/pipeline/Pipeline.h>
 #include <gloperate/pipeline/AbstractSlot.h>
 
 
 namespace
 {
-    enum Query
-    {
-        PairOneStart = 0,
-        PairOneEnd = 1,
-        PairTwoStart = 2,
-        PairTwoEnd = 3
-    };
+    const unsigned int defaultTimeQueryCount = 3;
 }
 
 
@@ -50,11 +46,16 @@ Stage::Stage(Environment * environment, const std::string & className, const std
 : cppexpose::Object((name.empty()) ? className : name)
 , m_environment(environment)
 , m_alwaysProcess(false)
+, m_cpuOnly(false)
+, m_deferOutputs(false)
+, m_deferredTiming(false)
+, m_transactionPipeline(nullptr)
 , m_timeMeasurement(false)
-, m_useQueryPairOne(true)
-, m_resultAvailable(false)
+, m_timeQueryCount(defaultTimeQueryCount)
+, m_oldestTimeQuery(0)
+, m_pendingTimeQueries(0)
+, m_processIndex(0)
 , m_lastCPUDuration(0)
-, m_currentCPUDuration(0)
 , m_lastGPUDuration(0)
 {
     // Set object class name
@@ -105,74 +106,99 @@ bool Stage::requires(const Stage * stage, bool recursive) const
 
 void Stage::initContext(AbstractGLContext * context)
 {
-    cppassist::debug(2, "gloperate") << this->qualifiedName() << ": initContext";
+    GLOPERATE_DEBUG(2) << this->qualifiedName() << ": initContext";
 
     // Create time queries
-    gl::glGenQueries(4, m_queries.data());
-
-    // Dummy querys for first frame
-    if (m_useQueryPairOne)
-    {
-        gl::glQueryCounter(m_queries[Query::PairOneStart], gl::GL_TIMESTAMP);
-        gl::glQueryCounter(m_queries[Query::PairOneEnd], gl::GL_TIMESTAMP);
-    }
-    else
-    {
-        gl::glQueryCounter(m_queries[Query::PairTwoStart], gl::GL_TIMESTAMP);
-        gl::glQueryCounter(m_queries[Query::PairTwoEnd], gl::GL_TIMESTAMP);
-    }
+    createTimeQueries();
 
     onContextInit(context);
 }
 
 void Stage::deinitContext(AbstractGLContext * context)
 {
-    cppassist::debug(2, "gloperate") << this->qualifiedName() << ": deinitContex";
+    GLOPERATE_DEBUG(2) << this->qualifiedName() << ": deinitContex";
     onContextDeinit(context);
+
+    // Release time queries
+    destroyTimeQueries();
 }
 
 void Stage::process()
 {
-    cppassist::debug(1, "gloperate") << this->qualifiedName() << ": processing";
+    GLOPERATE_DEBUG(1) << this->qualifiedName() << ": processing";
 
-    if (m_timeMeasurement)
+    if (m_timeMeasurement && m_cpuOnly)
     {
-        // Get currently used queries
-        auto usedStartQuery   = m_useQueryPairOne ? Query::PairOneStart : Query::PairTwoStart;
-        auto usedEndQuery     = m_useQueryPairOne ? Query::PairOneEnd   : Query::PairTwoEnd;
-        auto unusedStartQuery = m_useQueryPairOne ? Query::PairTwoStart : Query::PairOneStart;
-        auto unusedEndQuery   = m_useQueryPairOne ? Query::PairTwoEnd   : Query::PairOneEnd;
+        // CPU-only stages may run without context, so only measure CPU time
+        auto cpu_start = std::chrono::high_resolution_clock::now();
+
+        onProcess();
+
+        auto cpu_end = std::chrono::high_resolution_clock::now();
+        m_lastCPUDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(cpu_end - cpu_start).count();
+        m_lastGPUDuration = 0;
+
+        // Emit measured times, or hold them back until the stage is collected on the context thread
+        if (m_deferOutputs)
+        {
+            m_deferredTiming = true;
+        }
+        else
+        {
+            timeMeasured(m_processIndex, m_lastCPUDuration, m_lastGPUDuration);
+        }
+
+        m_processIndex++;
+    }
+    else if (m_timeMeasurement)
+    {
+        // Recreate time queries if the query count has changed
+        if (m_timeQueries.size() != m_timeQueryCount)
+        {
+            destroyTimeQueries();
+            createTimeQueries();
+        }
+
+        // Report measurements of previous frames that are finished by now
+        collectTimeMeasurements();
+
+        // Measure GPU time only if a query pair is free, never wait for one
+        TimeQuery * timeQuery = nullptr;
+        if (m_pendingTimeQueries < m_timeQueries.size())
+        {
+            timeQuery = &m_timeQueries[(m_oldestTimeQuery + m_pendingTimeQueries) % m_timeQueries.size()];
+        }
+        else
+        {
+            GLOPERATE_DEBUG(3) << this->qualifiedName() << ": all time queries pending, skipping GPU measurement";
+        }
 
         // Start CPU time measurement
         auto cpu_start = std::chrono::high_resolution_clock::now();
 
         // Start GPU time measurement
-        gl::glQueryCounter(m_queries[unusedStartQuery], gl::GL_TIMESTAMP);
+        if (timeQuery)
+        {
+            gl::glQueryCounter(timeQuery->startQuery, gl::GL_TIMESTAMP);
+        }
 
         // Execute stage
         onProcess();
 
         // Stop CPU time measurement
         auto cpu_end = std::chrono::high_resolution_clock::now();
-        m_lastCPUDuration = m_currentCPUDuration;
-        m_currentCPUDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(cpu_end - cpu_start).count();
 
         // Stop GPU time measurement
-        gl::glQueryCounter(m_queries[unusedEndQuery], gl::GL_TIMESTAMP);
-
-        // Get GPU values from last frame
-        gl::GLuint64 gpu_start, gpu_end;
-        gl::glGetQueryObjectui64v(m_queries[usedStartQuery], gl::GL_QUERY_RESULT, &gpu_start);
-        gl::glGetQueryObjectui64v(m_queries[usedEndQuery], gl::GL_QUERY_RESULT, &gpu_end);
-        m_lastGPUDuration = gpu_end - gpu_start;
+        if (timeQuery)
+        {
+            gl::glQueryCounter(timeQuery->endQuery, gl::GL_TIMESTAMP);
 
-        // Switch queries for next frame
-        m_useQueryPairOne = !m_useQueryPairOne;
+            timeQuery->processIndex = m_processIndex;
+            timeQuery->cpuDuration  = std::chrono::duration_cast<std::chrono::nanoseconds>(cpu_end - cpu_start).count();
+            m_pendingTimeQueries++;
+        }
 
-        // Emit measured times
-        if (m_resultAvailable) {
-            timeMeasured(m_lastCPUDuration, m_lastGPUDuration);
-        } else m_resultAvailable = true;
+        m_processIndex++;
     }
     else
     {
@@ -188,19 +214,19 @@ void Stage::process()
 bool Stage::needsProcessing() const
 {
     if (m_alwaysProcess) {
-        cppassist::debug(4, "gloperate") << this->qualifiedName() << ": needs processing because it is always processed";
+        GLOPERATE_DEBUG(4) << this->qualifiedName() << ": needs processing because it is always processed";
         return true;
     }
 
     for (auto output : m_outputs)
     {
         if (output->isRequired() && !output->isValid()) {
-            cppassist::debug(4, "gloperate") << this->qualifiedName() << ": needs processing because output is invalid and required (" << output->qualifiedName()<< ")";
+            GLOPERATE_DEBUG(4) << this->qualifiedName() << ": needs processing because output is invalid and required (" << output->qualifiedName()<< ")";
             return true;
         }
     }
 
-    cppassist::debug(4, "gloperate") << this->qualifiedName() << ": needs no processing";
+    GLOPERATE_DEBUG(4) << this->qualifiedName() << ": needs no processing";
     return false;
 }
 
@@ -211,13 +237,43 @@ bool Stage::alwaysProcessed() const
 
 void Stage::setAlwaysProcessed(bool alwaysProcess)
 {
-    cppassist::debug(2, "gloperate") << this->qualifiedName() << ": set always processed to " << alwaysProcess;
+    GLOPERATE_DEBUG(2) << this->qualifiedName() << ": set always processed to " << alwaysProcess;
+
+    if (m_alwaysProcess == alwaysProcess)
+    {
+        return;
+    }
+
     m_alwaysProcess = alwaysProcess;
+
+    // Render target lifetimes depend on this flag and are recomputed on resort
+    if (Pipeline * parent = parentPipeline())
+    {
+        parent->invalidateStageOrder();
+    }
+}
+
+bool Stage::cpuOnly() const
+{
+    return m_cpuOnly;
+}
+
+void Stage::setCPUOnly(bool cpuOnly)
+{
+    GLOPERATE_DEBUG(2) << this->qualifiedName() << ": set CPU-only to " << cpuOnly;
+    m_cpuOnly = cpuOnly;
 }
 
 void Stage::invalidateOutputs()
 {
-    cppassist::debug(3, "gloperate") << this->qualifiedName() << ": invalidateOutputs";
+    // Defer invalidation until the transaction is committed
+    if (Pipeline * pipeline = transactionPipeline())
+    {
+        pipeline->deferInvalidateOutputs(this);
+        return;
+    }
+
+    GLOPERATE_DEBUG(3) << this->qualifiedName() << ": invalidateOutputs";
 
     for (auto output : m_outputs)
     {
@@ -347,7 +403,7 @@ void Stage::registerInput(AbstractSlot * input)
         m_inputsMap.insert(std::make_pair(input->name(), input));
     }
 
-    cppassist::debug(2, "gloperate") << input->qualifiedName() << ": add input to stage";
+    GLOPERATE_DEBUG(2) << input->qualifiedName() << ": add input to stage";
 
     // Emit signal
     inputAdded(input);
@@ -359,7 +415,13 @@ void Stage::removeInput(AbstractSlot * input)
     auto it = std::find(m_inputs.begin(), m_inputs.end(), input);
     if (it != m_inputs.end())
     {
-        cppassist::debug(2, "gloperate") << input->qualifiedName() << ": remove input from stage";
+        GLOPERATE_DEBUG(2) << input->qualifiedName() << ": remove input from stage";
+
+        // Drop deferred notification, as the input may be destroyed
+        if (Pipeline * pipeline = transactionPipeline())
+        {
+            pipeline->discardDeferred(input);
+        }
 
         // Remove input
         m_inputs.erase(it);
@@ -437,7 +499,7 @@ void Stage::registerOutput(AbstractSlot * output)
         m_outputsMap.insert(std::make_pair(output->name(), output));
     }
 
-    cppassist::debug(2, "gloperate") << output->qualifiedName() << ": add output to stage";
+    GLOPERATE_DEBUG(2) << output->qualifiedName() << ": add output to stage";
 
     // Emit signal
     outputAdded(output);
@@ -449,7 +511,10 @@ void Stage::removeOutput(AbstractSlot * output)
     auto it = std::find(m_outputs.begin(), m_outputs.end(), output);
     if (it != m_outputs.end())
     {
-        cppassist::debug(2, "gloperate") << output->qualifiedName() << ": remove output from stage";
+        GLOPERATE_DEBUG(2) << output->qualifiedName() << ": remove output from stage";
+
+        // Drop held back notification, as the output may be destroyed
+        m_deferredOutputs.erase(std::remove(m_deferredOutputs.begin(), m_deferredOutputs.end(), output), m_deferredOutputs.end());
 
         // Remove output
         m_outputs.erase(it);
@@ -465,12 +530,19 @@ void Stage::removeOutput(AbstractSlot * output)
 
 void Stage::outputRequiredChanged(AbstractSlot * slot)
 {
-    cppassist::debug(2, "gloperate") << this->qualifiedName() << ": output required changed for " << slot->qualifiedName();
+    GLOPERATE_DEBUG(2) << this->qualifiedName() << ": output required changed for " << slot->qualifiedName();
     onOutputRequiredChanged(slot);
 }
 
 void Stage::inputValueChanged(AbstractSlot * slot)
 {
+    // Defer notification until the transaction is committed
+    if (Pipeline * pipeline = transactionPipeline())
+    {
+        pipeline->deferInputValueChanged(this, slot);
+        return;
+    }
+
     inputChanged(slot);
 
     onInputValueChanged(slot);
@@ -486,6 +558,21 @@ void Stage::inputOptionsChanged(AbstractSlot * slot)
     inputChanged(slot);
 }
 
+bool Stage::deferOutputNotification(AbstractSlot * output)
+{
+    if (!m_deferOutputs)
+    {
+        return false;
+    }
+
+    if (std::find(m_deferredOutputs.begin(), m_deferredOutputs.end(), output) == m_deferredOutputs.end())
+    {
+        m_deferredOutputs.push_back(output);
+    }
+
+    return true;
+}
+
 std::string Stage::getFreeName(const std::string & name) const
 {
     std::string nameOut = name;
@@ -584,7 +671,7 @@ void Stage::invalidateInputConnections()
 {
     if (parentPipeline())
     {
-        parentPipeline()->invalidateStageOrder();
+        parentPipeline()->invalidateStageDependencies(this);
     }
 }
 
@@ -622,11 +709,123 @@ bool Stage::timeMeasurement() const
 void Stage::setTimeMeasurement(bool enabled, bool)
 {
     m_timeMeasurement    = enabled;
-    m_resultAvailable    = false;
-    m_currentCPUDuration = 0;
+    m_oldestTimeQuery    = 0;
+    m_pendingTimeQueries = 0;
+    m_processIndex       = 0;
     m_lastCPUDuration    = 0;
     m_lastGPUDuration    = 0;
 }
 
+unsigned int Stage::timeMeasurementQueryCount() const
+{
+    return m_timeQueryCount;
+}
+
+void Stage::setTimeMeasurementQueryCount(unsigned int count)
+{
+    assert(count > 0);
+
+    // Query objects are recreated on the next process() with an active context
+    m_timeQueryCount     = count;
+    m_oldestTimeQuery    = 0;
+    m_pendingTimeQueries = 0;
+    m_lastCPUDuration    = 0;
+    m_lastGPUDuration    = 0;
+}
+
+void Stage::createTimeQueries()
+{
+    std::vector<gl::GLuint> queries(2 * m_timeQueryCount);
+    gl::glGenQueries(static_cast<gl::GLsizei>(queries.size()), queries.data());
+
+    m_timeQueries.resize(m_timeQueryCount);
+    for (size_t i = 0; i < m_timeQueries.size(); ++i)
+    {
+        m_timeQueries[i].startQuery   = queries[2 * i];
+        m_timeQueries[i].endQuery     = queries[2 * i + 1];
+        m_timeQueries[i].processIndex = 0;
+        m_timeQueries[i].cpuDuration  = 0;
+    }
+
+    m_oldestTimeQuery    = 0;
+    m_pendingTimeQueries = 0;
+}
+
+void Stage::destroyTimeQueries()
+{
+    for (const auto & timeQuery : m_timeQueries)
+    {
+        gl::glDeleteQueries(1, &timeQuery.startQuery);
+        gl::glDeleteQueries(1, &timeQuery.endQuery);
+    }
+
+    m_timeQueries.clear();
+    m_oldestTimeQuery    = 0;
+    m_pendingTimeQueries = 0;
+}
+
+void Stage::collectTimeMeasurements()
+{
+    // Results become available in the order the queries were issued
+    while (m_pendingTimeQueries > 0)
+    {
+        const auto & timeQuery = m_timeQueries[m_oldestTimeQuery];
+
+        gl::GLuint available = 0;
+        gl::glGetQueryObjectuiv(timeQuery.endQuery, gl::GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+        {
+            break;
+        }
+
+        // The start query precedes the end query, so reading both does not stall
+        gl::GLuint64 gpu_start, gpu_end;
+        gl::glGetQueryObjectui64v(timeQuery.startQuery, gl::GL_QUERY_RESULT, &gpu_start);
+        gl::glGetQueryObjectui64v(timeQuery.endQuery, gl::GL_QUERY_RESULT, &gpu_end);
+
+        const auto processIndex = timeQuery.processIndex;
+        m_lastCPUDuration       = timeQuery.cpuDuration;
+        m_lastGPUDuration       = gpu_end - gpu_start;
+
+        m_oldestTimeQuery = (m_oldestTimeQuery + 1) % m_timeQueries.size();
+        m_pendingTimeQueries--;
+
+        // Emit measured times
+        timeMeasured(processIndex, m_lastCPUDuration, m_lastGPUDuration);
+    }
+}
+
+void Stage::promoteDeferredOutputs()
+{
+    m_deferOutputs = false;
+
+    std::vector<AbstractSlot *> outputs;
+    outputs.swap(m_deferredOutputs);
+
+    // Deliver the final state of each output only once
+    for (auto output : outputs)
+    {
+        if (output->isValid())
+        {
+            output->promoteValueChanged();
+        }
+        else
+        {
+            output->onValueInvalidated();
+        }
+    }
+
+    if (m_deferredTiming)
+    {
+        m_deferredTiming = false;
+        timeMeasured(m_processIndex - 1, m_lastCPUDuration, m_lastGPUDuration);
+    }
+}
+
+Pipeline * Stage::transactionPipeline() const
+{
+    return m_transactionPipeline;
+}
+
 
 } // namespace gloperate
@@ -9,6 +9,8 @@
 
 #include <globjects/Buffer.h>
 
+#include <gloperate/rendering/ShapeGeometryCache.h>
+
 
 namespace gloperate
 {
@@ -129,15 +131,17 @@ Box::Box(float width, float height, float depth, cppassist::Flags<ShapeOption> o
     m_drawable->setDrawMode(DrawMode::Arrays);
     m_drawable->setSize(36);
 
-    // Create vertex buffer
-    auto v = vertices;
+    // Get vertex buffer
+    m_vertices = ShapeGeometryCache::instance().buffer(ShapeType::Box, "vertices", glm::vec4(width, height, depth, 0.0f), [width, height, depth] (globjects::Buffer * buffer)
+    {
+        auto v = vertices;
 
-    for (auto & vertex : v) {
-        vertex *= glm::vec3(width, height, depth);
-    }
+        for (auto & vertex : v) {
+            vertex *= glm::vec3(width, height, depth);
+        }
 
-    m_vertices = cppassist::make_unique<globjects::Buffer>();
-    m_vertices->setData(v, gl::GL_STATIC_DRAW);
+        buffer->setData(v, gl::GL_STATIC_DRAW);
+    });
 
     m_drawable->bindAttribute(0, 0);
     m_drawable->setBuffer(0, m_vertices.get());
@@ -145,11 +149,13 @@ Box::Box(float width, float height, float depth, cppassist::Flags<ShapeOption> o
     m_drawable->setAttributeBindingFormat(0, 3, gl::GL_FLOAT, gl::GL_FALSE, 0);
     m_drawable->enableAttributeBinding(0);
 
-    // Create texture coordinate buffer
+    // Get texture coordinate buffer
     if (options & ShapeOption::IncludeTexCoords)
     {
-        m_texCoords = cppassist::make_unique<globjects::Buffer>();
-        m_texCoords->setData(texcoords, gl::GL_STATIC_DRAW);
+        m_texCoords = ShapeGeometryCache::instance().buffer(ShapeType::Box, "texcoords", glm::vec4(0.0f), [] (globjects::Buffer * buffer)
+        {
+            buffer->setData(texcoords, gl::GL_STATIC_DRAW);
+        });
 
         m_drawable->bindAttribute(1, 1);
         m_drawable->setBuffer(1, m_texCoords.get());
@@ -22,6 +22,10 @@ Drawable::Drawable()
 , m_primitiveMode(gl::GL_TRIANGLES)
 , m_indexBufferType(gl::GL_UNSIGNED_INT)
 , m_indexBuffer(nullptr)
+, m_instanceCount(1)
+, m_commandBuffer(nullptr)
+, m_commandCount(0)
+, m_boundElementBuffer(nullptr)
 {
 }
 
@@ -55,7 +59,15 @@ void Drawable::draw(DrawMode drawMode) const
     {
     case DrawMode::ElementsIndices:
     case DrawMode::ElementsIndexBuffer:
-        drawElements();
+        drawElements(drawMode, m_primitiveMode);
+        break;
+
+    case DrawMode::ArraysIndirect:
+        drawArraysIndirect();
+        break;
+
+    case DrawMode::ElementsIndirect:
+        drawElementsIndirect(drawMode, m_primitiveMode);
         break;
 
     case DrawMode::Arrays:
@@ -82,7 +94,14 @@ void Drawable::drawArrays(gl::GLint first, gl::GLsizei count) const
 
 void Drawable::drawArrays(gl::GLenum mode, gl::GLint first, gl::GLsizei count) const
 {
-    m_vao->drawArrays(mode, first, count);
+    if (m_instanceCount == 1)
+    {
+        m_vao->drawArrays(mode, first, count);
+    }
+    else
+    {
+        m_vao->drawArraysInstanced(mode, first, count, m_instanceCount);
+    }
 }
 
 void Drawable::drawElements() const
@@ -92,28 +111,44 @@ void Drawable::drawElements() const
 
 void Drawable::drawElements(gl::GLenum mode) const
 {
-    if (m_drawMode == DrawMode::ElementsIndices)
-    {
-        drawElements(mode, m_size, gl::GL_UNSIGNED_INT, m_indices.data());
-    }
-    else
-    {
-        drawElements(mode, m_size, m_indexBufferType, m_indexBuffer);
-    }
+    drawElements(m_drawMode, mode);
 }
 
 void Drawable::drawElements(gl::GLenum mode, gl::GLsizei count, gl::GLenum type, const void * indices) const
 {
-    // [TODO]: rethink recorded vao state
-    globjects::Buffer::unbind(gl::GL_ELEMENT_ARRAY_BUFFER);
+    // Client-side indices require that no index buffer is bound
+    bindElementBuffer(nullptr);
+    dispatchElements(mode, count, type, indices);
+}
 
-    m_vao->drawElements(mode, count, type, indices);
+void Drawable::drawElements(gl::GLenum mode, gl::GLsizei count, gl::GLenum type, globjects::Buffer * indices) const
+{
+    bindElementBuffer(indices);
+    dispatchElements(mode, count, type, nullptr);
 }
 
-void Drawable::drawElements(gl::GLenum mode, gl::GLsizei count, gl::GLenum type, globjects::Buffer *) const
+void Drawable::drawArraysIndirect() const
 {
-    // [TODO]: rethink recorded vao state
-    m_vao->drawElements(mode, count, type, nullptr);
+    drawArraysIndirect(m_primitiveMode);
+}
+
+void Drawable::drawArraysIndirect(gl::GLenum mode) const
+{
+    assert(m_commandBuffer);
+
+    m_commandBuffer->bind(gl::GL_DRAW_INDIRECT_BUFFER);
+    m_vao->multiDrawArraysIndirect(mode, nullptr, m_commandCount, 0);
+    globjects::Buffer::unbind(gl::GL_DRAW_INDIRECT_BUFFER);
+}
+
+void Drawable::drawElementsIndirect() const
+{
+    drawElementsIndirect(m_primitiveMode);
+}
+
+void Drawable::drawElementsIndirect(gl::GLenum mode) const
+{
+    drawElementsIndirect(m_drawMode, mode);
 }
 
 gl::GLsizei Drawable::size() const
@@ -126,6 +161,45 @@ void Drawable::setSize(gl::GLsizei size)
     m_size = size;
 }
 
+const std::vector<DrawRange> & Drawable::ranges() const
+{
+    return m_ranges;
+}
+
+void Drawable::setRanges(const std::vector<DrawRange> & ranges)
+{
+    m_ranges = ranges;
+}
+
+void Drawable::drawRange(size_t index) const
+{
+    assert(index < m_ranges.size());
+
+    const auto & range = m_ranges[index];
+
+    if (m_drawMode == DrawMode::Arrays || m_drawMode == DrawMode::ArraysIndirect)
+    {
+        drawArrays(m_primitiveMode, range.first, range.count);
+        return;
+    }
+
+    gl::GLenum type;
+    const auto buffer = activeIndexBuffer(m_drawMode, type);
+
+    // Nothing to draw if no indices have been set
+    if (!buffer)
+    {
+        return;
+    }
+
+    // Offset into the bound index buffer
+    const auto indexSize = type == gl::GL_UNSIGNED_BYTE ? 1 : (type == gl::GL_UNSIGNED_SHORT ? 2 : 4);
+    const auto offset = static_cast<size_t>(range.first) * indexSize;
+
+    bindElementBuffer(buffer);
+    dispatchElements(m_primitiveMode, range.count, type, reinterpret_cast<const void *>(offset));
+}
+
 gl::GLenum Drawable::primitiveMode() const
 {
     return m_primitiveMode;
@@ -136,6 +210,56 @@ void Drawable::setPrimitiveMode(gl::GLenum mode)
     m_primitiveMode = mode;
 }
 
+gl::GLsizei Drawable::instanceCount() const
+{
+    return m_instanceCount;
+}
+
+void Drawable::setInstanceCount(gl::GLsizei instanceCount)
+{
+    m_instanceCount = instanceCount;
+}
+
+globjects::Buffer * Drawable::commandBuffer() const
+{
+    return m_commandBuffer;
+}
+
+void Drawable::setCommandBuffer(globjects::Buffer * buffer, gl::GLsizei commandCount)
+{
+    m_commandBuffer = buffer;
+    m_commandCount  = commandCount;
+}
+
+gl::GLsizei Drawable::commandCount() const
+{
+    return m_commandCount;
+}
+
+void Drawable::setCommands(const std::vector<DrawArraysIndirectCommand> & commands)
+{
+    if (!m_ownCommandBuffer)
+    {
+        m_ownCommandBuffer = cppassist::make_unique<globjects::Buffer>();
+    }
+
+    m_ownCommandBuffer->setData(commands, gl::GL_STATIC_DRAW);
+
+    setCommandBuffer(m_ownCommandBuffer.get(), static_cast<gl::GLsizei>(commands.size()));
+}
+
+void Drawable::setCommands(const std::vector<DrawElementsIndirectCommand> & commands)
+{
+    if (!m_ownCommandBuffer)
+    {
+        m_ownCommandBuffer = cppassist::make_unique<globjects::Buffer>();
+    }
+
+    m_ownCommandBuffer->setData(commands, gl::GL_STATIC_DRAW);
+
+    setCommandBuffer(m_ownCommandBuffer.get(), static_cast<gl::GLsizei>(commands.size()));
+}
+
 globjects::Buffer * Drawable::buffer(size_t index)
 {
     if (m_buffers.count(index) == 0)
@@ -168,10 +292,9 @@ globjects::Buffer * Drawable::indexBuffer() const
 
 void Drawable::setIndexBuffer(globjects::Buffer * buffer)
 {
-    m_vao->bind();
-    buffer->bind(gl::GL_ELEMENT_ARRAY_BUFFER);
     m_indexBuffer = buffer;
-    m_vao->unbind();
+
+    bindElementBuffer(buffer);
 }
 
 void Drawable::setIndexBuffer(globjects::Buffer * buffer, gl::GLenum bufferType)
@@ -198,6 +321,13 @@ const std::vector<std::uint32_t> & Drawable::indices() const
 void Drawable::setIndices(const std::vector<std::uint32_t> & indices)
 {
     m_indices = indices;
+
+    if (!m_indicesBuffer)
+    {
+        m_indicesBuffer = cppassist::make_unique<globjects::Buffer>();
+    }
+
+    m_indicesBuffer->setData(m_indices, gl::GL_STATIC_DRAW);
 }
 
 globjects::VertexAttributeBinding * Drawable::attributeBinding(size_t index) const
@@ -227,6 +357,11 @@ void Drawable::setAttributeBindingFormatL(size_t bindingIndex, gl::GLint size, g
     m_vao->binding(bindingIndex)->setLFormat(size, type, relativeOffset);
 }
 
+void Drawable::setAttributeBindingDivisor(size_t bindingIndex, gl::GLuint divisor)
+{
+    m_vao->binding(bindingIndex)->setDivisor(static_cast<gl::GLint>(divisor));
+}
+
 void Drawable::bindAttribute(size_t bindingIndex, gl::GLint attributeIndex)
 {
     m_vao->binding(bindingIndex)->setAttribute(attributeIndex);
@@ -253,5 +388,88 @@ void Drawable::enableAllAttributeBindings()
     }
 }
 
+void Drawable::drawElements(DrawMode drawMode, gl::GLenum mode) const
+{
+    gl::GLenum type;
+    const auto buffer = activeIndexBuffer(drawMode, type);
+
+    // Without a bound index buffer, the null offset would be read as a pointer to CPU indices
+    if (!buffer)
+    {
+        return;
+    }
+
+    bindElementBuffer(buffer);
+    dispatchElements(mode, m_size, type, nullptr);
+}
+
+void Drawable::drawElementsIndirect(DrawMode drawMode, gl::GLenum mode) const
+{
+    assert(m_commandBuffer);
+
+    gl::GLenum type;
+    const auto buffer = activeIndexBuffer(drawMode, type);
+
+    // Nothing to draw if no indices have been set
+    if (!buffer)
+    {
+        return;
+    }
+
+    bindElementBuffer(buffer);
+
+    m_commandBuffer->bind(gl::GL_DRAW_INDIRECT_BUFFER);
+    m_vao->multiDrawElementsIndirect(mode, type, nullptr, m_commandCount, 0);
+    globjects::Buffer::unbind(gl::GL_DRAW_INDIRECT_BUFFER);
+}
+
+globjects::Buffer * Drawable::activeIndexBuffer(DrawMode drawMode, gl::GLenum & type) const
+{
+    // The uploaded CPU indices are used for ElementsIndices and as fallback
+    if (drawMode == DrawMode::ElementsIndices || !m_indexBuffer)
+    {
+        type = gl::GL_UNSIGNED_INT;
+        return m_indicesBuffer.get();
+    }
+
+    type = m_indexBufferType;
+    return m_indexBuffer;
+}
+
+void Drawable::bindElementBuffer(globjects::Buffer * buffer) const
+{
+    if (buffer == m_boundElementBuffer)
+    {
+        return;
+    }
+
+    m_vao->bind();
+
+    if (buffer)
+    {
+        buffer->bind(gl::GL_ELEMENT_ARRAY_BUFFER);
+    }
+    else
+    {
+        globjects::Buffer::unbind(gl::GL_ELEMENT_ARRAY_BUFFER);
+    }
+
+    m_vao->unbind();
+
+    m_boundElementBuffer = buffer;
+}
+
+void Drawable::dispatchElements(gl::GLenum mode, gl::GLsizei count, gl::GLenum type, const void * indices) const
+{
+    if (m_instanceCount == 1)
+    {
+        m_vao->drawElements(mode, count, type, indices);
+    }
+    else
+    {
+        m_vao->drawElementsInstanced(mode, count, type, indices, m_instanceCount);
+    }
+}
+
 
 } // namespace gloperate
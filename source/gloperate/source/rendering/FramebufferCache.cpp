@@ -0,0 +1,290 @@
+
+#include <gloperate/rendering/FramebufferCache.h>
+
+#include <cassert>
+#include <algorithm>
+#include <tuple>
+
+#include <cppassist/memory/make_unique.h>
+
+#include <glbinding/gl/enum.h>
+
+#include <globjects/Framebuffer.h>
+#include <globjects/FramebufferAttachment.h>
+#include <globjects/AttachedRenderbuffer.h>
+#include <globjects/AttachedTexture.h>
+
+#include <gloperate/base/logging.h>
+#include <gloperate/rendering/AbstractRenderTarget.h>
+
+
+namespace gloperate
+{
+
+
+bool FramebufferCache::Attachment::operator==(const Attachment & other) const
+{
+    return attachment == other.attachment && texture == other.texture && renderbuffer == other.renderbuffer;
+}
+
+bool FramebufferCache::Attachment::operator<(const Attachment & other) const
+{
+    return std::tie(attachment, texture, renderbuffer) < std::tie(other.attachment, other.texture, other.renderbuffer);
+}
+
+bool FramebufferCache::Key::operator<(const Key & other) const
+{
+    return std::tie(context, attachments, drawBuffers) < std::tie(other.context, other.attachments, other.drawBuffers);
+}
+
+bool FramebufferCache::attachment(size_t index, const AbstractRenderTarget * renderTarget, Attachment & attachment)
+{
+    assert(renderTarget);
+
+    attachment.attachment   = gl::GL_COLOR_ATTACHMENT0 + index;
+    attachment.texture      = nullptr;
+    attachment.renderbuffer = nullptr;
+
+    switch (renderTarget->underlyingAttachmentType())
+    {
+    case AttachmentType::Depth:
+        attachment.attachment = gl::GL_DEPTH_ATTACHMENT;
+        break;
+
+    case AttachmentType::Stencil:
+        attachment.attachment = gl::GL_STENCIL_ATTACHMENT;
+        break;
+
+    case AttachmentType::DepthStencil:
+        attachment.attachment = gl::GL_DEPTH_STENCIL_ATTACHMENT;
+        break;
+
+    default:
+        break;
+    }
+
+    switch (renderTarget->currentTargetType())
+    {
+    case RenderTargetType::UserDefinedFBOAttachment:
+        {
+            const auto targetAttachment = renderTarget->framebufferAttachment();
+
+            if (targetAttachment->isTextureAttachment())
+            {
+                attachment.texture = static_cast<globjects::AttachedTexture *>(targetAttachment)->texture();
+            }
+            else
+            {
+                attachment.renderbuffer = static_cast<globjects::AttachedRenderbuffer *>(targetAttachment)->renderBuffer();
+            }
+        }
+        break;
+
+    case RenderTargetType::Texture:
+        attachment.texture = renderTarget->textureAttachment();
+        break;
+
+    case RenderTargetType::Renderbuffer:
+        attachment.renderbuffer = renderTarget->renderbufferAttachment();
+        break;
+
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+const size_t FramebufferCache::s_maxFramebuffers = 64;
+
+FramebufferCache::FramebufferCache()
+: m_time(0)
+, m_generation(0)
+{
+}
+
+FramebufferCache::~FramebufferCache()
+{
+    // Framebuffers of contexts that are gone cannot be deleted anymore
+    for (auto & entry : m_framebuffers)
+    {
+        entry.second.framebuffer.release();
+    }
+
+    for (auto & orphan : m_orphans)
+    {
+        orphan.second.release();
+    }
+}
+
+globjects::Framebuffer * FramebufferCache::framebuffer(const std::vector<Attachment> & attachments, const std::vector<gl::GLenum> & drawBuffers)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    deleteOrphans();
+
+    Key key{ glbinding::getCurrentContext(), attachments, drawBuffers };
+
+    // Return existing framebuffer
+    const auto it = m_framebuffers.find(key);
+    if (it != m_framebuffers.end())
+    {
+        it->second.lastUse = ++m_time;
+        return it->second.framebuffer.get();
+    }
+
+    // Create and configure new framebuffer
+    auto fbo = cppassist::make_unique<globjects::Framebuffer>();
+
+    for (const auto & attachment : attachments)
+    {
+        if (attachment.texture)
+        {
+            fbo->attachTexture(attachment.attachment, attachment.texture);
+        }
+        else if (attachment.renderbuffer)
+        {
+            fbo->attachRenderBuffer(attachment.attachment, attachment.renderbuffer);
+        }
+    }
+
+    if (!drawBuffers.empty())
+    {
+        fbo->setDrawBuffers(drawBuffers);
+    }
+
+    // Validate once
+    fbo->printStatus(true);
+
+    GLOPERATE_DEBUG(2) << "FramebufferCache: created framebuffer " << fbo->id() << " (" << m_framebuffers.size() + 1 << " cached)";
+
+    const auto result = fbo.get();
+    m_framebuffers.emplace(std::move(key), Entry{ std::move(fbo), ++m_time });
+
+    trim();
+
+    return result;
+}
+
+void FramebufferCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    deleteOrphans();
+
+    const auto context = glbinding::getCurrentContext();
+
+    for (auto it = m_framebuffers.begin(); it != m_framebuffers.end(); )
+    {
+        if (it->first.context == context)
+        {
+            it = m_framebuffers.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    m_generation++;
+}
+
+void FramebufferCache::remove(const globjects::Texture * texture)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    removeIf([texture] (const Attachment & attachment)
+    {
+        return attachment.texture == texture;
+    });
+}
+
+void FramebufferCache::remove(const globjects::Renderbuffer * renderbuffer)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    removeIf([renderbuffer] (const Attachment & attachment)
+    {
+        return attachment.renderbuffer == renderbuffer;
+    });
+}
+
+void FramebufferCache::removeIf(const std::function<bool(const Attachment &)> & predicate)
+{
+    const auto context = glbinding::getCurrentContext();
+
+    for (auto it = m_framebuffers.begin(); it != m_framebuffers.end(); )
+    {
+        const auto & attachments = it->first.attachments;
+
+        if (!std::any_of(attachments.begin(), attachments.end(), predicate))
+        {
+            ++it;
+            continue;
+        }
+
+        // Framebuffers of other contexts can only be deleted from their context
+        if (it->first.context != context)
+        {
+            m_orphans.emplace_back(it->first.context, std::move(it->second.framebuffer));
+        }
+
+        it = m_framebuffers.erase(it);
+    }
+
+    m_generation++;
+}
+
+void FramebufferCache::deleteOrphans()
+{
+    const auto context = glbinding::getCurrentContext();
+
+    m_orphans.erase(std::remove_if(m_orphans.begin(), m_orphans.end(), [context] (const std::pair<glbinding::ContextHandle, std::unique_ptr<globjects::Framebuffer>> & orphan)
+    {
+        return orphan.first == context;
+    }), m_orphans.end());
+}
+
+void FramebufferCache::trim()
+{
+    const auto context = glbinding::getCurrentContext();
+
+    while (true)
+    {
+        size_t numFramebuffers = 0;
+        auto oldest = m_framebuffers.end();
+
+        for (auto it = m_framebuffers.begin(); it != m_framebuffers.end(); ++it)
+        {
+            if (it->first.context != context)
+            {
+                continue;
+            }
+
+            numFramebuffers++;
+
+            if (oldest == m_framebuffers.end() || it->second.lastUse < oldest->second.lastUse)
+            {
+                oldest = it;
+            }
+        }
+
+        if (numFramebuffers <= s_maxFramebuffers)
+        {
+            return;
+        }
+
+        GLOPERATE_DEBUG(2) << "FramebufferCache: release least recently used framebuffer " << oldest->second.framebuffer->id();
+
+        m_framebuffers.erase(oldest);
+        m_generation++;
+    }
+}
+
+unsigned int FramebufferCache::generation() const
+{
+    return m_generation;
+}
+
+
+} // namespace gloperate
@@ -15,6 +15,8 @@ namespace gloperate
 {
 
 
+const gl::GLsizei Icosahedron::MaxIterations;
+
 std::array<vec3, 12> Icosahedron::baseVertices()
 {
     static const float t = (1.f + glm::sqrt(5.f)) * 0.5f; // 2.118
@@ -85,7 +87,7 @@ void Icosahedron::generateGeometry(gl::GLsizei iterations)
     m_vertices = std::vector<vec3>(v.begin(), v.end());
     m_indices  = std::vector<Face>(i.begin(), i.end());
 
-    refine(m_vertices, m_indices, static_cast<char>(glm::clamp(iterations, 0, 8)));
+    refine(m_vertices, m_indices, static_cast<unsigned char>(glm::clamp(iterations, 0, MaxIterations)));
 }
 
 void Icosahedron::generateTextureCoordinates()
@@ -117,7 +119,7 @@ const std::vector<glm::vec2> & Icosahedron::texcoords() const
     return m_texcoords;
 }
 
-const std::vector<std::array<gl::GLushort, 3>> & Icosahedron::indices() const
+const std::vector<Icosahedron::Face> & Icosahedron::indices() const
 {
     return m_indices;
 }
@@ -127,7 +129,19 @@ void Icosahedron::refine(
 ,   std::vector<Face> & indices
 ,   const unsigned char levels)
 {
-    std::unordered_map<uint, gl::GLushort> cache;
+    std::unordered_map<std::uint64_t, gl::GLuint> cache;
+
+    // Each iteration quadruples the faces and adds one vertex per edge
+    size_t numFaces = indices.size();
+    size_t numVertices = vertices.size();
+    for (int i = 0; i < levels; ++i)
+    {
+        numVertices += numFaces * 3 / 2;
+        numFaces *= 4;
+    }
+
+    vertices.reserve(numVertices);
+    indices.reserve(numFaces);
 
     for(int i = 0; i < levels; ++i)
     {
@@ -137,34 +151,37 @@ void Icosahedron::refine(
         {
             Face & face = indices[f];
 
-            const gl::GLushort a(face[0]);
-            const gl::GLushort b(face[1]);
-            const gl::GLushort c(face[2]);
+            const gl::GLuint a(face[0]);
+            const gl::GLuint b(face[1]);
+            const gl::GLuint c(face[2]);
 
-            const gl::GLushort ab(split(a, b, vertices, cache));
-            const gl::GLushort bc(split(b, c, vertices, cache));
-            const gl::GLushort ca(split(c, a, vertices, cache));
+            const gl::GLuint ab(split(a, b, vertices, cache));
+            const gl::GLuint bc(split(b, c, vertices, cache));
+            const gl::GLuint ca(split(c, a, vertices, cache));
 
-            face = {{ ab, bc, ca }};
+            indices[f] = {{ ab, bc, ca }};
 
             indices.emplace_back(Face{{ a, ab, ca }});
             indices.emplace_back(Face{{ b, bc, ab }});
             indices.emplace_back(Face{{ c, ca, bc }});
         }
+
+        // Edges of the previous level are not split again
+        cache.clear();
     }
 }
 
-gl::GLushort Icosahedron::split(
-    const gl::GLushort a
-,   const gl::GLushort b
+gl::GLuint Icosahedron::split(
+    const gl::GLuint a
+,   const gl::GLuint b
 ,   std::vector<vec3> & points
-,   std::unordered_map<uint, gl::GLushort> & cache)
+,   std::unordered_map<std::uint64_t, gl::GLuint> & cache)
 {
     const bool aSmaller(a < b);
 
-    const uint smaller(aSmaller ? a : b);
-    const uint greater(aSmaller ? b : a);
-    const uint hash((smaller << 16) + greater);
+    const std::uint64_t smaller(aSmaller ? a : b);
+    const std::uint64_t greater(aSmaller ? b : a);
+    const std::uint64_t hash((smaller << 32) + greater);
 
     auto h(cache.find(hash));
     if(cache.end() != h)
@@ -172,7 +189,7 @@ gl::GLushort Icosahedron::split(
 
     points.push_back(normalize((points[a] + points[b]) * 0.5f));
 
-    const gl::GLushort i = static_cast<gl::GLushort>(points.size() - 1);
+    const gl::GLuint i = static_cast<gl::GLuint>(points.size() - 1);
 
     cache[hash] = i;
 
@@ -9,6 +9,8 @@
 
 #include <globjects/Buffer.h>
 
+#include <gloperate/rendering/ShapeGeometryCache.h>
+
 
 namespace gloperate
 {
@@ -32,9 +34,11 @@ Point::Point(cppassist::Flags<ShapeOption> options)
     m_drawable->setDrawMode(DrawMode::Arrays);
     m_drawable->setSize(1);
 
-    // Create vertex buffer
-    m_vertices = cppassist::make_unique<globjects::Buffer>();
-    m_vertices->setData(vertices, gl::GL_STATIC_DRAW);
+    // Get vertex buffer
+    m_vertices = ShapeGeometryCache::instance().buffer(ShapeType::Point, "vertices", glm::vec4(0.0f), [] (globjects::Buffer * buffer)
+    {
+        buffer->setData(vertices, gl::GL_STATIC_DRAW);
+    });
 
     m_drawable->bindAttribute(0, 0);
     m_drawable->setBuffer(0, m_vertices.get());
@@ -42,11 +46,13 @@ Point::Point(cppassist::Flags<ShapeOption> options)
     m_drawable->setAttributeBindingFormat(0, 2, gl::GL_FLOAT, gl::GL_FALSE, 0);
     m_drawable->enableAttributeBinding(0);
 
-    // Create texture coordinate buffer
+    // Get texture coordinate buffer
     if (options & ShapeOption::IncludeTexCoords)
     {
-        m_texCoords = cppassist::make_unique<globjects::Buffer>();
-        m_texCoords->setData(texcoords, gl::GL_STATIC_DRAW);
+        m_texCoords = ShapeGeometryCache::instance().buffer(ShapeType::Point, "texcoords", glm::vec4(0.0f), [] (globjects::Buffer * buffer)
+        {
+            buffer->setData(texcoords, gl::GL_STATIC_DRAW);
+        });
 
         m_drawable->bindAttribute(1, 1);
         m_drawable->setBuffer(1, m_texCoords.get());
@@ -9,6 +9,8 @@
 
 #include <globjects/Buffer.h>
 
+#include <gloperate/rendering/ShapeGeometryCache.h>
+
 
 namespace gloperate
 {
@@ -43,15 +45,17 @@ Quad::Quad(float width, float height, cppassist::Flags<ShapeOption> options)
     m_drawable->setDrawMode(DrawMode::Arrays);
     m_drawable->setSize(4);
 
-    // Create vertex buffer
-    auto v = vertices;
+    // Get vertex buffer
+    m_vertices = ShapeGeometryCache::instance().buffer(ShapeType::Quad, "vertices", glm::vec4(width, height, 0.0f, 0.0f), [width, height] (globjects::Buffer * buffer)
+    {
+        auto v = vertices;
 
-    for(auto & vertex : v) {
-        vertex *= glm::vec2(width, height);
-    }
+        for(auto & vertex : v) {
+            vertex *= glm::vec2(width, height);
+        }
 
-    m_vertices = cppassist::make_unique<globjects::Buffer>();
-    m_vertices->setData(v, gl::GL_STATIC_DRAW);
+        buffer->setData(v, gl::GL_STATIC_DRAW);
+    });
 
     m_drawable->bindAttribute(0, 0);
     m_drawable->setBuffer(0, m_vertices.get());
@@ -59,11 +63,13 @@ Quad::Quad(float width, float height, cppassist::Flags<ShapeOption> options)
     m_drawable->setAttributeBindingFormat(0, 2, gl::GL_FLOAT, gl::GL_FALSE, 0);
     m_drawable->enableAttributeBinding(0);
 
-    // Create texture coordinate buffer
+    // Get texture coordinate buffer
     if (options & ShapeOption::IncludeTexCoords)
     {
-        m_texCoords = cppassist::make_unique<globjects::Buffer>();
-        m_texCoords->setData(texcoords, gl::GL_STATIC_DRAW);
+        m_texCoords = ShapeGeometryCache::instance().buffer(ShapeType::Quad, "texcoords", glm::vec4(0.0f), [] (globjects::Buffer * buffer)
+        {
+            buffer->setData(texcoords, gl::GL_STATIC_DRAW);
+        });
 
         m_drawable->bindAttribute(1, 1);
         m_drawable->setBuffer(1, m_texCoords.get());
@@ -0,0 +1,220 @@
+
+#include <gloperate/rendering/RenderTargetPool.h>
+
+#include <cassert>
+#include <algorithm>
+
+#include <globjects/Texture.h>
+
+#include <gloperate/base/logging.h>
+#include <gloperate/rendering/FramebufferCache.h>
+
+
+namespace
+{
+    // Number of released textures that are kept for reuse per context
+    const size_t s_maxFreeTextures = 8;
+}
+
+
+namespace gloperate
+{
+
+
+bool RenderTargetPool::Lifetime::overlaps(const Lifetime & other) const
+{
+    // Lifetimes of different scopes cannot be compared
+    if (!scope || scope != other.scope)
+    {
+        return true;
+    }
+
+    return first <= other.last && other.first <= last;
+}
+
+RenderTargetPool::RenderTargetPool(FramebufferCache * framebufferCache)
+: m_framebufferCache(framebufferCache)
+, m_time(0)
+{
+    assert(framebufferCache);
+}
+
+RenderTargetPool::~RenderTargetPool()
+{
+    // Textures of contexts that are gone cannot be deleted anymore
+    for (auto & entry : m_entries)
+    {
+        entry.texture.release();
+    }
+}
+
+globjects::Texture * RenderTargetPool::acquire(const void * owner, int width, int height, gl::GLenum internalFormat, gl::GLenum format, gl::GLenum type, const Lifetime & lifetime)
+{
+    assert(owner);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const auto context = glbinding::getCurrentContext();
+
+    const auto matches = [&] (const Entry & entry)
+    {
+        return entry.context == context && entry.width == width && entry.height == height &&
+               entry.internalFormat == internalFormat && entry.format == format && entry.type == type;
+    };
+
+    const auto isCompatible = [&] (const Entry & entry)
+    {
+        return std::none_of(entry.reservations.begin(), entry.reservations.end(), [&] (const Reservation & reservation)
+        {
+            return reservation.owner != owner && reservation.lifetime.overlaps(lifetime);
+        });
+    };
+
+    // Keep current texture of the owner if it still fits
+    for (auto & entry : m_entries)
+    {
+        auto it = std::find_if(entry.reservations.begin(), entry.reservations.end(), [owner] (const Reservation & reservation)
+        {
+            return reservation.owner == owner;
+        });
+
+        if (it == entry.reservations.end())
+        {
+            continue;
+        }
+
+        if (matches(entry) && isCompatible(entry))
+        {
+            it->lifetime = lifetime;
+            return entry.texture.get();
+        }
+
+        break;
+    }
+
+    releaseReservation(owner);
+
+    // Prefer textures that are already shared, then free textures
+    Entry * candidate = nullptr;
+
+    for (auto & entry : m_entries)
+    {
+        if (!matches(entry) || !isCompatible(entry))
+        {
+            continue;
+        }
+
+        if (!candidate || (candidate->reservations.empty() && !entry.reservations.empty()))
+        {
+            candidate = &entry;
+        }
+    }
+
+    if (candidate)
+    {
+        candidate->reservations.push_back({ owner, lifetime });
+
+        auto texture = candidate->texture.get();
+        trim();
+
+        return texture;
+    }
+
+    // Allocate new texture
+    auto texture = globjects::Texture::createDefault(gl::GL_TEXTURE_2D);
+    texture->image2D(0, internalFormat, width, height, 0, format, type, nullptr);
+
+    GLOPERATE_DEBUG(2) << "RenderTargetPool: created texture " << texture->id() << " (" << width << "x" << height << ", " << m_entries.size() + 1 << " pooled)";
+
+    const auto result = texture.get();
+    m_entries.push_back({ context, width, height, internalFormat, format, type, std::move(texture), { { owner, lifetime } }, m_time });
+
+    trim();
+
+    return result;
+}
+
+void RenderTargetPool::release(const void * owner)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    releaseReservation(owner);
+    trim();
+}
+
+void RenderTargetPool::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const auto context = glbinding::getCurrentContext();
+
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [this, context] (const Entry & entry)
+    {
+        if (entry.context != context)
+        {
+            return false;
+        }
+
+        m_framebufferCache->remove(entry.texture.get());
+
+        return true;
+    }), m_entries.end());
+}
+
+void RenderTargetPool::releaseReservation(const void * owner)
+{
+    for (auto & entry : m_entries)
+    {
+        const auto it = std::find_if(entry.reservations.begin(), entry.reservations.end(), [owner] (const Reservation & reservation)
+        {
+            return reservation.owner == owner;
+        });
+
+        if (it != entry.reservations.end())
+        {
+            entry.reservations.erase(it);
+            entry.lastUse = ++m_time;
+
+            return;
+        }
+    }
+}
+
+void RenderTargetPool::trim()
+{
+    const auto context = glbinding::getCurrentContext();
+
+    while (true)
+    {
+        size_t numFree = 0;
+        auto oldest = m_entries.end();
+
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+        {
+            if (it->context != context || !it->reservations.empty())
+            {
+                continue;
+            }
+
+            numFree++;
+
+            if (oldest == m_entries.end() || it->lastUse < oldest->lastUse)
+            {
+                oldest = it;
+            }
+        }
+
+        if (numFree <= s_maxFreeTextures)
+        {
+            return;
+        }
+
+        // Framebuffers must not keep the deleted texture attached
+        m_framebufferCache->remove(oldest->texture.get());
+
+        m_entries.erase(oldest);
+    }
+}
+
+
+} // namespace gloperate
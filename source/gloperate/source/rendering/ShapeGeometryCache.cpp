@@ -0,0 +1,73 @@
+
+#include <gloperate/rendering/ShapeGeometryCache.h>
+
+#include <tuple>
+
+#include <globjects/Buffer.h>
+
+#include <gloperate/base/logging.h>
+
+
+namespace gloperate
+{
+
+
+ShapeGeometryCache & ShapeGeometryCache::instance()
+{
+    static ShapeGeometryCache cache;
+
+    return cache;
+}
+
+bool ShapeGeometryCache::Key::operator<(const Key & other) const
+{
+    return std::tie(context, type, component, parameters.x, parameters.y, parameters.z, parameters.w)
+         < std::tie(other.context, other.type, other.component, other.parameters.x, other.parameters.y, other.parameters.z, other.parameters.w);
+}
+
+ShapeGeometryCache::ShapeGeometryCache()
+{
+}
+
+ShapeGeometryCache::~ShapeGeometryCache()
+{
+}
+
+std::shared_ptr<globjects::Buffer> ShapeGeometryCache::buffer(ShapeType type, const std::string & component, const glm::vec4 & parameters, const std::function<void(globjects::Buffer *)> & initialize)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const Key key{ glbinding::getCurrentContext(), type, component, parameters };
+
+    // Return buffer if it is still in use
+    auto it = m_buffers.find(key);
+    if (it != m_buffers.end())
+    {
+        if (auto buffer = it->second.lock())
+        {
+            return buffer;
+        }
+    }
+
+    // Remove entries of deleted buffers
+    for (auto entry = m_buffers.begin(); entry != m_buffers.end(); )
+    {
+        if (entry->second.expired())
+            entry = m_buffers.erase(entry);
+        else
+            ++entry;
+    }
+
+    // Create buffer
+    auto buffer = std::make_shared<globjects::Buffer>();
+    initialize(buffer.get());
+
+    GLOPERATE_DEBUG(2) << "ShapeGeometryCache: created buffer " << buffer->id() << " for " << component << " (" << m_buffers.size() + 1 << " cached)";
+
+    m_buffers[key] = buffer;
+
+    return buffer;
+}
+
+
+} // namespace gloperate
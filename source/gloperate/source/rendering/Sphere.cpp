@@ -1,7 +1,9 @@
 
 #include <gloperate/rendering/Sphere.h>
 
-#include <iostream>
+#include <map>
+#include <mutex>
+#include <algorithm>
 
 #include <glm/glm.hpp>
 
@@ -11,34 +13,67 @@
 
 #include <globjects/Buffer.h>
 
+#include <gloperate/rendering/ShapeGeometryCache.h>
+
+
+namespace
+{
+
+
+// Get unit sphere geometry, which is generated only once per level
+const gloperate::Icosahedron & unitSphere(unsigned int subdivisions)
+{
+    static std::map<unsigned int, std::unique_ptr<gloperate::Icosahedron>> geometries;
+    static std::mutex mutex;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto & geometry = geometries[subdivisions];
+
+    if (!geometry)
+    {
+        geometry = cppassist::make_unique<gloperate::Icosahedron>();
+        geometry->generateGeometry(static_cast<gl::GLsizei>(subdivisions));
+        geometry->generateTextureCoordinates();
+    }
+
+    return *geometry;
+}
+
+
+} // namespace
+
 
 namespace gloperate
 {
 
 
-Sphere::Sphere(float radius, cppassist::Flags<ShapeOption> options)
+Sphere::Sphere(float radius, cppassist::Flags<ShapeOption> options, unsigned int subdivisions)
 : Shape(ShapeType::Sphere, options)
+, m_subdivisions(std::min(subdivisions, static_cast<unsigned int>(Icosahedron::MaxIterations)))
 {
-    // Create icosahedron
-    m_icosahedron = cppassist::make_unique<Icosahedron>();
-    m_icosahedron->generateGeometry(5);
+    auto & cache = ShapeGeometryCache::instance();
 
-    // Create drawable
+    const auto level = m_subdivisions;
+
+    // Create drawable (each refinement quadruples the 20 faces of the icosahedron)
     m_drawable = cppassist::make_unique<Drawable>();
     m_drawable->setPrimitiveMode(gl::GL_TRIANGLES);
     m_drawable->setDrawMode(gloperate::DrawMode::ElementsIndexBuffer);
-    m_drawable->setSize(m_icosahedron->indices().size() * std::tuple_size<Icosahedron::Face>::value);
-
-    // Create vertex buffer
-    auto vertices = m_icosahedron->vertices();
+    m_drawable->setSize(static_cast<gl::GLsizei>((20u << (2u * level)) * std::tuple_size<Icosahedron::Face>::value));
 
-    for (auto & vertex : vertices)
+    // Get vertex buffer
+    m_vertices = cache.buffer(ShapeType::Sphere, "vertices", glm::vec4(radius, 0.0f, 0.0f, level), [radius, level] (globjects::Buffer * buffer)
     {
-        vertex *= radius;
-    }
+        auto vertices = unitSphere(level).vertices();
 
-    m_vertices = cppassist::make_unique<globjects::Buffer>();
-    m_vertices->setData(vertices, gl::GL_STATIC_DRAW);
+        for (auto & vertex : vertices)
+        {
+            vertex *= radius;
+        }
+
+        buffer->setData(vertices, gl::GL_STATIC_DRAW);
+    });
 
     m_drawable->bindAttribute(0, 0);
     m_drawable->setBuffer(0, m_vertices.get());
@@ -46,13 +81,13 @@ Sphere::Sphere(float radius, cppassist::Flags<ShapeOption> options)
     m_drawable->setAttributeBindingFormat(0, 3, gl::GL_FLOAT, gl::GL_FALSE, 0);
     m_drawable->enableAttributeBinding(0);
 
-    // Create texture coordinate buffer
+    // Get texture coordinate buffer
     if (options & ShapeOption::IncludeTexCoords)
     {
-        m_icosahedron->generateTextureCoordinates();
-
-        m_texCoords = cppassist::make_unique<globjects::Buffer>();
-        m_texCoords->setData(m_icosahedron->texcoords(), gl::GL_STATIC_DRAW);
+        m_texCoords = cache.buffer(ShapeType::Sphere, "texcoords", glm::vec4(0.0f, 0.0f, 0.0f, level), [level] (globjects::Buffer * buffer)
+        {
+            buffer->setData(unitSphere(level).texcoords(), gl::GL_STATIC_DRAW);
+        });
 
         m_drawable->bindAttribute(1, 1);
         m_drawable->setBuffer(1, m_texCoords.get());
@@ -61,17 +96,24 @@ Sphere::Sphere(float radius, cppassist::Flags<ShapeOption> options)
         m_drawable->enableAttributeBinding(1);
     }
 
-    // Create index buffer
-    m_indices = cppassist::make_unique<globjects::Buffer>();
-    m_indices->setData(m_icosahedron->indices(), gl::GL_STATIC_DRAW);
+    // Get index buffer
+    m_indices = cache.buffer(ShapeType::Sphere, "indices", glm::vec4(0.0f, 0.0f, 0.0f, level), [level] (globjects::Buffer * buffer)
+    {
+        buffer->setData(unitSphere(level).indices(), gl::GL_STATIC_DRAW);
+    });
 
-    m_drawable->setIndexBuffer(m_indices.get(), gl::GL_UNSIGNED_SHORT);
+    m_drawable->setIndexBuffer(m_indices.get(), gl::GL_UNSIGNED_INT);
 }
 
 Sphere::~Sphere()
 {
 }
 
+unsigned int Sphere::subdivisions() const
+{
+    return m_subdivisions;
+}
+
 void Sphere::draw() const
 {
     m_drawable->draw();
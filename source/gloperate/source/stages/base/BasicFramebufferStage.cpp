@@ -5,10 +5,12 @@
 
 #include <globjects/Texture.h>
 
+#include <gloperate/base/Environment.h>
 #include <gloperate/rendering/AbstractRenderTarget.h>
 #include <gloperate/rendering/ColorRenderTarget.h>
 #include <gloperate/rendering/DepthRenderTarget.h>
 #include <gloperate/rendering/StencilRenderTarget.h>
+#include <gloperate/rendering/FramebufferCache.h>
 
 
 namespace gloperate
@@ -30,6 +32,8 @@ BasicFramebufferStage::BasicFramebufferStage(Environment * environment, const st
 
 BasicFramebufferStage::~BasicFramebufferStage()
 {
+    // Release framebuffers if the stage is removed without deinitializing its context
+    releaseFramebuffers();
 }
 
 void BasicFramebufferStage::onContextInit(AbstractGLContext *)
@@ -55,6 +59,8 @@ void BasicFramebufferStage::onContextInit(AbstractGLContext *)
 
 void BasicFramebufferStage::onContextDeinit(AbstractGLContext *)
 {
+    releaseFramebuffers();
+
     // Clean up OpenGL objects
     m_colorBuffer  = nullptr;
     m_depthBuffer  = nullptr;
@@ -84,4 +90,18 @@ void BasicFramebufferStage::onProcess()
 }
 
 
+void BasicFramebufferStage::releaseFramebuffers()
+{
+    // Cached framebuffers must not keep the deleted textures attached
+    if (m_colorTexture)
+    {
+        environment()->framebufferCache()->remove(m_colorTexture.get());
+    }
+
+    if (m_depthTexture)
+    {
+        environment()->framebufferCache()->remove(m_depthTexture.get());
+    }
+}
+
 } // namespace gloperate
@@ -6,6 +6,8 @@
 
 #include <globjects/Renderbuffer.h>
 
+#include <gloperate/base/Environment.h>
+#include <gloperate/rendering/FramebufferCache.h>
 #include <gloperate/stages/interfaces/RenderInterface.h>
 
 
@@ -28,26 +30,33 @@ BlitStage::BlitStage(Environment * environment, const std::string & name)
 
 BlitStage::~BlitStage()
 {
+    // Release framebuffers if the stage is removed without deinitializing its context
+    if (m_intermediateBuffer)
+    {
+        environment()->framebufferCache()->remove(m_intermediateBuffer.get());
+    }
 }
 
 void BlitStage::onContextInit(AbstractGLContext * /*context*/)
 {
     m_defaultFBO = globjects::Framebuffer::defaultFBO();
-    m_sourceFBO  = cppassist::make_unique<globjects::Framebuffer>();
-    m_targetFBO  = cppassist::make_unique<globjects::Framebuffer>();
-    m_intermediateFBO = cppassist::make_unique<globjects::Framebuffer>();
     m_intermediateTarget = cppassist::make_unique<gloperate::ColorRenderTarget>();
     m_intermediateBuffer = cppassist::make_unique<globjects::Renderbuffer>();
 
+    m_intermediateSize   = glm::ivec2(0, 0);
+
     m_intermediateTarget->setTarget(m_intermediateBuffer.get());
 }
 
 void BlitStage::onContextDeinit(AbstractGLContext * /*context*/)
 {
+    // Cached framebuffers must not keep the deleted renderbuffer attached
+    if (m_intermediateBuffer)
+    {
+        environment()->framebufferCache()->remove(m_intermediateBuffer.get());
+    }
+
     m_defaultFBO = nullptr;
-    m_sourceFBO  = nullptr;
-    m_targetFBO  = nullptr;
-    m_intermediateFBO = nullptr;
     m_intermediateTarget = nullptr;
     m_intermediateBuffer = nullptr;
 }
@@ -67,37 +76,39 @@ void BlitStage::onProcess()
         static_cast<gl::GLint>((*targetViewport).w)
     }};
 
-    globjects::Framebuffer * sourceFBO = RenderInterface::obtainFBO(0, *source, m_sourceFBO.get(), m_defaultFBO.get());
+    const auto cache = environment()->framebufferCache();
+
+    globjects::Framebuffer * sourceFBO = RenderInterface::obtainFBO(0, *source, cache, m_defaultFBO.get());
     auto sourceAttachment = source->drawBufferAttachment(0);
 
     if (*source == *target)
     {
-        m_intermediateBuffer->storage(gl::GL_RGBA, sourceRect[2], sourceRect[3]);
-
-        globjects::Framebuffer * intermediateFBO = RenderInterface::obtainFBO(0, m_intermediateTarget.get(), m_intermediateFBO.get(), nullptr);
+        // Reallocate intermediate storage only if the size has changed
+        const auto intermediateSize = glm::ivec2(sourceRect[2], sourceRect[3]);
+        if (m_intermediateSize != intermediateSize)
+        {
+            m_intermediateBuffer->storage(gl::GL_RGBA, intermediateSize.x, intermediateSize.y);
+            m_intermediateSize = intermediateSize;
+        }
+
+        globjects::Framebuffer * intermediateFBO = RenderInterface::obtainFBO(0, m_intermediateTarget.get(), cache, nullptr);
         auto intermediateAttachment = target->drawBufferAttachment(0);
 
-        sourceFBO->printStatus(true);
-        intermediateFBO->printStatus(true);
         sourceFBO->blit(sourceAttachment, sourceRect, intermediateFBO, intermediateAttachment, sourceRect, gl::GL_COLOR_BUFFER_BIT, *minFilter);
 
         sourceFBO = intermediateFBO;
         sourceAttachment = intermediateAttachment;
     }
 
-    globjects::Framebuffer * targetFBO = RenderInterface::obtainFBO(0, *target, m_targetFBO.get(), m_defaultFBO.get());
+    globjects::Framebuffer * targetFBO = RenderInterface::obtainFBO(0, *target, cache, m_defaultFBO.get());
     auto targetAttachment = target->drawBufferAttachment(0);
 
     if (sourceRect[2] <= targetRect[2] && sourceRect[3] <= targetRect[3])
     {
-        sourceFBO->printStatus(true);
-        targetFBO->printStatus(true);
         sourceFBO->blit(sourceAttachment, sourceRect, targetFBO, targetAttachment, targetRect, gl::GL_COLOR_BUFFER_BIT, *magFilter);
     }
     else
     {
-        sourceFBO->printStatus(true);
-        targetFBO->printStatus(true);
         sourceFBO->blit(sourceAttachment, sourceRect, targetFBO, targetAttachment, targetRect, gl::GL_COLOR_BUFFER_BIT, *minFilter);
     }
 
@@ -20,6 +20,7 @@ ColorGradientSelectionStage::ColorGradientSelectionStage(gloperate::Environment
 , gradient("gradient", this)
 , index("index", this)
 {
+    setCPUOnly(true);
 }
 
 ColorGradientSelectionStage::~ColorGradientSelectionStage()
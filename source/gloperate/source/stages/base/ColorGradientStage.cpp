@@ -19,6 +19,7 @@ ColorGradientStage::ColorGradientStage(Environment * environment, const std::str
 , gradients("gradients", this)
 , size("size", this, 0)
 {
+    setCPUOnly(true);
 }
 
 ColorGradientStage::~ColorGradientStage()
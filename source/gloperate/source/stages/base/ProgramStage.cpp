@@ -1,6 +1,8 @@
 
 #include <gloperate/stages/base/ProgramStage.h>
 
+#include <set>
+
 #include <cppfs/FilePath.h>
 
 #include <globjects/Shader.h>
@@ -57,38 +59,48 @@ void ProgramStage::onContextDeinit(AbstractGLContext *)
 
 void ProgramStage::onProcess()
 {
-    // Remove all loaded shader files from resource manager
-    m_shaders.clear();
+    // Collect all shaders from inputs of type Shader
+    std::set<globjects::Shader *> shaders;
 
-    // Detach all shaders from program
-    for (auto shader : m_program->shaders())
-    {
-        m_program->detach(shader);
-    }
-
-    // Attach all shaders from inputs of type Shader
     for (auto input : inputs<globjects::Shader *>())
     {
-        if (input)
+        if (input && input->value())
         {
-            m_program->attach(input->value());
+            shaders.insert(input->value());
         }
     }
 
-    // Load and attach all shaders from inputs of type FilePath
+    // Get shaders from inputs of type FilePath (files are loaded and compiled only once)
+    std::vector<std::shared_ptr<globjects::Shader>> loadedShaders;
+
     for (auto input : inputs<cppfs::FilePath>())
     {
-        // cppassist::warning("gloperate") << "Load shader " << (*input)->path();
+        if (auto shader = environment()->resourceManager()->loadShared<globjects::Shader>((*input)->path()))
+        {
+            shaders.insert(shader.get());
+            loadedShaders.push_back(std::move(shader));
+        }
+    }
 
-        if (auto shader = environment()->resourceManager()->load<globjects::Shader>((*input)->path()))
+    // Relink program only if the set of shaders has changed
+    const auto attachedShaders = m_program->shaders();
+
+    if (std::set<globjects::Shader *>(attachedShaders.begin(), attachedShaders.end()) != shaders)
+    {
+        for (auto shader : attachedShaders)
         {
-            // cppassist::warning("gloperate-resource-manager") << "Loaded shader " << shader->id();
+            m_program->detach(shader);
+        }
 
-            m_shaders.emplace_back(shader);
+        for (auto shader : shaders)
+        {
             m_program->attach(shader);
         }
     }
 
+    // Keep loaded shaders alive while they are attached
+    m_shaders = std::move(loadedShaders);
+
     // Update output
     program.setValue(m_program.get());
 }
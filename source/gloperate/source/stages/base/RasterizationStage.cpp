@@ -59,8 +59,6 @@ void RasterizationStage::onProcess()
         // Bind FBO
         fbo->bind(gl::GL_FRAMEBUFFER);
 
-        fbo->printStatus(true);
-
         // Render the drawable
         (*drawable)->draw();
 
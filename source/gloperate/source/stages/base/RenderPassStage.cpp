@@ -1,14 +1,24 @@
 
 #include <gloperate/stages/base/RenderPassStage.h>
 
+#include <string>
+#include <iterator>
+#include <algorithm>
+#include <typeindex>
+#include <unordered_map>
+
 #include <cppassist/logging/logging.h>
 
 #include <glbinding/gl/enum.h>
+#include <glbinding/gl/values.h>
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/matrix_inverse.hpp>
 
+#include <globjects/Buffer.h>
 #include <globjects/Program.h>
+#include <globjects/Uniform.h>
+#include <globjects/UniformBlock.h>
 #include <globjects/State.h>
 #include <globjects/Texture.h>
 #include <globjects/TextureHandle.h>
@@ -20,6 +30,148 @@
 #include <gloperate/rendering/Camera.h>
 
 
+namespace
+{
+
+
+using ResolveFunction = globjects::AbstractUniform * (*)(globjects::Program *, const std::string &);
+using ApplyFunction   = void (*)(globjects::AbstractUniform *, gloperate::AbstractSlot *);
+
+// Uniform buffer binding point of the 'Transforms' block
+const gl::GLuint s_transformBinding = 0;
+
+// Uniform names of the matrices (in the order of RenderPassStage::Transform)
+const char * s_transformNames[] =
+{
+    "viewProjectionMatrix",
+    "viewProjectionInvertedMatrix",
+    "viewMatrix",
+    "viewInvertexMatrix",
+    "projectionMatrix",
+    "projectionInvertedMatrix",
+    "modelMatrix",
+    "modelViewProjectionMatrix",
+    "modelViewProjectionInvertedMatrix",
+    "modelViewMatrix",
+    "modelViewInvertexMatrix",
+    "normalMatrix",
+    "modelNormalMatrix"
+};
+
+// Content of the 'Transforms' block (std140 layout, mat3 columns are padded to vec4)
+struct TransformBlock
+{
+    glm::mat4 matrices[11];
+    glm::vec4 normalMatrix[3];
+    glm::vec4 modelNormalMatrix[3];
+};
+
+static_assert(sizeof(TransformBlock) == 11 * 64 + 2 * 48, "TransformBlock must match the std140 layout");
+
+
+/**
+*  @brief
+*    Typed functions to resolve and set a uniform
+*/
+struct UniformType
+{
+    ResolveFunction resolve;
+    ApplyFunction   apply;
+};
+
+template <typename T>
+globjects::AbstractUniform * resolveUniform(globjects::Program * program, const std::string & name)
+{
+    return program->getUniform<T>(name);
+}
+
+template <typename T>
+void applyUniform(globjects::AbstractUniform * uniform, gloperate::AbstractSlot * input)
+{
+    static_cast<globjects::Uniform<T> *>(uniform)->set(static_cast<gloperate::Input<T> *>(input)->value());
+}
+
+void applyColor(globjects::AbstractUniform * uniform, gloperate::AbstractSlot * input)
+{
+    const gloperate::Color & color = **(static_cast<gloperate::Input<gloperate::Color> *>(input));
+
+    static_cast<globjects::Uniform<glm::vec4> *>(uniform)->set(color.toVec4());
+}
+
+template <typename T>
+void addUniformType(std::unordered_map<std::type_index, UniformType> & types)
+{
+    types[std::type_index(typeid(T))] = { &resolveUniform<T>, &applyUniform<T> };
+}
+
+const std::unordered_map<std::type_index, UniformType> & uniformTypes()
+{
+    static const auto types = [] ()
+    {
+        std::unordered_map<std::type_index, UniformType> types;
+
+        addUniformType<float>(types);
+        addUniformType<int>(types);
+        addUniformType<unsigned int>(types);
+        addUniformType<bool>(types);
+        addUniformType<glm::vec2>(types);
+        addUniformType<glm::vec3>(types);
+        addUniformType<glm::vec4>(types);
+        addUniformType<glm::ivec2>(types);
+        addUniformType<glm::ivec3>(types);
+        addUniformType<glm::ivec4>(types);
+        addUniformType<glm::uvec2>(types);
+        addUniformType<glm::uvec3>(types);
+        addUniformType<glm::uvec4>(types);
+        addUniformType<glm::mat2>(types);
+        addUniformType<glm::mat3>(types);
+        addUniformType<glm::mat4>(types);
+        addUniformType<glm::mat2x3>(types);
+        addUniformType<glm::mat3x2>(types);
+        addUniformType<glm::mat2x4>(types);
+        addUniformType<glm::mat4x2>(types);
+        addUniformType<glm::mat3x4>(types);
+        addUniformType<glm::mat4x3>(types);
+        addUniformType<gl::GLuint64>(types);
+        addUniformType<globjects::TextureHandle>(types);
+        addUniformType<std::vector<float>>(types);
+        addUniformType<std::vector<int>>(types);
+        addUniformType<std::vector<unsigned int>>(types);
+        addUniformType<std::vector<bool>>(types);
+        addUniformType<std::vector<glm::vec2>>(types);
+        addUniformType<std::vector<glm::vec3>>(types);
+        addUniformType<std::vector<glm::vec4>>(types);
+        addUniformType<std::vector<glm::ivec2>>(types);
+        addUniformType<std::vector<glm::ivec3>>(types);
+        addUniformType<std::vector<glm::ivec4>>(types);
+        addUniformType<std::vector<glm::uvec2>>(types);
+        addUniformType<std::vector<glm::uvec3>>(types);
+        addUniformType<std::vector<glm::uvec4>>(types);
+        addUniformType<std::vector<glm::mat2>>(types);
+        addUniformType<std::vector<glm::mat3>>(types);
+        addUniformType<std::vector<glm::mat4>>(types);
+        addUniformType<std::vector<glm::mat2x3>>(types);
+        addUniformType<std::vector<glm::mat3x2>>(types);
+        addUniformType<std::vector<glm::mat2x4>>(types);
+        addUniformType<std::vector<glm::mat4x2>>(types);
+        addUniformType<std::vector<glm::mat3x4>>(types);
+        addUniformType<std::vector<glm::mat4x3>>(types);
+        addUniformType<std::vector<gl::GLuint64>>(types);
+        addUniformType<std::vector<globjects::TextureHandle>>(types);
+
+        // Colors are passed as vec4
+        types[std::type_index(typeid(gloperate::Color))] = { &resolveUniform<glm::vec4>, &applyColor };
+
+        return types;
+    }();
+
+    return types;
+}
+
+
+} // namespace
+
+
 namespace gloperate
 {
 
@@ -33,6 +185,7 @@ RenderPassStage::RenderPassStage(Environment * environment, const std::string &
 , program("program", this)
 , camera("camera", this)
 , modelMatrix("modelMatrix", this, glm::mat4(1.0))
+, tileMatrix("tileMatrix", this, glm::mat4(1.0))
 , depthTest("depthTest", this, true)
 , depthMask("depthMask", this, true)
 , depthFunc("depthFunc", this, gl::GL_LEQUAL)
@@ -41,15 +194,22 @@ RenderPassStage::RenderPassStage(Environment * environment, const std::string &
 , frontFace("frontFace", this, gl::GL_CCW)
 , blending("blending", this, false)
 , renderPass("renderPass", this)
+, m_boundProgram(nullptr)
+, m_bindingsValid(false)
+, m_useTransformBlock(false)
 {
-    // Invalidate output when input slots have been added or removed
+    m_transformUniforms.fill(nullptr);
+
+    // Invalidate output and bindings when input slots have been added or removed
     m_inputAddedConnection = inputAdded.connect([this] (gloperate::AbstractSlot *)
     {
+        m_bindingsValid = false;
         renderPass.invalidate();
     });
 
     m_inputRemovedConnection = inputRemoved.connect([this] (gloperate::AbstractSlot *)
     {
+        m_bindingsValid = false;
         renderPass.invalidate();
     });
 }
@@ -68,11 +228,29 @@ void RenderPassStage::onContextInit(AbstractGLContext *)
     m_beforeState = cppassist::make_unique<globjects::State>(globjects::State::DeferredMode);
     m_renderPass->setStateBefore(m_beforeState.get());
 
+    // Create uniform buffer for matrices
+    m_transformBuffer = cppassist::make_unique<globjects::Buffer>();
+    m_transformBuffer->setData(static_cast<gl::GLsizeiptr>(sizeof(TransformBlock)), nullptr, gl::GL_DYNAMIC_DRAW);
+
+    // Uniforms have to be resolved again
+    m_bindingsValid = false;
+
     renderPass.invalidate();
 }
 
 void RenderPassStage::onContextDeinit(AbstractGLContext *)
 {
+    // Reset binding table
+    m_uniformBindings.clear();
+    m_textureBindings.clear();
+    m_bufferBindings.clear();
+    m_transformUniforms.fill(nullptr);
+    m_boundProgram  = nullptr;
+    m_bindingsValid = false;
+
+    // Release uniform buffer
+    m_transformBuffer = nullptr;
+
     // Create OpenGL state set
     m_beforeState = nullptr;
 
@@ -88,35 +266,23 @@ void RenderPassStage::onProcess()
     m_renderPass->setGeometry(*drawable);
     m_renderPass->setProgram(*program);
 
-    // Check if a camera or a model matrix is set
-    Camera * camera = (this->camera.isValid() && *this->camera) ? *this->camera : nullptr;
-    bool hasModelMatrix = (this->modelMatrix.isValid());
-    const glm::mat4 modelMatrix = hasModelMatrix ? *this->modelMatrix : glm::mat4(1.0f);
-
-    if (camera)
+    // Resolve uniforms if the program or the set of inputs has changed
+    if (!m_bindingsValid || *program != m_boundProgram || program.hasChanged())
     {
-        (*program)->setUniform<glm::mat4>("viewProjectionMatrix",         camera->viewProjectionMatrix());
-        (*program)->setUniform<glm::mat4>("viewProjectionInvertedMatrix", camera->viewProjectionInvertedMatrix());
-        (*program)->setUniform<glm::mat4>("viewMatrix",                   camera->viewMatrix());
-        (*program)->setUniform<glm::mat4>("viewInvertexMatrix",           camera->viewInvertedMatrix());
-        (*program)->setUniform<glm::mat4>("projectionMatrix",             camera->projectionMatrix());
-        (*program)->setUniform<glm::mat4>("projectionInvertedMatrix",     camera->projectionInvertedMatrix());
-        (*program)->setUniform<glm::mat3>("normalMatrix",                 camera->normalMatrix());
+        updateBindings();
     }
 
-    if (hasModelMatrix)
+    if (!*program)
     {
-        (*program)->setUniform<glm::mat4>("modelMatrix", modelMatrix);
+        renderPass.setValue(m_renderPass.get());
+        return;
     }
 
-    if (camera && hasModelMatrix)
-    {
-        (*program)->setUniform<glm::mat4>("modelViewProjectionMatrix",         camera->viewProjectionMatrix() * modelMatrix);
-        (*program)->setUniform<glm::mat4>("modelViewProjectionInvertedMatrix", glm::inverse(camera->viewProjectionMatrix() * modelMatrix));
-        (*program)->setUniform<glm::mat4>("modelViewMatrix",                   camera->viewMatrix() * modelMatrix);
-        (*program)->setUniform<glm::mat4>("modelViewInvertexMatrix",           glm::inverse(camera->viewMatrix() * modelMatrix));
-        (*program)->setUniform<glm::mat3>("modelNormalMatrix",                 glm::inverseTranspose(glm::mat3(camera->viewMatrix() * modelMatrix)));
-    }
+    // Check if a camera or a model matrix is set
+    Camera * camera = (this->camera.isValid() && *this->camera) ? *this->camera : nullptr;
+    bool hasModelMatrix = (this->modelMatrix.isValid());
+
+    updateTransforms(camera, hasModelMatrix);
 
     // Update OpenGL states
     if (*this->depthTest) m_renderPass->stateBefore()->enable (gl::GL_DEPTH_TEST);
@@ -132,10 +298,103 @@ void RenderPassStage::onProcess()
     if (*this->blending) m_renderPass->stateBefore()->enable (gl::GL_BLEND);
     else                 m_renderPass->stateBefore()->disable(gl::GL_BLEND);
 
-    // Update uniforms from dynamic inputs
-    unsigned int textureIndex = 0;
+    // Attach textures
+    int textureIndex = 0;
+
+    for (const auto & binding : m_textureBindings)
+    {
+        // Get texture
+        globjects::Texture * texture = static_cast<Input<globjects::Texture *> *>(binding.input)->value();
+
+        if (!texture)
+            continue;
+
+        // Attach texture
+        static_cast<globjects::Uniform<int> *>(binding.uniform)->set(textureIndex);
+        m_renderPass->setTexture(static_cast<size_t>(textureIndex), texture);
+
+        if (texture->target() == gl::GL_TEXTURE_CUBE_MAP)
+        {
+            m_renderPass->stateBefore()->enable(gl::GL_TEXTURE_CUBE_MAP_SEAMLESS);
+        }
+
+        ++textureIndex;
+    }
+
+    // Attach shader storage buffers
     unsigned int shaderStorageBufferIndex = 0;
 
+    for (auto input : m_bufferBindings)
+    {
+        // Get buffer
+        globjects::Buffer * buffer = static_cast<Input<globjects::Buffer *> *>(input)->value();
+
+        if (!buffer)
+            continue;
+
+        // Attach shader storage buffer
+        m_renderPass->setShaderStorageBuffer(shaderStorageBufferIndex, buffer);
+        ++shaderStorageBufferIndex;
+    }
+
+    // Update uniforms from dynamic inputs
+    for (const auto & binding : m_uniformBindings)
+    {
+        binding.apply(binding.uniform, binding.input);
+    }
+
+    // Update outputs
+    renderPass.setValue(m_renderPass.get());
+}
+
+void RenderPassStage::updateBindings()
+{
+    globjects::Program * program = *this->program;
+
+    m_uniformBindings.clear();
+    m_textureBindings.clear();
+    m_bufferBindings.clear();
+    m_transformUniforms.fill(nullptr);
+    m_useTransformBlock = false;
+
+    m_boundProgram  = program;
+    m_bindingsValid = true;
+
+    if (!program)
+    {
+        m_renderPass->removeUniformBuffer(s_transformBinding);
+        return;
+    }
+
+    // Resolve matrices that are actually used by the program
+    for (int i = 0; i < TransformCount; ++i)
+    {
+        if (program->getUniformLocation(s_transformNames[i]) < 0)
+            continue;
+
+        if (i == NormalMatrix || i == ModelNormalMatrix)
+            m_transformUniforms[i] = program->getUniform<glm::mat3>(s_transformNames[i]);
+        else
+            m_transformUniforms[i] = program->getUniform<glm::mat4>(s_transformNames[i]);
+    }
+
+    // Bind 'Transforms' block, if declared
+    const gl::GLuint blockIndex = program->getUniformBlockIndex("Transforms");
+
+    if (blockIndex != gl::GL_INVALID_INDEX)
+    {
+        program->uniformBlock(blockIndex)->setBinding(s_transformBinding);
+        m_renderPass->setUniformBuffer(s_transformBinding, m_transformBuffer.get());
+        m_useTransformBlock = true;
+    }
+    else
+    {
+        m_renderPass->removeUniformBuffer(s_transformBinding);
+    }
+
+    // Resolve dynamic inputs
+    const auto & types = uniformTypes();
+
     for (auto input : inputs())
     {
         // Only conside dynamic inputs here
@@ -145,157 +404,125 @@ void RenderPassStage::onProcess()
         // Texture
         if (input->type() == typeid(globjects::Texture *))
         {
-            // Get texture
-            globjects::Texture * texture = static_cast<Input<globjects::Texture *> *>(input)->value();
+            m_textureBindings.push_back({ input, program->getUniform<int>(input->name()) });
+        }
 
-            if (!texture)
-                continue;
+        // Shader storage buffer
+        else if (input->type() == typeid(globjects::Buffer *))
+        {
+            m_bufferBindings.push_back(input);
+        }
 
-            // Attach texture
-            (*program)->setUniform<int>(input->name(), textureIndex);
-            m_renderPass->setTexture(textureIndex, texture);
+        // Basic uniform
+        else
+        {
+            const auto it = types.find(std::type_index(input->type()));
 
-            if (texture->target() == gl::GL_TEXTURE_CUBE_MAP)
-            {
-                m_renderPass->stateBefore()->enable(gl::GL_TEXTURE_CUBE_MAP_SEAMLESS);
-            }
+            if (it == types.end())
+                continue;
 
-            ++textureIndex;
+            m_uniformBindings.push_back({ input, it->second.resolve(program, input->name()), it->second.apply });
         }
+    }
+}
 
-        // Shader storage buffer
-        else if (input->type() == typeid(globjects::Buffer *))
+void RenderPassStage::updateTransforms(Camera * camera, bool hasModelMatrix)
+{
+    // Check which matrices are needed
+    const auto needs = [this] (Transform transform)
+    {
+        return m_useTransformBlock || m_transformUniforms[transform] != nullptr;
+    };
+
+    // Camera matrices are cached by the camera, only the model-dependent ones are computed here
+    TransformBlock block;
+    std::fill(std::begin(block.matrices), std::end(block.matrices), glm::mat4(1.0f));
+
+    glm::mat3 normalMatrix(1.0f);
+    glm::mat3 modelNormalMatrix(1.0f);
+
+    const glm::mat4 modelMatrix = hasModelMatrix ? *this->modelMatrix : glm::mat4(1.0f);
+    block.matrices[ModelMatrix] = modelMatrix;
+
+    if (camera)
+    {
+        block.matrices[ViewProjectionMatrix]         = camera->viewProjectionMatrix();
+        block.matrices[ViewProjectionInvertedMatrix] = camera->viewProjectionInvertedMatrix();
+        block.matrices[ViewMatrix]                   = camera->viewMatrix();
+        block.matrices[ViewInvertedMatrix]           = camera->viewInvertedMatrix();
+        block.matrices[ProjectionMatrix]             = camera->projectionMatrix();
+        block.matrices[ProjectionInvertedMatrix]     = camera->projectionInvertedMatrix();
+        normalMatrix                                 = camera->normalMatrix();
+
+        // Map clip space onto the current tile
+        if (*this->tileMatrix != glm::mat4(1.0f))
         {
-            // Get buffer
-            globjects::Buffer * buffer = static_cast<Input<globjects::Buffer *> *>(input)->value();
+            const glm::mat4 & tile = *this->tileMatrix;
+            const glm::mat4 tileInverted = glm::inverse(tile);
 
-            if (!buffer)
-                continue;
+            block.matrices[ViewProjectionMatrix]         = tile * block.matrices[ViewProjectionMatrix];
+            block.matrices[ViewProjectionInvertedMatrix] = block.matrices[ViewProjectionInvertedMatrix] * tileInverted;
+            block.matrices[ProjectionMatrix]             = tile * block.matrices[ProjectionMatrix];
+            block.matrices[ProjectionInvertedMatrix]     = block.matrices[ProjectionInvertedMatrix] * tileInverted;
+        }
 
-            // Attach shader storage buffer
-            m_renderPass->setShaderStorageBuffer(shaderStorageBufferIndex, buffer);
-            ++shaderStorageBufferIndex;
+        if (needs(ModelViewProjectionMatrix) || needs(ModelViewProjectionInvertedMatrix))
+        {
+            block.matrices[ModelViewProjectionMatrix] = block.matrices[ViewProjectionMatrix] * modelMatrix;
         }
 
-        // Color
-        else if (input->type() == typeid(Color))
+        if (needs(ModelViewProjectionInvertedMatrix))
         {
-            // Get color
-            const Color & color = **(static_cast<Input<Color> *>(input));
+            block.matrices[ModelViewProjectionInvertedMatrix] = glm::inverse(block.matrices[ModelViewProjectionMatrix]);
+        }
 
-            // Set color uniform
-            (*program)->setUniform<glm::vec4>(input->name(), color.toVec4());
+        if (needs(ModelViewMatrix) || needs(ModelViewInvertedMatrix) || needs(ModelNormalMatrix))
+        {
+            block.matrices[ModelViewMatrix] = camera->viewMatrix() * modelMatrix;
         }
 
-        // Basic uniform
-        else
+        if (needs(ModelViewInvertedMatrix))
+        {
+            block.matrices[ModelViewInvertedMatrix] = glm::inverse(block.matrices[ModelViewMatrix]);
+        }
+
+        if (needs(ModelNormalMatrix))
         {
-            setUniformValue(*program, input);
+            modelNormalMatrix = glm::inverseTranspose(glm::mat3(block.matrices[ModelViewMatrix]));
         }
     }
 
-    // Update outputs
-    renderPass.setValue(m_renderPass.get());
-}
+    // Set uniforms that are used by the program
+    for (int i = 0; i < TransformCount; ++i)
+    {
+        if (!m_transformUniforms[i])
+            continue;
 
-void RenderPassStage::setUniformValue(globjects::Program * program, AbstractSlot * input)
-{
-    if (input->type() == typeid(float)) {
-        program->setUniform<float>(input->name(), static_cast<Input<float> *>(input)->value());
-    } else if (input->type() == typeid(int)) {
-        program->setUniform<int>(input->name(), static_cast<Input<int> *>(input)->value());
-    } else if (input->type() == typeid(unsigned int)) {
-        program->setUniform<unsigned int>(input->name(), static_cast<Input<unsigned int> *>(input)->value());
-    } else if (input->type() == typeid(bool)) {
-        program->setUniform<bool>(input->name(), static_cast<Input<bool> *>(input)->value());
-    } else if (input->type() == typeid(glm::vec2)) {
-        program->setUniform<glm::vec2>(input->name(), static_cast<Input<glm::vec2> *>(input)->value());
-    } else if (input->type() == typeid(glm::vec3)) {
-        program->setUniform<glm::vec3>(input->name(), static_cast<Input<glm::vec3> *>(input)->value());
-    } else if (input->type() == typeid(glm::vec4)) {
-        program->setUniform<glm::vec4>(input->name(), static_cast<Input<glm::vec4> *>(input)->value());
-    } else if (input->type() == typeid(glm::ivec2)) {
-        program->setUniform<glm::ivec2>(input->name(), static_cast<Input<glm::ivec2> *>(input)->value());
-    } else if (input->type() == typeid(glm::ivec3)) {
-        program->setUniform<glm::ivec3>(input->name(), static_cast<Input<glm::ivec3> *>(input)->value());
-    } else if (input->type() == typeid(glm::ivec4)) {
-        program->setUniform<glm::ivec4>(input->name(), static_cast<Input<glm::ivec4> *>(input)->value());
-    } else if (input->type() == typeid(glm::uvec2)) {
-        program->setUniform<glm::uvec2>(input->name(), static_cast<Input<glm::uvec2> *>(input)->value());
-    } else if (input->type() == typeid(glm::uvec3)) {
-        program->setUniform<glm::uvec3>(input->name(), static_cast<Input<glm::uvec3> *>(input)->value());
-    } else if (input->type() == typeid(glm::uvec4)) {
-        program->setUniform<glm::uvec4>(input->name(), static_cast<Input<glm::uvec4> *>(input)->value());
-    } else if (input->type() == typeid(glm::mat2)) {
-        program->setUniform<glm::mat2>(input->name(), static_cast<Input<glm::mat2> *>(input)->value());
-    } else if (input->type() == typeid(glm::mat3)) {
-        program->setUniform<glm::mat3>(input->name(), static_cast<Input<glm::mat3> *>(input)->value());
-    } else if (input->type() == typeid(glm::mat4)) {
-        program->setUniform<glm::mat4>(input->name(), static_cast<Input<glm::mat4> *>(input)->value());
-    } else if (input->type() == typeid(glm::mat2x3)) {
-        program->setUniform<glm::mat2x3>(input->name(), static_cast<Input<glm::mat2x3> *>(input)->value());
-    } else if (input->type() == typeid(glm::mat3x2)) {
-        program->setUniform<glm::mat3x2>(input->name(), static_cast<Input<glm::mat3x2> *>(input)->value());
-    } else if (input->type() == typeid(glm::mat2x4)) {
-        program->setUniform<glm::mat2x4>(input->name(), static_cast<Input<glm::mat2x4> *>(input)->value());
-    } else if (input->type() == typeid(glm::mat4x2)) {
-        program->setUniform<glm::mat4x2>(input->name(), static_cast<Input<glm::mat4x2> *>(input)->value());
-    } else if (input->type() == typeid(glm::mat3x4)) {
-        program->setUniform<glm::mat3x4>(input->name(), static_cast<Input<glm::mat3x4> *>(input)->value());
-    } else if (input->type() == typeid(glm::mat4x3)) {
-        program->setUniform<glm::mat4x3>(input->name(), static_cast<Input<glm::mat4x3> *>(input)->value());
-    } else if (input->type() == typeid(gl::GLuint64)) {
-        program->setUniform<gl::GLuint64>(input->name(), static_cast<Input<gl::GLuint64> *>(input)->value());
-    } else if (input->type() == typeid(globjects::TextureHandle)) {
-        program->setUniform<globjects::TextureHandle>(input->name(), static_cast<Input<globjects::TextureHandle> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<float>)) {
-        program->setUniform<std::vector<float>>(input->name(), static_cast<Input<std::vector<float>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<int>)) {
-        program->setUniform<std::vector<int>>(input->name(), static_cast<Input<std::vector<int>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<unsigned int>)) {
-        program->setUniform<std::vector<unsigned int>>(input->name(), static_cast<Input<std::vector<unsigned int>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<bool>)) {
-        program->setUniform<std::vector<bool>>(input->name(), static_cast<Input<std::vector<bool>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::vec2>)) {
-        program->setUniform<std::vector<glm::vec2>>(input->name(), static_cast<Input<std::vector<glm::vec2>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::vec3>)) {
-        program->setUniform<std::vector<glm::vec3>>(input->name(), static_cast<Input<std::vector<glm::vec3>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::vec4>)) {
-        program->setUniform<std::vector<glm::vec4>>(input->name(), static_cast<Input<std::vector<glm::vec4>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::ivec2>)) {
-        program->setUniform<std::vector<glm::ivec2>>(input->name(), static_cast<Input<std::vector<glm::ivec2>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::ivec3>)) {
-        program->setUniform<std::vector<glm::ivec3>>(input->name(), static_cast<Input<std::vector<glm::ivec3>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::ivec4>)) {
-        program->setUniform<std::vector<glm::ivec4>>(input->name(), static_cast<Input<std::vector<glm::ivec4>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::uvec2>)) {
-        program->setUniform<std::vector<glm::uvec2>>(input->name(), static_cast<Input<std::vector<glm::uvec2>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::uvec3>)) {
-        program->setUniform<std::vector<glm::uvec3>>(input->name(), static_cast<Input<std::vector<glm::uvec3>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::uvec4>)) {
-        program->setUniform<std::vector<glm::uvec4>>(input->name(), static_cast<Input<std::vector<glm::uvec4>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::mat2>)) {
-        program->setUniform<std::vector<glm::mat2>>(input->name(), static_cast<Input<std::vector<glm::mat2>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::mat3>)) {
-        program->setUniform<std::vector<glm::mat3>>(input->name(), static_cast<Input<std::vector<glm::mat3>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::mat4>)) {
-        program->setUniform<std::vector<glm::mat4>>(input->name(), static_cast<Input<std::vector<glm::mat4>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::mat2x3>)) {
-        program->setUniform<std::vector<glm::mat2x3>>(input->name(), static_cast<Input<std::vector<glm::mat2x3>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::mat3x2>)) {
-        program->setUniform<std::vector<glm::mat3x2>>(input->name(), static_cast<Input<std::vector<glm::mat3x2>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::mat2x4>)) {
-        program->setUniform<std::vector<glm::mat2x4>>(input->name(), static_cast<Input<std::vector<glm::mat2x4>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::mat4x2>)) {
-        program->setUniform<std::vector<glm::mat4x2>>(input->name(), static_cast<Input<std::vector<glm::mat4x2>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::mat3x4>)) {
-        program->setUniform<std::vector<glm::mat3x4>>(input->name(), static_cast<Input<std::vector<glm::mat3x4>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<glm::mat4x3>)) {
-        program->setUniform<std::vector<glm::mat4x3>>(input->name(), static_cast<Input<std::vector<glm::mat4x3>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<gl::GLuint64>)) {
-        program->setUniform<std::vector<gl::GLuint64>>(input->name(), static_cast<Input<std::vector<gl::GLuint64>> *>(input)->value());
-    } else if (input->type() == typeid(std::vector<globjects::TextureHandle>)) {
-        program->setUniform<std::vector<globjects::TextureHandle>>(input->name(), static_cast<Input<std::vector<globjects::TextureHandle>> *>(input)->value());
+        // Camera matrices require a camera, model matrices a model matrix
+        const bool isModel  = (i == ModelMatrix);
+        const bool isCamera = (i < ModelMatrix || i == NormalMatrix);
+
+        if ((isCamera && !camera) || (isModel && !hasModelMatrix) || (!isCamera && !isModel && !(camera && hasModelMatrix)))
+            continue;
+
+        if (i == NormalMatrix)
+            static_cast<globjects::Uniform<glm::mat3> *>(m_transformUniforms[i])->set(normalMatrix);
+        else if (i == ModelNormalMatrix)
+            static_cast<globjects::Uniform<glm::mat3> *>(m_transformUniforms[i])->set(modelNormalMatrix);
+        else
+            static_cast<globjects::Uniform<glm::mat4> *>(m_transformUniforms[i])->set(block.matrices[i]);
+    }
+
+    // Upload 'Transforms' block
+    if (m_useTransformBlock)
+    {
+        for (int column = 0; column < 3; ++column)
+        {
+            block.normalMatrix[column]      = glm::vec4(normalMatrix[column], 0.0f);
+            block.modelNormalMatrix[column] = glm::vec4(modelNormalMatrix[column], 0.0f);
+        }
+
+        m_transformBuffer->setSubData(0, static_cast<gl::GLsizeiptr>(sizeof(TransformBlock)), &block);
     }
 }
 
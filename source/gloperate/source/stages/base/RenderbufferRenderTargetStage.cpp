@@ -8,9 +8,11 @@
 
 #include <globjects/Renderbuffer.h>
 
+#include <gloperate/base/Environment.h>
 #include <gloperate/rendering/ColorRenderTarget.h>
 #include <gloperate/rendering/DepthRenderTarget.h>
 #include <gloperate/rendering/StencilRenderTarget.h>
+#include <gloperate/rendering/FramebufferCache.h>
 
 
 using namespace gl;
@@ -32,17 +34,24 @@ RenderbufferRenderTargetStage::RenderbufferRenderTargetStage(gloperate::Environm
 , colorRenderTarget("colorRenderTarget", this)
 , depthRenderTarget("depthRenderTarget", this)
 , stencilRenderTarget("stencilRenderTarget", this)
+, m_internalFormat(GL_NONE)
 {
 }
 
 RenderbufferRenderTargetStage::~RenderbufferRenderTargetStage()
 {
+    // Release framebuffers if the stage is removed without deinitializing its context
+    if (m_renderbuffer)
+    {
+        environment()->framebufferCache()->remove(m_renderbuffer.get());
+    }
 }
 
 void RenderbufferRenderTargetStage::onContextInit(gloperate::AbstractGLContext *)
 {
     // Create new texture
     m_renderbuffer = cppassist::make_unique<Renderbuffer>();
+    m_internalFormat = GL_NONE;
 
     // Create wrapping render target
     m_colorRenderTarget   = cppassist::make_unique<ColorRenderTarget>();
@@ -57,6 +66,12 @@ void RenderbufferRenderTargetStage::onContextInit(gloperate::AbstractGLContext *
 
 void RenderbufferRenderTargetStage::onContextDeinit(AbstractGLContext *)
 {
+    // Cached framebuffers must not keep the deleted renderbuffer attached
+    if (m_renderbuffer)
+    {
+        environment()->framebufferCache()->remove(m_renderbuffer.get());
+    }
+
     // Clean up OpenGL objects
     m_renderbuffer        = nullptr;
     m_colorRenderTarget   = nullptr;
@@ -77,10 +92,17 @@ void RenderbufferRenderTargetStage::onProcess()
         return;
     }
 
-    // Create texture image
-    const auto width  = (*size)[2];
-    const auto height = (*size)[3];
-    m_renderbuffer->storage(*internalFormat, width, height);
+    // Allocate storage only if size or format have changed
+    const auto width  = static_cast<int>((*size)[2]);
+    const auto height = static_cast<int>((*size)[3]);
+
+    if (m_internalFormat != *internalFormat || m_size != glm::ivec2(width, height))
+    {
+        m_renderbuffer->storage(*internalFormat, width, height);
+
+        m_internalFormat = *internalFormat;
+        m_size           = glm::ivec2(width, height);
+    }
 
     switch(*internalFormat)
     {
@@ -45,7 +45,7 @@ void ShaderStage::onProcess()
     cppassist::warning("gloperate") << "Load shader " << (*filePath).path();
 
     // Load shader
-    m_shader = std::unique_ptr<globjects::Shader>(environment()->resourceManager()->load<globjects::Shader>((*filePath).path()));
+    m_shader = environment()->resourceManager()->loadShared<globjects::Shader>((*filePath).path());
 
     // Update outputs
     shader.setValue(m_shader.get());
@@ -1,6 +1,8 @@
 
 #include <gloperate/stages/base/ShapeStage.h>
 
+#include <algorithm>
+
 #include <glm/vec2.hpp>
 
 #include <cppassist/memory/make_unique.h>
@@ -26,6 +28,7 @@ ShapeStage::ShapeStage(gloperate::Environment * environment, const std::string &
 , height("height", this, 2.0f)
 , depth("depth", this, 2.0f)
 , radius("radius", this, 1.0f)
+, subdivisions("subdivisions", this, 5)
 , texCoords("texCoords", this, true)
 , drawable("drawable", this)
 {
@@ -75,7 +78,7 @@ void ShapeStage::onProcess()
             break;
 
         case ShapeType::Sphere:
-            m_shape = cppassist::make_unique<Sphere>(*this->radius, options);
+            m_shape = cppassist::make_unique<Sphere>(*this->radius, options, static_cast<unsigned int>(std::max(*this->subdivisions, 0)));
             break;
 
         default:
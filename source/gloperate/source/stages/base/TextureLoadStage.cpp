@@ -16,6 +16,7 @@ CPPEXPOSE_COMPONENT(TextureLoadStage, gloperate::Stage)
 TextureLoadStage::TextureLoadStage(Environment * environment, const std::string & name)
 : Stage(environment, "TextureLoadStage", name)
 , filename("filename", this)
+, asynchronous("asynchronous", this, true)
 , texture ("texture", this)
 {
 }
@@ -31,20 +32,71 @@ void TextureLoadStage::onContextInit(AbstractGLContext *)
 
 void TextureLoadStage::onContextDeinit(AbstractGLContext *)
 {
+    // Cancel pending loads, as the texture would be created in the wrong context
+    m_loading = AsyncResource<globjects::Texture>();
+    setAlwaysProcessed(false);
+
     // Clean up OpenGL objects
-    m_texture = nullptr;
+    m_texture     = nullptr;
+    m_placeholder = nullptr;
 
     texture.setValue(nullptr);
 }
 
 void TextureLoadStage::onProcess()
 {
-    // Load texture
-    auto tex = m_environment->resourceManager()->load<globjects::Texture>((*filename).path());
-    m_texture = tex ? std::unique_ptr<globjects::Texture>(tex) : globjects::Texture::createDefault(gl::GL_TEXTURE_2D);
+    if (!m_placeholder)
+    {
+        m_placeholder = globjects::Texture::createDefault(gl::GL_TEXTURE_2D);
+    }
+
+    // Start loading if the file has changed
+    const auto path = (*filename).path();
+
+    if (!m_loading.isValid() || path != m_path)
+    {
+        m_path = path;
+
+        if (*asynchronous)
+        {
+            m_loading = m_environment->resourceManager()->loadAsync<globjects::Texture>(path);
+        }
+        else
+        {
+            m_loading = AsyncResource<globjects::Texture>(m_environment->resourceManager()->loadShared<globjects::Texture>(path));
+        }
+
+        // No suitable loader found
+        if (!m_loading.isValid())
+        {
+            m_loading = AsyncResource<globjects::Texture>(std::shared_ptr<globjects::Texture>());
+        }
+    }
+
+    // Keep rendering with the previous texture until loading has finished
+    if (!m_loading.isReady())
+    {
+        setAlwaysProcessed(true);
+        setTexture(m_texture ? m_texture : m_placeholder);
+
+        return;
+    }
+
+    setAlwaysProcessed(false);
+
+    // Create texture on the context thread
+    const auto loaded = m_loading.get();
+    setTexture(loaded ? loaded : m_placeholder);
+}
 
-    // Update outputs
-    texture.setValue(m_texture.get());
+void TextureLoadStage::setTexture(const std::shared_ptr<globjects::Texture> & newTexture)
+{
+    // Update outputs only if the texture has changed
+    if (m_texture != newTexture || !texture.isValid())
+    {
+        m_texture = newTexture;
+        texture.setValue(m_texture.get());
+    }
 }
 
 
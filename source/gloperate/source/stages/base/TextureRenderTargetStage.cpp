@@ -8,6 +8,8 @@
 
 #include <globjects/Texture.h>
 
+#include <gloperate/base/Environment.h>
+#include <gloperate/pipeline/Pipeline.h>
 #include <gloperate/rendering/ColorRenderTarget.h>
 #include <gloperate/rendering/DepthRenderTarget.h>
 #include <gloperate/rendering/StencilRenderTarget.h>
@@ -30,22 +32,26 @@ TextureRenderTargetStage::TextureRenderTargetStage(gloperate::Environment * envi
 , format("format", this)
 , type("type", this)
 , size("size", this)
+, transient("transient", this, false)
 , texture("texture", this)
 , colorRenderTarget("colorRenderTarget", this)
 , depthRenderTarget("depthRenderTarget", this)
 , stencilRenderTarget("stencilRenderTarget", this)
+, m_texture(nullptr)
 {
 }
 
 TextureRenderTargetStage::~TextureRenderTargetStage()
 {
+    // Return texture to the pool if the stage is removed without deinitializing its context
+    if (m_texture)
+    {
+        environment()->renderTargetPool()->release(this);
+    }
 }
 
 void TextureRenderTargetStage::onContextInit(gloperate::AbstractGLContext *)
 {
-    // Create new texture
-    m_texture = Texture::createDefault(GL_TEXTURE_2D);
-
     // Create wrapping render target
     m_colorRenderTarget   = cppassist::make_unique<ColorRenderTarget>();
     m_depthRenderTarget   = cppassist::make_unique<DepthRenderTarget>();
@@ -59,6 +65,12 @@ void TextureRenderTargetStage::onContextInit(gloperate::AbstractGLContext *)
 
 void TextureRenderTargetStage::onContextDeinit(AbstractGLContext *)
 {
+    // Return texture to the pool
+    if (m_texture)
+    {
+        environment()->renderTargetPool()->release(this);
+    }
+
     // Clean up OpenGL objects
     m_texture             = nullptr;
     m_colorRenderTarget   = nullptr;
@@ -73,16 +85,25 @@ void TextureRenderTargetStage::onContextDeinit(AbstractGLContext *)
 
 void TextureRenderTargetStage::onProcess()
 {
-    // Check if texture has been created successfully
-    if (!m_texture.get())
+    // Check if context has been initialized
+    if (!m_colorRenderTarget.get())
     {
         return;
     }
 
-    // Create texture image
-    const auto width  = (*size)[2];
-    const auto height = (*size)[3];
-    m_texture->image2D(0, *internalFormat, width, height, 0, *format, *type, nullptr);
+    // Determine interval of the stage order in which a transient texture is used
+    RenderTargetPool::Lifetime lifetime = { nullptr, 0, 0 };
+
+    auto pipeline = parentPipeline();
+    if (*transient && pipeline && pipeline->renderTargetLifetime(this, lifetime.first, lifetime.last))
+    {
+        lifetime.scope = pipeline;
+    }
+
+    // Acquire texture (reallocated only if size or format have changed)
+    const auto width  = static_cast<int>((*size)[2]);
+    const auto height = static_cast<int>((*size)[3]);
+    m_texture = environment()->renderTargetPool()->acquire(this, width, height, *internalFormat, *format, *type, lifetime);
 
     switch(*internalFormat)
     {
@@ -93,26 +114,26 @@ void TextureRenderTargetStage::onProcess()
         m_colorRenderTarget->releaseTarget();
         m_stencilRenderTarget->releaseTarget();
 
-        m_depthRenderTarget->setTarget(m_texture.get());
+        m_depthRenderTarget->setTarget(m_texture);
         break;
     case GL_DEPTH_STENCIL:
     case GL_DEPTH24_STENCIL8:
     case GL_DEPTH32F_STENCIL8:
         m_colorRenderTarget->releaseTarget();
 
-        m_depthRenderTarget->setTarget(m_texture.get());
-        m_stencilRenderTarget->setTarget(m_texture.get());
+        m_depthRenderTarget->setTarget(m_texture);
+        m_stencilRenderTarget->setTarget(m_texture);
         break;
     default: // Color attachment
         m_depthRenderTarget->releaseTarget();
         m_stencilRenderTarget->releaseTarget();
 
-        m_colorRenderTarget->setTarget(m_texture.get());
+        m_colorRenderTarget->setTarget(m_texture);
         break;
     }
 
     // Update outputs
-    texture.setValue(m_texture.get());
+    texture.setValue(m_texture);
     colorRenderTarget.setValue(m_colorRenderTarget.get());
     depthRenderTarget.setValue(m_depthRenderTarget.get());
     stencilRenderTarget.setValue(m_stencilRenderTarget.get());
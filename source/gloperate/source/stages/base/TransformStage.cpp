@@ -20,6 +20,7 @@ TransformStage::TransformStage(gloperate::Environment * environment, const std::
 , scale("scale", this, glm::vec3(1.0f, 1.0f, 1.0f))
 , modelMatrix("modelMatrix", this)
 {
+    setCPUOnly(true);
 }
 
 TransformStage::~TransformStage()
@@ -17,6 +17,7 @@ ViewportScaleStage::ViewportScaleStage(Environment * environment, const std::str
 , scaleFactor   ("scaleFactor",     this)
 , scaledViewport("scaledViewport", this)
 {
+    setCPUOnly(true);
 }
 
 ViewportScaleStage::~ViewportScaleStage()
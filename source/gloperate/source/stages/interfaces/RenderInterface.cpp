@@ -10,6 +10,8 @@
 #include <globjects/AttachedRenderbuffer.h>
 #include <globjects/AttachedTexture.h>
 
+#include <gloperate/base/Environment.h>
+#include <gloperate/pipeline/Stage.h>
 #include <gloperate/rendering/RenderTargetType.h>
 #include <gloperate/rendering/ColorRenderTarget.h>
 #include <gloperate/rendering/DepthRenderTarget.h>
@@ -23,6 +25,9 @@ namespace gloperate
 
 RenderInterface::RenderInterface(Stage * stage)
 : viewport("viewport", stage, glm::vec4(0.0, 0.0, -1.0, -1.0))
+, m_stage(stage)
+, m_fbo(nullptr)
+, m_fboGeneration(0)
 {
     // Hide inputs in property editor
     viewport.setOption("hidden", true);
@@ -438,30 +443,47 @@ globjects::Framebuffer * RenderInterface::obtainFBO() const
 {
     assert(allRenderTargetsCompatible());
 
-    std::vector<gl::GLenum> drawBuffers;
-    globjects::Framebuffer * currentFBO = nullptr;
-    auto colorAttachmentIndex = size_t(0);
-    for (auto input : m_colorRenderTargetInputs)
+    m_nextAttachments.clear();
+    m_nextDrawBuffers.clear();
+
+    auto useDefaultFBO = false;
+    auto useUserFBO = false;
+
+    // Collect attachments of all render targets
+    const auto addRenderTarget = [this, &useDefaultFBO, &useUserFBO] (size_t index, AbstractRenderTarget * renderTarget)
     {
-        auto nextFBO = obtainFBO(colorAttachmentIndex, **input);
+        if (!renderTarget)
+        {
+            return false;
+        }
 
-        if (!currentFBO)
+        if (renderTarget->currentTargetType() == RenderTargetType::DefaultFBOAttachment)
         {
-            currentFBO = nextFBO;
+            useDefaultFBO = true;
+            return true;
         }
 
-        if (nextFBO != currentFBO)
+        FramebufferCache::Attachment attachment;
+        if (!FramebufferCache::attachment(index, renderTarget, attachment))
         {
-            return nullptr;
+            return false;
         }
 
-        if (**input)
+        m_nextAttachments.push_back(attachment);
+        useUserFBO = true;
+        return true;
+    };
+
+    auto colorAttachmentIndex = size_t(0);
+    for (auto input : m_colorRenderTargetInputs)
+    {
+        if (addRenderTarget(colorAttachmentIndex, **input))
         {
-            drawBuffers.push_back((**input)->drawBufferAttachment(colorAttachmentIndex));
+            m_nextDrawBuffers.push_back((**input)->drawBufferAttachment(colorAttachmentIndex));
         }
         else
         {
-            drawBuffers.push_back(gl::GL_NONE);
+            m_nextDrawBuffers.push_back(gl::GL_NONE);
         }
 
         ++colorAttachmentIndex;
@@ -469,57 +491,52 @@ globjects::Framebuffer * RenderInterface::obtainFBO() const
 
     for (auto input : m_depthRenderTargetInputs)
     {
-        auto nextFBO = obtainFBO(0, **input);
-
-        if (!currentFBO)
-        {
-            currentFBO = nextFBO;
-        }
-
-        if (nextFBO != currentFBO)
-        {
-            return nullptr;
-        }
+        addRenderTarget(0, **input);
     }
 
     for (auto input : m_depthStencilRenderTargetInputs)
     {
-        auto nextFBO = obtainFBO(0, **input);
+        addRenderTarget(0, **input);
+    }
 
-        if (!currentFBO)
-        {
-            currentFBO = nextFBO;
-        }
+    for (auto input : m_stencilRenderTargetInputs)
+    {
+        addRenderTarget(0, **input);
+    }
 
-        if (nextFBO != currentFBO)
-        {
-            return nullptr;
-        }
+    // Default and user-defined attachments cannot be combined
+    if (useDefaultFBO == useUserFBO)
+    {
+        return nullptr;
     }
 
-    for (auto input : m_stencilRenderTargetInputs)
+    if (useDefaultFBO)
     {
-        auto nextFBO = obtainFBO(0, **input);
+        m_defaultFBO->setDrawBuffers(m_nextDrawBuffers);
 
-        if (!currentFBO)
-        {
-            currentFBO = nextFBO;
-        }
+        return m_defaultFBO.get();
+    }
 
-        if (nextFBO != currentFBO)
-        {
-            return nullptr;
-        }
+    // Reuse framebuffer if render targets did not change
+    const auto cache = m_stage->environment()->framebufferCache();
+
+    if (m_fbo && m_fboGeneration == cache->generation() && m_nextAttachments == m_attachments && m_nextDrawBuffers == m_drawBuffers)
+    {
+        return m_fbo;
     }
 
-    currentFBO->setDrawBuffers(drawBuffers);
+    m_fboGeneration = cache->generation();
+    m_fbo = cache->framebuffer(m_nextAttachments, m_nextDrawBuffers);
+
+    std::swap(m_attachments, m_nextAttachments);
+    std::swap(m_drawBuffers, m_nextDrawBuffers);
 
-    return currentFBO;
+    return m_fbo;
 }
 
 globjects::Framebuffer * RenderInterface::obtainFBO(size_t index, AbstractRenderTarget * renderTarget) const
 {
-    return obtainFBO(index, renderTarget, m_fbo.get(), m_defaultFBO.get());
+    return obtainFBO(index, renderTarget, m_stage->environment()->framebufferCache(), m_defaultFBO.get());
 }
 
 globjects::Framebuffer * RenderInterface::obtainFBO(size_t index, AbstractRenderTarget * renderTarget, globjects::Framebuffer * fbo, globjects::Framebuffer * defaultFBO)
@@ -618,16 +635,43 @@ globjects::Framebuffer * RenderInterface::obtainFBO(size_t index, AbstractRender
     }
 }
 
+globjects::Framebuffer * RenderInterface::obtainFBO(size_t index, AbstractRenderTarget * renderTarget, FramebufferCache * cache, globjects::Framebuffer * defaultFBO)
+{
+    assert(cache);
+
+    if (renderTarget == nullptr)
+    {
+        return nullptr;
+    }
+
+    if (renderTarget->currentTargetType() == RenderTargetType::DefaultFBOAttachment)
+    {
+        return defaultFBO;
+    }
+
+    FramebufferCache::Attachment attachment;
+    if (!FramebufferCache::attachment(index, renderTarget, attachment))
+    {
+        return nullptr;
+    }
+
+    return cache->framebuffer({ attachment }, {});
+}
+
 void RenderInterface::onContextInit()
 {
     m_defaultFBO = globjects::Framebuffer::defaultFBO();
-    m_fbo = cppassist::make_unique<globjects::Framebuffer>();
+    m_fbo = nullptr;
+    m_attachments.clear();
+    m_drawBuffers.clear();
 }
 
 void RenderInterface::onContextDeinit()
 {
     m_defaultFBO = nullptr;
     m_fbo = nullptr;
+    m_attachments.clear();
+    m_drawBuffers.clear();
 }
 
 
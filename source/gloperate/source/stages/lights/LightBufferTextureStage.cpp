@@ -18,6 +18,11 @@ struct ColorTypeEntry
     glm::vec3 color;
     float type;
 };
+
+bool equals(const gloperate::Light & a, const gloperate::Light & b)
+{
+    return a.type == b.type && a.color == b.color && a.position == b.position && a.attenuationCoefficients == b.attenuationCoefficients;
+}
 }
 
 
@@ -58,6 +63,8 @@ void LightBufferTextureStage::onContextDeinit(AbstractGLContext * /*context*/)
     m_positionBuffer.reset();
     m_colorTypeBuffer.reset();
 
+    m_lights.clear();
+
     colorTypeData.setValue(nullptr);
     positionData.setValue(nullptr);
     attenuationData.setValue(nullptr);
@@ -65,29 +72,54 @@ void LightBufferTextureStage::onContextDeinit(AbstractGLContext * /*context*/)
 
 void LightBufferTextureStage::onProcess()
 {
-    if (!colorTypeData.isValid() || !positionData.isValid() || !attenuationData.isValid())
+    if (!m_colorTypeBuffer)
     {
-        setupBufferTextures();
+        return;
     }
 
-    std::vector<ColorTypeEntry> colorsTypes{};
-    std::vector<glm::vec3> positions{};
-    std::vector<glm::vec3> attenuations{};
+    std::vector<Light> lights;
+    lights.reserve(m_lightInputs.size());
 
     for (auto lightInput : m_lightInputs)
     {
         if (!lightInput->isValid())
             continue;
 
-        auto lightDef = lightInput->value();
-        colorsTypes.push_back(ColorTypeEntry{lightDef.color, float(lightDef.type)});
-        positions.push_back(lightDef.position);
-        attenuations.push_back(lightDef.attenuationCoefficients);
+        lights.push_back(lightInput->value());
     }
 
-    m_colorTypeBuffer->setData(colorsTypes, gl::GL_DYNAMIC_DRAW);
-    m_positionBuffer->setData(positions, gl::GL_DYNAMIC_DRAW);
-    m_attenuationBuffer->setData(attenuations, gl::GL_DYNAMIC_DRAW);
+    if (lights.size() != m_lights.size())
+    {
+        // Buffer textures expose the number of lights by their size, so the buffers are reallocated
+        m_colorTypeBuffer->setData(static_cast<gl::GLsizeiptr>(lights.size() * sizeof(ColorTypeEntry)), nullptr, gl::GL_DYNAMIC_DRAW);
+        m_positionBuffer->setData(static_cast<gl::GLsizeiptr>(lights.size() * sizeof(glm::vec3)), nullptr, gl::GL_DYNAMIC_DRAW);
+        m_attenuationBuffer->setData(static_cast<gl::GLsizeiptr>(lights.size() * sizeof(glm::vec3)), nullptr, gl::GL_DYNAMIC_DRAW);
+
+        uploadLights(lights, 0, lights.size());
+    }
+    else
+    {
+        // Upload contiguous ranges of changed lights only
+        size_t i = 0;
+        while (i < lights.size())
+        {
+            if (equals(lights[i], m_lights[i]))
+            {
+                ++i;
+                continue;
+            }
+
+            const size_t first = i;
+            while (i < lights.size() && !equals(lights[i], m_lights[i]))
+            {
+                ++i;
+            }
+
+            uploadLights(lights, first, i - first);
+        }
+    }
+
+    m_lights = std::move(lights);
 
     colorTypeData.setValue(m_colorTypeTexture.get());
     positionData.setValue(m_positionTexture.get());
@@ -108,6 +140,37 @@ void LightBufferTextureStage::setupBufferTextures()
     m_colorTypeTexture->texBuffer(gl::GL_RGBA32F, m_colorTypeBuffer.get());
     m_positionTexture->texBuffer(gl::GL_RGB32F, m_positionBuffer.get());
     m_attenuationTexture->texBuffer(gl::GL_RGB32F, m_attenuationBuffer.get());
+
+    // New buffers are empty
+    m_lights.clear();
+}
+
+void LightBufferTextureStage::uploadLights(const std::vector<Light> & lights, size_t first, size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    std::vector<ColorTypeEntry> colorsTypes;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> attenuations;
+
+    colorsTypes.reserve(count);
+    positions.reserve(count);
+    attenuations.reserve(count);
+
+    for (size_t i = first; i < first + count; ++i)
+    {
+        const auto & lightDef = lights[i];
+        colorsTypes.push_back(ColorTypeEntry{lightDef.color, float(lightDef.type)});
+        positions.push_back(lightDef.position);
+        attenuations.push_back(lightDef.attenuationCoefficients);
+    }
+
+    m_colorTypeBuffer->setSubData(static_cast<gl::GLintptr>(first * sizeof(ColorTypeEntry)), static_cast<gl::GLsizeiptr>(count * sizeof(ColorTypeEntry)), colorsTypes.data());
+    m_positionBuffer->setSubData(static_cast<gl::GLintptr>(first * sizeof(glm::vec3)), static_cast<gl::GLsizeiptr>(count * sizeof(glm::vec3)), positions.data());
+    m_attenuationBuffer->setSubData(static_cast<gl::GLintptr>(first * sizeof(glm::vec3)), static_cast<gl::GLsizeiptr>(count * sizeof(glm::vec3)), attenuations.data());
 }
 
 Input<Light> * LightBufferTextureStage::createLightInput()
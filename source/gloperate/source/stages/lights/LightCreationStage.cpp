@@ -17,6 +17,7 @@ LightCreationStage::LightCreationStage(Environment * environment, const std::str
 , attenuationCoefficients("attenuationCoefficients", this)
 , light("light", this)
 {
+    setCPUOnly(true);
 }
 
 LightCreationStage::~LightCreationStage()
@@ -2,19 +2,54 @@
 #include <gloperate/tools/ImageExporter.h>
 
 #include <cassert>
+#include <algorithm>
 
 #include <cppassist/logging/logging.h>
+#include <cppassist/memory/make_unique.h>
+#include <cppfs/FilePath.h>
 
 #include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
 
 #include <glbinding/gl/gl.h>
 
+#include <globjects/Framebuffer.h>
+
 #include <gloperate/base/Environment.h>
 #include <gloperate/base/Canvas.h>
 #include <gloperate/base/ResourceManager.h>
 #include <gloperate/base/AbstractGLContext.h>
+#include <gloperate/base/logging.h>
+#include <gloperate/rendering/FramebufferCache.h>
+#include <gloperate/pipeline/Pipeline.h>
+#include <gloperate/pipeline/Input.h>
 
-#include <globjects/Framebuffer.h>
+
+namespace
+{
+    const int s_defaultMaxTileSize = 4096;
+    const int s_bytesPerPixel      = 3;
+
+    // Find inputs 'tileMatrix' of a stage and its substages that are not set by a connection
+    void findTileMatrixInputs(gloperate::Stage * stage, std::vector<gloperate::Input<glm::mat4> *> & inputs)
+    {
+        stage->forAllInputs<glm::mat4>([&inputs] (gloperate::Input<glm::mat4> * input)
+        {
+            if (input->name() == "tileMatrix" && !input->isConnected())
+            {
+                inputs.push_back(input);
+            }
+        });
+
+        if (stage->isPipeline())
+        {
+            for (auto subStage : static_cast<gloperate::Pipeline *>(stage)->stages())
+            {
+                findTileMatrixInputs(subStage, inputs);
+            }
+        }
+    }
+}
 
 
 namespace gloperate
@@ -27,6 +62,11 @@ ImageExporter::ImageExporter()
 , m_width(0)
 , m_height(0)
 , m_renderIterations(0)
+, m_maxTileSize(s_defaultMaxTileSize)
+, m_tileWidth(0)
+, m_tileHeight(0)
+, m_topDown(true)
+, m_dataOffset(0)
 {
 }
 
@@ -44,55 +84,255 @@ void ImageExporter::setTarget(Canvas * canvas, const std::string & filename, int
     m_renderIterations = renderIterations;
 }
 
-void ImageExporter::save(ImageExporter::ContextHandling)
+int ImageExporter::maxTileSize() const
+{
+    return m_maxTileSize;
+}
+
+void ImageExporter::setMaxTileSize(int maxTileSize)
 {
-    cppassist::critical("gloperate") << "ImageExporter::save currently not implemented.";
-    // [TODO] Reimplement
+    m_maxTileSize = maxTileSize;
+}
+
+void ImageExporter::save(ImageExporter::ContextHandling contextHandling)
+{
+    assert(m_canvas);
+
+    // Use current viewport size if no size has been specified
+    const auto oldViewport = m_canvas->viewport();
+    const int width  = m_width  > 0 ? m_width  : static_cast<int>(oldViewport.z);
+    const int height = m_height > 0 ? m_height : static_cast<int>(oldViewport.w);
+
+    if (width <= 0 || height <= 0 || !m_canvas->renderStage())
+    {
+        cppassist::critical("gloperate") << "ImageExporter: invalid image size or no render stage.";
+        return;
+    }
+
+    // Check output file format
+    auto extension = cppfs::FilePath(m_filename).extension();
+    auto pos = extension.find_last_of('.');
+    if (pos != std::string::npos)
+    {
+        extension = extension.substr(pos + 1);
+    }
+
+    const bool streamed = (extension == "ppm" || extension == "raw");
+    m_topDown = (extension != "raw");
+
+    // Activate context (if necessary)
+    if (contextHandling == ActivateContext)
+    {
+        m_canvas->openGLContext()->use();
+    }
+
+    // Split image into n x n tiles, so that each tile has the aspect ratio of the image
+    const int tileSize  = std::max(1, std::min(m_maxTileSize, supportedTileSize()));
+    const int numTiles  = (std::max(width, height) + tileSize - 1) / tileSize;
+    m_tileWidth  = (width  + numTiles - 1) / numTiles;
+    m_tileHeight = (height + numTiles - 1) / numTiles;
+
+    std::vector<Input<glm::mat4> *> tileMatrixInputs;
+    findTileMatrixInputs(m_canvas->renderStage(), tileMatrixInputs);
+
+    if (numTiles > 1 && tileMatrixInputs.empty())
+    {
+        cppassist::critical("gloperate") << "ImageExporter: image exceeds tile size of " << tileSize << " pixels, but no stage has an input 'tileMatrix'.";
+    }
+    else if (numTiles > 1 && !streamed)
+    {
+        cppassist::critical("gloperate") << "ImageExporter: tiled export is only supported for .ppm and .raw files.";
+    }
+    else if (!streamed)
+    {
+        // Render single image and pass it to the resource manager
+        createFramebuffer(width, height);
+        renderTile();
+
+        m_canvas->environment()->resourceManager()->store<globjects::Texture>(m_filename, m_color.get());
+    }
+    else
+    {
+        std::ofstream file;
+
+        if (openFile(file, width, height))
+        {
+            createFramebuffer(m_tileWidth, m_tileHeight);
+            m_tileData.resize(static_cast<size_t>(m_tileWidth) * m_tileHeight * s_bytesPerPixel);
+
+            for (int tileY = 0; tileY < numTiles; ++tileY)
+            {
+                for (int tileX = 0; tileX < numTiles; ++tileX)
+                {
+                    const auto tileMatrix = computeTileMatrix(width, height, tileX * m_tileWidth, tileY * m_tileHeight);
+
+                    for (auto input : tileMatrixInputs)
+                    {
+                        input->setValue(tileMatrix);
+                    }
+
+                    renderTile();
+                    writeTile(file, width, height, tileX * m_tileWidth, tileY * m_tileHeight);
+                }
+            }
+
+            if (!file)
+            {
+                cppassist::critical("gloperate") << "ImageExporter: could not write '" << m_filename << "'.";
+            }
+
+            GLOPERATE_DEBUG(1) << "ImageExporter: exported " << width << "x" << height << " image in " << numTiles * numTiles << " tiles to '" << m_filename << "'.";
+        }
+    }
+
+    // Release tile data
+    m_tileData.clear();
+    m_tileData.shrink_to_fit();
+
+    // Cached framebuffers must not keep the deleted attachments
+    if (m_color)
+    {
+        m_canvas->environment()->framebufferCache()->remove(m_color.get());
+    }
 
-    /*
+    if (m_depth)
+    {
+        m_canvas->environment()->framebufferCache()->remove(m_depth.get());
+    }
+
+    m_fbo   = nullptr;
+    m_color = nullptr;
+    m_depth = nullptr;
+
+    // Release context (if necessary)
+    if (contextHandling == ActivateContext)
+    {
+        m_canvas->openGLContext()->release();
+    }
+
+    // Reset tile matrix and viewport
+    for (auto input : tileMatrixInputs)
+    {
+        input->setValue(glm::mat4(1.0f));
+    }
+
+    m_canvas->setViewport(oldViewport);
+}
+
+int ImageExporter::supportedTileSize() const
+{
+    gl::GLint viewportDims[2] = { 0, 0 };
+    gl::GLint textureSize      = 0;
+    gl::GLint renderbufferSize = 0;
+
+    gl::glGetIntegerv(gl::GL_MAX_VIEWPORT_DIMS,     viewportDims);
+    gl::glGetIntegerv(gl::GL_MAX_TEXTURE_SIZE,      &textureSize);
+    gl::glGetIntegerv(gl::GL_MAX_RENDERBUFFER_SIZE, &renderbufferSize);
+
+    return std::min({ viewportDims[0], viewportDims[1], textureSize, renderbufferSize });
+}
+
+glm::mat4 ImageExporter::computeTileMatrix(int width, int height, int x, int y) const
+{
+    const auto imageWidth  = static_cast<float>(width);
+    const auto imageHeight = static_cast<float>(height);
+    const auto tileWidth   = static_cast<float>(m_tileWidth);
+    const auto tileHeight  = static_cast<float>(m_tileHeight);
+
+    // The projection is computed for the viewport of a tile. Tiles at the
+    // border are padded, so their aspect ratio can differ slightly from
+    // the one of the image, which is compensated horizontally.
+    const auto aspectCorrection = (tileWidth / tileHeight) / (imageWidth / imageHeight);
+
+    // Map clip space of the exact image onto clip space of the tile
+    glm::mat4 tileMatrix(1.0f);
+    tileMatrix[0][0] = imageWidth  / tileWidth * aspectCorrection;
+    tileMatrix[1][1] = imageHeight / tileHeight;
+    tileMatrix[3][0] = (imageWidth  - 2.0f * x - tileWidth)  / tileWidth;
+    tileMatrix[3][1] = (imageHeight - 2.0f * y - tileHeight) / tileHeight;
+
+    return tileMatrix;
+}
+
+void ImageExporter::createFramebuffer(int width, int height)
+{
     // Create output textures
-    m_color = std::unique_ptr<globjects::Texture>(globjects::Texture::createDefault(gl::GL_TEXTURE_2D));
+    m_color = globjects::Texture::createDefault(gl::GL_TEXTURE_2D);
     m_depth = cppassist::make_unique<globjects::Renderbuffer>();
 
+    m_color->image2D(0, gl::GL_RGBA8, width, height, 0, gl::GL_RGBA, gl::GL_UNSIGNED_BYTE, nullptr);
+    m_depth->storage(gl::GL_DEPTH_COMPONENT32, width, height);
+
     // Create output FBO
     m_fbo = cppassist::make_unique<globjects::Framebuffer>();
     m_fbo->attachTexture(gl::GL_COLOR_ATTACHMENT0, m_color.get());
     m_fbo->attachRenderBuffer(gl::GL_DEPTH_ATTACHMENT, m_depth.get());
 
     // Set viewport
-    auto viewport = glm::vec4(0, 0, m_width, m_height);
-    m_canvas->onSaveViewport();
-    m_canvas->onViewport(viewport, viewport);
+    m_canvas->setViewport(glm::vec4(0, 0, width, height));
+}
 
-    // Activate context (if necessary)
-    if (contextHandling == ActivateContext)
+void ImageExporter::renderTile()
+{
+    // Render tile (several times for multi-frame effects)
+    for (int i = 0; i < std::max(1, m_renderIterations); ++i)
     {
-        m_canvas->openGLContext()->use();
+        m_canvas->updateTime();
+        m_canvas->render(m_fbo.get());
     }
+}
 
-    // Initialize textures
-    m_color->image2D(0, gl::GL_RGBA, m_width, m_height, 0, gl::GL_RGBA, gl::GL_UNSIGNED_BYTE, nullptr);
-    m_depth->storage(gl::GL_DEPTH_COMPONENT32, m_width, m_height);
+bool ImageExporter::openFile(std::ofstream & file, int width, int height)
+{
+    file.open(m_filename, std::ios::out | std::ios::binary | std::ios::trunc);
 
-    // Render image
-    for (int i = 0; i < m_renderIterations; ++i)
+    if (!file.is_open())
     {
-        m_canvas->environment()->update(1.f / 30.f);
-        m_canvas->onRender(m_fbo.get());
+        cppassist::critical("gloperate") << "ImageExporter: could not open '" << m_filename << "' for writing.";
+        return false;
     }
 
-    // Release context (if necessary)
-    if (contextHandling == ActivateContext)
+    // Write PPM header
+    if (m_topDown)
     {
-        m_canvas->openGLContext()->release();
+        file << "P6\n" << width << " " << height << "\n255\n";
     }
 
-    // Save texture to image file
-    m_canvas->environment()->resourceManager()->store<globjects::Texture>(m_filename, m_color.get());
+    m_dataOffset = file.tellp();
 
-    // Reset viewport
-    m_canvas->onResetViewport();
-    */
+    return static_cast<bool>(file);
+}
+
+void ImageExporter::writeTile(std::ofstream & file, int width, int height, int x, int y)
+{
+    // Crop tiles at the right and top border of the image
+    const int columns = std::min(m_tileWidth,  width  - x);
+    const int rows    = std::min(m_tileHeight, height - y);
+
+    if (columns <= 0 || rows <= 0)
+    {
+        return;
+    }
+
+    // Read back tile with tightly packed rows, restoring the caller's pack state afterwards
+    gl::GLint packAlignment = 4;
+    gl::glGetIntegerv(gl::GL_PACK_ALIGNMENT, &packAlignment);
+
+    gl::glPixelStorei(gl::GL_PACK_ALIGNMENT, 1);
+    m_color->getImage(0, gl::GL_RGB, gl::GL_UNSIGNED_BYTE, m_tileData.data());
+    gl::glPixelStorei(gl::GL_PACK_ALIGNMENT, packAlignment);
+
+    // Write rows of the tile to their position in the file
+    const auto rowSize = static_cast<std::streamsize>(columns) * s_bytesPerPixel;
+
+    for (int row = 0; row < rows; ++row)
+    {
+        const int imageRow = m_topDown ? (height - 1 - (y + row)) : (y + row);
+        const auto offset  = m_dataOffset + (static_cast<std::streamoff>(imageRow) * width + x) * s_bytesPerPixel;
+
+        file.seekp(offset);
+        file.write(reinterpret_cast<const char *>(m_tileData.data()) + static_cast<size_t>(row) * m_tileWidth * s_bytesPerPixel, rowSize);
+    }
 }
 
 
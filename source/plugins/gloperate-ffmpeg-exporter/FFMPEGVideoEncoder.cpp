@@ -36,6 +36,7 @@ FFMPEGVideoEncoder::FFMPEGVideoEncoder()
 : m_context(nullptr)
 , m_videoStream(nullptr)
 , m_frame(nullptr)
+, m_converter(nullptr)
 , m_frameCounter(0)
 {
     // Register codecs and formats
@@ -45,6 +46,9 @@ FFMPEGVideoEncoder::FFMPEGVideoEncoder()
 
 FFMPEGVideoEncoder::~FFMPEGVideoEncoder()
 {
+    if (m_converter) {
+        sws_freeContext(m_converter);
+    }
 }
 
 bool FFMPEGVideoEncoder::initEncoding(const cppexpose::VariantMap & parameters)
@@ -153,29 +157,61 @@ bool FFMPEGVideoEncoder::initEncoding(const cppexpose::VariantMap & parameters)
     return true;
 }
 
-void FFMPEGVideoEncoder::putFrame(const gloperate::Image & image)
+void FFMPEGVideoEncoder::putFrame(const gloperate::Image & image, bool bottomUp)
 {
-    if (image.format() == gl::GL_RGB)
+    if (image.type() != gl::GL_UNSIGNED_BYTE)
     {
-        putFrame(image.data(), image.width(), image.height());
-    } else {
-        critical() << "Image format not supported.";
+        critical() << "Image type not supported.";
+        return;
     }
+
+    putFrame(image.data(), image.width(), image.height(), image.format(), bottomUp);
 }
 
 void FFMPEGVideoEncoder::putFrame(const char * data, int width, int height)
 {
-    // Put input image into picture structure
-    AVPicture inputPicture;
-    avpicture_fill(&inputPicture, (uint8_t*)data, AV_PIX_FMT_RGB24, width, height);
+    putFrame(data, width, height, gl::GL_RGB, false);
+}
 
-    // Convert input image to output frame
-    SwsContext * converter = sws_getContext(width,                     height,                     AV_PIX_FMT_RGB24,
-                                            m_videoStream->codec->width, m_videoStream->codec->height, AV_PIX_FMT_YUV420P,
-                                            SWS_BICUBIC, NULL, NULL, NULL);
+void FFMPEGVideoEncoder::putFrame(const char * data, int width, int height, gl::GLenum format, bool bottomUp)
+{
+    // Determine input pixel format
+    AVPixelFormat inputFormat;
+    int           bytesPerPixel;
+
+    switch (format)
+    {
+    case gl::GL_RGB:  inputFormat = AV_PIX_FMT_RGB24; bytesPerPixel = 3; break;
+    case gl::GL_BGR:  inputFormat = AV_PIX_FMT_BGR24; bytesPerPixel = 3; break;
+    case gl::GL_RGBA: inputFormat = AV_PIX_FMT_RGBA;  bytesPerPixel = 4; break;
+    case gl::GL_BGRA: inputFormat = AV_PIX_FMT_BGRA;  bytesPerPixel = 4; break;
+    default:
+        critical() << "Image format not supported.";
+        return;
+    }
+
+    // Get conversion context, which is only recreated if size or format have changed
+    m_converter = sws_getCachedContext(m_converter,
+                                       width,                       height,                       inputFormat,
+                                       m_videoStream->codec->width, m_videoStream->codec->height, AV_PIX_FMT_YUV420P,
+                                       SWS_BICUBIC, NULL, NULL, NULL);
+
+    if (!m_converter) {
+        critical() << "Could not create conversion context";
+        return;
+    }
 
-    sws_scale(converter, inputPicture.data, inputPicture.linesize, 0, height, m_frame->data, m_frame->linesize);
-    sws_freeContext(converter);
+    // Describe input rows, start at the last row with negative stride to flip vertically
+    const uint8_t * inputData[1]     = { reinterpret_cast<const uint8_t *>(data) };
+    int             inputLinesize[1] = { width * bytesPerPixel };
+
+    if (bottomUp) {
+        inputData[0]     += (height - 1) * inputLinesize[0];
+        inputLinesize[0]  = -inputLinesize[0];
+    }
+
+    // Convert input image to output frame
+    sws_scale(m_converter, inputData, inputLinesize, 0, height, m_frame->data, m_frame->linesize);
 
     // Set frame info
     m_frame->width  = m_videoStream->codec->width;
@@ -246,6 +282,13 @@ void FFMPEGVideoEncoder::finishEncoding()
     if (m_frame) {
         av_free(m_frame->data[0]);
         av_free(m_frame);
+        m_frame = nullptr;
+    }
+
+    // Release conversion context
+    if (m_converter) {
+        sws_freeContext(m_converter);
+        m_converter = nullptr;
     }
 
     // Release video streams
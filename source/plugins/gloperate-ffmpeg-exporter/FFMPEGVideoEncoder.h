@@ -12,6 +12,7 @@
 class AVFormatContext;
 class AVStream;
 class AVFrame;
+struct SwsContext;
 
 
 /**
@@ -49,9 +50,12 @@ public:
     *    Put frame into video
     *
     *  @param[in] image
-    *    Frame as gloperate::Image
+    *    Frame as gloperate::Image (GL_RGB, GL_BGR, GL_RGBA or GL_BGRA with GL_UNSIGNED_BYTE)
+    *
+    *  @param[in] bottomUp
+    *    'true' if the rows are stored bottom-up (as read back from OpenGL), else 'false'
     */
-    void putFrame(const gloperate::Image & image);
+    void putFrame(const gloperate::Image & image, bool bottomUp = false);
 
     /**
     *  @brief
@@ -68,6 +72,32 @@ public:
     */
     void putFrame(const char * data, int width, int height);
 
+    /**
+    *  @brief
+    *    Put frame into video
+    *
+    *  @param[in] data
+    *    Byte data of single frame, tightly packed
+    *
+    *  @param[in] width
+    *    Frame pixel width
+    *
+    *  @param[in] height
+    *    Frame pixel height
+    *
+    *  @param[in] format
+    *    Pixel format (GL_RGB, GL_BGR, GL_RGBA or GL_BGRA with one byte per channel)
+    *
+    *  @param[in] bottomUp
+    *    'true' if the rows are stored bottom-up, else 'false'
+    *
+    *  @remarks
+    *    The conversion context is created once and reused as long as
+    *    size and format of the frames do not change. A bottom-up frame
+    *    is flipped during conversion.
+    */
+    void putFrame(const char * data, int width, int height, gl::GLenum format, bool bottomUp);
+
     /**
     *  @brief
     *    Finalize encoding and close video file
@@ -79,5 +109,6 @@ protected:
     AVFormatContext * m_context;
     AVStream        * m_videoStream;
     AVFrame         * m_frame;
+    SwsContext      * m_converter;
     int               m_frameCounter;
 };
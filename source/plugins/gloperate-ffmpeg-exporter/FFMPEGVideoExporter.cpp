@@ -1,60 +1,36 @@
 
 #include "FFMPEGVideoExporter.h"
 
-#include <glm/vec2.hpp>
+#include <algorithm>
+#include <array>
 
 #include <cppassist/memory/make_unique.h>
 
 #include <glbinding/gl/gl.h>
 
 #include <globjects/base/baselogging.h>
-#include <globjects/base/File.h>
-#include <globjects/base/StringTemplate.h>
-#include <globjects/base/StaticStringSource.h>
-#include <globjects/VertexAttributeBinding.h>
-#include <globjects/Shader.h>
 #include <globjects/Buffer.h>
 
 #include <gloperate/gloperate.h>
 #include <gloperate/base/Environment.h>
 #include <gloperate/base/Canvas.h>
 #include <gloperate/base/AbstractGLContext.h>
+#include <gloperate/rendering/FramebufferCache.h>
 
 
 using namespace globjects;
 using namespace gloperate;
 
 
-static const char * s_vertexShader = R"(
-    #version 140
-    #extension GL_ARB_explicit_attrib_location : require
+// Format of frames read back for encoding (rows are bottom-up and flipped by the encoder)
+static const gl::GLenum s_frameFormat = gl::GL_RGBA;
+static const gl::GLenum s_frameType   = gl::GL_UNSIGNED_BYTE;
 
-    layout (location = 0) in vec2 a_vertex;
-    out vec2 v_uv;
+// Number of frames that can be read back asynchronously at the same time
+static const size_t s_numReadbackBuffers = 3;
 
-    void main()
-    {
-        v_uv = a_vertex * 0.5 + 0.5;
-        v_uv.y = 1.0 - v_uv.y;
-        gl_Position = vec4(a_vertex, 0.0, 1.0);
-    }
-)";
-
-static const char * s_fragmentShader = R"(
-    #version 140
-    #extension GL_ARB_explicit_attrib_location : require
-
-    uniform sampler2D source;
-
-    layout (location = 0) out vec4 fragColor;
-
-    in vec2 v_uv;
-
-    void main()
-    {
-        fragColor = texture(source, v_uv);
-    }
-)";
+// Number of read back frames that can wait for the encoder thread
+static const size_t s_maxQueuedFrames = 4;
 
 
 CPPEXPOSE_COMPONENT(FFMPEGVideoExporter, gloperate::AbstractVideoExporter)
@@ -63,17 +39,21 @@ CPPEXPOSE_COMPONENT(FFMPEGVideoExporter, gloperate::AbstractVideoExporter)
 FFMPEGVideoExporter::FFMPEGVideoExporter()
 : m_videoEncoder(new FFMPEGVideoEncoder)
 , m_canvas(nullptr)
-, m_image(nullptr)
+, m_nextReadback(0)
+, m_pendingReadbacks(0)
+, m_encoding(false)
 , m_progress(0)
 , m_initialized(false)
+, m_failed(false)
 , m_contextHandling(AbstractVideoExporter::IgnoreContext)
 {
 }
 
 FFMPEGVideoExporter::~FFMPEGVideoExporter()
 {
+    stopEncoderThread();
+
     delete m_videoEncoder;
-    delete m_image;
 }
 
 void FFMPEGVideoExporter::setTarget(gloperate::Canvas * canvas, const cppexpose::VariantMap & parameters)
@@ -82,19 +62,19 @@ void FFMPEGVideoExporter::setTarget(gloperate::Canvas * canvas, const cppexpose:
     m_canvas     = canvas;
     m_parameters = parameters;
     m_progress   = 0;
+    m_failed     = false;
 }
 
 void FFMPEGVideoExporter::createVideo(AbstractVideoExporter::ContextHandling contextHandling, std::function<void(int, int)> progress)
 {
-    auto width = m_parameters.at("width").toULongLong();
-    auto height = m_parameters.at("height").toULongLong();
-    auto viewport = glm::vec4(0, 0, width, height);
-
     auto fps = m_parameters.at("fps").toULongLong();
     auto length = m_parameters.at("duration").toULongLong() * fps;
     //auto timeDelta = 1.f / static_cast<float>(fps);
 
-    initialize(contextHandling);
+    if (!initialize(contextHandling))
+    {
+        return;
+    }
 
     for (unsigned int i = 0; i < length; ++i)
     {
@@ -104,31 +84,7 @@ void FFMPEGVideoExporter::createVideo(AbstractVideoExporter::ContextHandling con
 
         m_canvas->render(m_fbo.get());
 
-        m_fbo_quad->bind(gl::GL_FRAMEBUFFER);
-
-        gl::glViewport(
-            viewport.x,
-            viewport.y,
-            viewport.z,
-            viewport.w
-        );
-
-        gl::glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        gl::glClear(gl::GL_COLOR_BUFFER_BIT | gl::GL_DEPTH_BUFFER_BIT);
-
-        m_color->bindActive(0);
-
-        m_program->use();
-        m_vao->drawArrays(gl::GL_TRIANGLE_STRIP, 0, 4);
-        m_program->release();
-
-        m_color->unbindActive(0);
-
-        Framebuffer::unbind(gl::GL_FRAMEBUFFER);
-
-        m_color_quad->getImage(0, m_image->format(), m_image->type(), m_image->data());
-
-        m_videoEncoder->putFrame(*m_image);
+        readbackFrame();
 
         m_progress = i*100/length;
         progress(i, length);
@@ -142,12 +98,23 @@ void FFMPEGVideoExporter::createVideo(AbstractVideoExporter::ContextHandling con
 
 void FFMPEGVideoExporter::onRender(ContextHandling contextHandling, globjects::Framebuffer * targetFBO, bool shouldFinalize)
 {
+    // Render without exporting if the encoder could not be initialized for this target
+    if (m_failed)
+    {
+        m_canvas->render(targetFBO);
+        return;
+    }
+
     if (!m_initialized)
     {
         // Overwrite fps in async mode to not slow down/speed up video
         m_parameters.at("fps") = 60;
-        
-        initialize(contextHandling);
+
+        if (!initialize(contextHandling))
+        {
+            m_canvas->render(targetFBO);
+            return;
+        }
     }
 
     auto width = m_parameters.at("width").toULongLong();
@@ -162,32 +129,8 @@ void FFMPEGVideoExporter::onRender(ContextHandling contextHandling, globjects::F
     std::array<gl::GLint, 4> destRect = {{int(destVP.x), int(destVP.y), int(destVP.z), int(destVP.w)}};
 
     m_fbo->blit(gl::GL_COLOR_ATTACHMENT0, srcRect, targetFBO, gl::GL_COLOR_ATTACHMENT0, destRect, gl::GL_COLOR_BUFFER_BIT, gl::GL_LINEAR);
-    
-    m_fbo_quad->bind(gl::GL_FRAMEBUFFER);
-
-    gl::glViewport(
-        viewport.x,
-        viewport.y,
-        viewport.z,
-        viewport.w
-    );
-
-    gl::glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    gl::glClear(gl::GL_COLOR_BUFFER_BIT | gl::GL_DEPTH_BUFFER_BIT);
-
-    m_color->bindActive(0);
-
-    m_program->use();
-    m_vao->drawArrays(gl::GL_TRIANGLE_STRIP, 0, 4);
-    m_program->release();
-
-    m_color->unbindActive(0);
-
-    Framebuffer::unbind(gl::GL_FRAMEBUFFER);
 
-    m_color_quad->getImage(0, m_image->format(), m_image->type(), m_image->data());
-
-    m_videoEncoder->putFrame(*m_image);
+    readbackFrame();
 
     if (shouldFinalize)
     {
@@ -200,8 +143,17 @@ int FFMPEGVideoExporter::progress() const
     return m_progress;
 }
 
-void FFMPEGVideoExporter::initialize(ContextHandling contextHandling)
+bool FFMPEGVideoExporter::initialize(ContextHandling contextHandling)
 {
+    // Initialize encoder first, so nothing has to be undone if it fails
+    if (!m_videoEncoder->initEncoding(m_parameters))
+    {
+        critical() << "Error in initializing video encoding.";
+
+        m_failed = true;
+        return false;
+    }
+
     m_contextHandling = contextHandling;
 
     auto width = m_parameters.at("width").toULongLong();
@@ -209,8 +161,7 @@ void FFMPEGVideoExporter::initialize(ContextHandling contextHandling)
 
     auto viewport = glm::vec4(0, 0, width, height);
 
-    createAndSetupGeometry();
-    createAndSetupShader();
+    createAndSetupFramebuffer();
     createAndSetupBuffer();
 
     m_fbo->clearBuffer(gl::GL_COLOR, 0, glm::vec4{1.0f, 1.0f, 1.0f, 1.0f});
@@ -224,17 +175,23 @@ void FFMPEGVideoExporter::initialize(ContextHandling contextHandling)
         m_canvas->openGLContext()->use();
     }
 
-    if (!m_videoEncoder->initEncoding(m_parameters))
-    {
-        critical() << "Error in initializing video encoding.";
-        return;
-    }
+    startEncoderThread();
 
     m_initialized = true;
+
+    return true;
 }
 
 void FFMPEGVideoExporter::finalize()
 {
+    // Pass all pending readbacks to the encoder and wait until they are encoded
+    while (m_pendingReadbacks > 0)
+    {
+        finishReadback(true);
+    }
+
+    stopEncoderThread();
+
     m_videoEncoder->finishEncoding();
 
     if (m_contextHandling == AbstractVideoExporter::ActivateContext)
@@ -244,54 +201,38 @@ void FFMPEGVideoExporter::finalize()
 
     m_canvas->setViewport(m_savedViewport);
 
+    releaseFramebuffer();
+
     m_initialized = false;
 }
 
-void FFMPEGVideoExporter::createAndSetupGeometry()
+void FFMPEGVideoExporter::createAndSetupFramebuffer()
 {
-    static const std::array<glm::vec2, 4> raw { {
-        glm::vec2( +1.f, -1.f ),
-        glm::vec2( +1.f, +1.f ),
-        glm::vec2( -1.f, -1.f ),
-        glm::vec2( -1.f, +1.f ) } };
-        
+    releaseFramebuffer();
+
     m_fbo = cppassist::make_unique<Framebuffer>();
     m_color = Texture::createDefault(gl::GL_TEXTURE_2D);
     m_depth = cppassist::make_unique<Renderbuffer>();
     m_fbo->attachTexture(gl::GL_COLOR_ATTACHMENT0, m_color.get());
     m_fbo->attachRenderBuffer(gl::GL_DEPTH_ATTACHMENT, m_depth.get());
-
-    m_fbo_quad = cppassist::make_unique<Framebuffer>();
-    m_color_quad = Texture::createDefault(gl::GL_TEXTURE_2D);
-    m_depth_quad = cppassist::make_unique<Renderbuffer>();
-    m_fbo_quad->attachTexture(gl::GL_COLOR_ATTACHMENT0, m_color_quad.get());
-    m_fbo_quad->attachRenderBuffer(gl::GL_DEPTH_ATTACHMENT, m_depth_quad.get());
-    
-    m_vao = cppassist::make_unique<VertexArray>();
-    m_buffer = cppassist::make_unique<Buffer>();
-    m_buffer->setData(raw, gl::GL_STATIC_DRAW); //needed for some drivers
-    auto binding = m_vao->binding(0);
-    binding->setAttribute(0);
-    binding->setBuffer(m_buffer.get(), 0, sizeof(glm::vec2));
-    binding->setFormat(2, gl::GL_FLOAT, gl::GL_FALSE, 0);
-    m_vao->enable(0);
 }
 
-void FFMPEGVideoExporter::createAndSetupShader()
+void FFMPEGVideoExporter::releaseFramebuffer()
 {
-    StringTemplate * vertexShaderSource   = new StringTemplate(new StaticStringSource(s_vertexShader  ));
-    StringTemplate * fragmentShaderSource = new StringTemplate(new StaticStringSource(s_fragmentShader));
-
-#ifdef __APPLE__
-    vertexShaderSource  ->replace("#version 140", "#version 150");
-    fragmentShaderSource->replace("#version 140", "#version 150");
-#endif
-
-    auto vertexShader   = new Shader(gl::GL_VERTEX_SHADER,   vertexShaderSource);
-    auto fragmentShader = new Shader(gl::GL_FRAGMENT_SHADER, fragmentShaderSource);
-    m_program = cppassist::make_unique<Program>();
-    m_program->attach(vertexShader, fragmentShader);
-    m_program->setUniform("source", 0);
+    // Cached framebuffers must not keep the deleted attachments
+    if (m_color)
+    {
+        m_canvas->environment()->framebufferCache()->remove(m_color.get());
+    }
+
+    if (m_depth)
+    {
+        m_canvas->environment()->framebufferCache()->remove(m_depth.get());
+    }
+
+    m_fbo   = nullptr;
+    m_color = nullptr;
+    m_depth = nullptr;
 }
 
 void FFMPEGVideoExporter::createAndSetupBuffer()
@@ -299,11 +240,190 @@ void FFMPEGVideoExporter::createAndSetupBuffer()
     auto width = m_parameters.at("width").toULongLong();
     auto height = m_parameters.at("height").toULongLong();
 
-    m_image = new Image(width, height, gl::GL_RGB, gl::GL_UNSIGNED_BYTE);
+    m_color->image2D(0, gl::GL_RGBA8, width, height, 0, s_frameFormat, s_frameType, nullptr);
+    m_depth->storage(gl::GL_DEPTH_COMPONENT32, width, height);
 
-    m_color->image2D(0, m_image->format(), m_image->width(), m_image->height(), 0, m_image->format(), m_image->type(), nullptr);
-    m_depth->storage(gl::GL_DEPTH_COMPONENT32, m_image->width(), m_image->height());
+    // Create readback ring
+    const auto frameSize = width * height * Image::channels(s_frameFormat) * Image::bytes(s_frameType);
 
-    m_color_quad->image2D(0, m_image->format(), m_image->width(), m_image->height(), 0, m_image->format(), m_image->type(), nullptr);
-    m_depth_quad->storage(gl::GL_DEPTH_COMPONENT32, m_image->width(), m_image->height());
+    m_readbackBuffers.clear();
+    m_readbackFences.clear();
+    for (size_t i = 0; i < s_numReadbackBuffers; ++i)
+    {
+        auto buffer = cppassist::make_unique<Buffer>();
+        buffer->setData(static_cast<gl::GLsizeiptr>(frameSize), nullptr, gl::GL_STREAM_READ);
+
+        m_readbackBuffers.push_back(std::move(buffer));
+        m_readbackFences.push_back(nullptr);
+    }
+
+    m_nextReadback     = 0;
+    m_pendingReadbacks = 0;
+}
+
+void FFMPEGVideoExporter::readbackFrame()
+{
+    // Make room in the ring, waiting only if the GPU is too far behind
+    if (m_pendingReadbacks == m_readbackBuffers.size())
+    {
+        finishReadback(true);
+    }
+
+    // Copy frame into pixel pack buffer asynchronously
+    const auto index = m_nextReadback;
+
+    m_readbackBuffers[index]->bind(gl::GL_PIXEL_PACK_BUFFER);
+    m_color->getImage(0, s_frameFormat, s_frameType, nullptr);
+    Buffer::unbind(gl::GL_PIXEL_PACK_BUFFER);
+
+    m_readbackFences[index] = Sync::fence(gl::GL_SYNC_GPU_COMMANDS_COMPLETE);
+
+    m_nextReadback = (m_nextReadback + 1) % m_readbackBuffers.size();
+    m_pendingReadbacks++;
+
+    // Pass frames of previous readbacks that are already finished
+    while (finishReadback(false))
+    {
+    }
+}
+
+bool FFMPEGVideoExporter::finishReadback(bool wait)
+{
+    if (m_pendingReadbacks == 0)
+    {
+        return false;
+    }
+
+    const auto index = (m_nextReadback + m_readbackBuffers.size() - m_pendingReadbacks) % m_readbackBuffers.size();
+
+    // Check if the readback has finished
+    const auto result = m_readbackFences[index]->clientWait(gl::GL_SYNC_FLUSH_COMMANDS_BIT, wait ? gl::GL_TIMEOUT_IGNORED : 0);
+    if (result == gl::GL_TIMEOUT_EXPIRED || result == gl::GL_WAIT_FAILED)
+    {
+        return false;
+    }
+
+    m_readbackFences[index] = nullptr;
+    m_pendingReadbacks--;
+
+    // Get frame from pool, allocate only while the pipeline fills up
+    auto width = m_parameters.at("width").toULongLong();
+    auto height = m_parameters.at("height").toULongLong();
+
+    std::unique_ptr<Image> frame;
+
+    {
+        std::unique_lock<std::mutex> lock(m_frameMutex);
+
+        // Bound the queue, so a slow encoder throttles rendering
+        m_frameEncoded.wait(lock, [this] ()
+        {
+            return m_frameQueue.size() < s_maxQueuedFrames;
+        });
+
+        if (!m_framePool.empty())
+        {
+            frame = std::move(m_framePool.back());
+            m_framePool.pop_back();
+        }
+    }
+
+    if (!frame)
+    {
+        frame = cppassist::make_unique<Image>(width, height, s_frameFormat, s_frameType);
+    }
+
+    // Copy frame data from the pixel pack buffer
+    const auto frameSize = width * height * frame->channels() * frame->bytes();
+    const auto data = m_readbackBuffers[index]->mapRange(0, static_cast<gl::GLsizeiptr>(frameSize), gl::GL_MAP_READ_BIT);
+
+    if (!data)
+    {
+        critical() << "Could not map readback buffer, dropping frame.";
+
+        // Keep the frame for reuse instead of encoding garbage
+        std::lock_guard<std::mutex> lock(m_frameMutex);
+        m_framePool.push_back(std::move(frame));
+
+        return true;
+    }
+
+    std::copy(static_cast<const char *>(data), static_cast<const char *>(data) + frameSize, frame->data());
+
+    m_readbackBuffers[index]->unmap();
+
+    // Pass frame to encoder thread
+    {
+        std::lock_guard<std::mutex> lock(m_frameMutex);
+        m_frameQueue.push_back(std::move(frame));
+    }
+
+    m_frameQueued.notify_one();
+
+    return true;
+}
+
+void FFMPEGVideoExporter::startEncoderThread()
+{
+    if (m_encoderThread.joinable())
+    {
+        return;
+    }
+
+    m_encoding      = true;
+    m_encoderThread = std::thread(&FFMPEGVideoExporter::encodeFrames, this);
+}
+
+void FFMPEGVideoExporter::stopEncoderThread()
+{
+    if (!m_encoderThread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_frameMutex);
+        m_encoding = false;
+    }
+
+    m_frameQueued.notify_one();
+    m_encoderThread.join();
+
+    m_framePool.clear();
+}
+
+void FFMPEGVideoExporter::encodeFrames()
+{
+    while (true)
+    {
+        std::unique_ptr<Image> frame;
+
+        {
+            std::unique_lock<std::mutex> lock(m_frameMutex);
+
+            m_frameQueued.wait(lock, [this] ()
+            {
+                return !m_encoding || !m_frameQueue.empty();
+            });
+
+            // Encode remaining frames before stopping
+            if (m_frameQueue.empty())
+            {
+                return;
+            }
+
+            frame = std::move(m_frameQueue.front());
+            m_frameQueue.pop_front();
+        }
+
+        m_frameEncoded.notify_one();
+
+        m_videoEncoder->putFrame(*frame, true);
+
+        // Return frame for reuse
+        {
+            std::lock_guard<std::mutex> lock(m_frameMutex);
+            m_framePool.push_back(std::move(frame));
+        }
+    }
 }
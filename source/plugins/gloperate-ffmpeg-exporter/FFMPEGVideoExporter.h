@@ -7,13 +7,18 @@
 #include <string>
 #include <functional>
 #include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include <cppexpose/plugin/plugin_api.h>
 
 #include <globjects/Texture.h>
 #include <globjects/Renderbuffer.h>
-#include <globjects/VertexArray.h>
-#include <globjects/Program.h>
+#include <globjects/Buffer.h>
+#include <globjects/Sync.h>
 
 #include <gloperate/tools/AbstractVideoExporter.h>
 
@@ -66,33 +71,95 @@ public:
 
 
 protected:
-    void initialize(ContextHandling contextHandling);
+    /**
+    *  @brief
+    *    Initialize encoder, framebuffer and readback ring for the current target
+    *
+    *  @param[in] contextHandling
+    *    Context handling during export
+    *
+    *  @return
+    *    'true' if the export can start, 'false' if the encoder could not be initialized
+    */
+    bool initialize(ContextHandling contextHandling);
     void finalize();
-    void createAndSetupGeometry();
-    void createAndSetupShader();
+    void createAndSetupFramebuffer();
+
+    /**
+    *  @brief
+    *    Remove the framebuffer attachments from the framebuffer cache and delete them
+    */
+    void releaseFramebuffer();
     void createAndSetupBuffer();
 
+    /**
+    *  @brief
+    *    Start asynchronous readback of the current frame into the readback ring
+    *
+    *  @remarks
+    *    Finished readbacks of previous frames are passed to the encoder thread.
+    *    Only waits for the GPU if all readback buffers are in use.
+    */
+    void readbackFrame();
+
+    /**
+    *  @brief
+    *    Pass the oldest pending readback to the encoder thread
+    *
+    *  @param[in] wait
+    *    If 'true', wait for the GPU to finish the readback, else return immediately
+    *
+    *  @return
+    *    'true' if a frame has been passed to the encoder, else 'false'
+    */
+    bool finishReadback(bool wait);
+
+    /**
+    *  @brief
+    *    Start encoder thread
+    */
+    void startEncoderThread();
+
+    /**
+    *  @brief
+    *    Encode all queued frames and stop encoder thread
+    */
+    void stopEncoderThread();
+
+    /**
+    *  @brief
+    *    Main loop of the encoder thread
+    */
+    void encodeFrames();
+
 
 protected:
-    FFMPEGVideoEncoder                     * m_videoEncoder;
-    gloperate::Canvas                      * m_canvas;
-    gloperate::Image                       * m_image;
-
-    std::unique_ptr<globjects::Framebuffer>  m_fbo;
-    std::unique_ptr<globjects::Texture>      m_color;
-    std::unique_ptr<globjects::Renderbuffer> m_depth;
-    std::unique_ptr<globjects::Framebuffer>  m_fbo_quad;
-    std::unique_ptr<globjects::Texture>      m_color_quad;
-    std::unique_ptr<globjects::Renderbuffer> m_depth_quad;
-    std::unique_ptr<globjects::VertexArray>  m_vao;
-    std::unique_ptr<globjects::Buffer>       m_buffer;
-    std::unique_ptr<globjects::Program>      m_program;
-
-    cppexpose::VariantMap                    m_parameters;
-
-    int                                      m_progress;
-    bool                                     m_initialized;
-    AbstractVideoExporter::ContextHandling   m_contextHandling;
-
-    glm::vec4                                m_savedViewport;
+    FFMPEGVideoEncoder                              * m_videoEncoder;
+    gloperate::Canvas                               * m_canvas;
+
+    std::unique_ptr<globjects::Framebuffer>           m_fbo;
+    std::unique_ptr<globjects::Texture>               m_color;
+    std::unique_ptr<globjects::Renderbuffer>          m_depth;
+
+    std::vector<std::unique_ptr<globjects::Buffer>>   m_readbackBuffers;
+    std::vector<std::unique_ptr<globjects::Sync>>     m_readbackFences;
+    size_t                                            m_nextReadback;
+    size_t                                            m_pendingReadbacks;
+
+    std::thread                                       m_encoderThread;
+    std::mutex                                        m_frameMutex;
+    std::condition_variable                           m_frameQueued;
+    std::condition_variable                           m_frameEncoded;
+    std::deque<std::unique_ptr<gloperate::Image>>     m_frameQueue;
+    std::vector<std::unique_ptr<gloperate::Image>>    m_framePool;
+    bool                                              m_encoding;
+
+    cppexpose::VariantMap                             m_parameters;
+
+    int                                               m_progress;
+    bool                                              m_initialized;
+    bool                                              m_failed;
+    AbstractVideoExporter::ContextHandling            m_contextHandling;
+
+    glm::vec4                                         m_savedViewport;
 };
@@ -0,0 +1,213 @@
+
+#include <gmock/gmock.h>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include <cppassist/memory/make_unique.h>
+
+#include <gloperate/base/Environment.h>
+#include <gloperate/pipeline/Pipeline.h>
+#include <gloperate/pipeline/Stage.h>
+#include <gloperate/pipeline/Input.h>
+#include <gloperate/pipeline/Output.h>
+
+
+using namespace gloperate;
+
+
+namespace
+{
+
+
+// Exposes the invalidation marks of a slot
+class TestInput : public Input<int>
+{
+public:
+    TestInput()
+    : Input<int>("input")
+    {
+    }
+
+    using Input<int>::beginInvalidation;
+    using Input<int>::endInvalidation;
+};
+
+
+} // namespace
+
+
+class AbstractSlot_test : public testing::Test
+{
+public:
+    AbstractSlot_test()
+    : m_pipeline(&m_environment, "Pipeline", "pipeline")
+    {
+    }
+
+
+protected:
+    Stage * addStage(const std::string & name)
+    {
+        auto stage = cppassist::make_unique<Stage>(&m_environment, "Stage", name);
+        auto stagePtr = stage.get();
+
+        m_outputs.push_back(stagePtr->createOutput<int>("out"));
+        m_pipeline.addStage(std::move(stage));
+
+        return stagePtr;
+    }
+
+    // Connect a new input of the target to the output of the source and count its invalidations
+    void connect(size_t source, Stage * target)
+    {
+        auto input = target->createInput<int>("in" + std::to_string(target->inputs().size()));
+        input->connect(m_outputs[source]);
+
+        const auto index = m_invalidations.size();
+        m_invalidations.push_back(0);
+
+        input->valueInvalidated.connect([this, index] ()
+        {
+            m_invalidations[index]++;
+        });
+    }
+
+    // Connecting inputs invalidates the outputs of their stages, so set all outputs
+    // in stage order (each one invalidates only its successors) and reset the counters
+    void validateOutputs()
+    {
+        for (auto output : m_outputs)
+        {
+            output->setValue(0);
+        }
+
+        std::fill(m_invalidations.begin(), m_invalidations.end(), 0);
+    }
+
+
+protected:
+    Environment                m_environment;
+    Pipeline                   m_pipeline;
+    std::vector<Output<int> *> m_outputs;
+    std::vector<int>           m_invalidations;
+};
+
+
+TEST_F(AbstractSlot_test, InvalidationMarkDetectsRecursion)
+{
+    TestInput input;
+
+    EXPECT_TRUE(input.beginInvalidation());
+    EXPECT_FALSE(input.beginInvalidation());
+
+    // Another thread has its own marks, even while this thread holds the slot
+    std::thread([&input] ()
+    {
+        EXPECT_TRUE(input.beginInvalidation());
+        EXPECT_FALSE(input.beginInvalidation());
+        input.endInvalidation();
+
+        EXPECT_TRUE(input.beginInvalidation());
+        input.endInvalidation();
+    }).join();
+
+    input.endInvalidation();
+
+    EXPECT_TRUE(input.beginInvalidation());
+    input.endInvalidation();
+}
+
+TEST_F(AbstractSlot_test, InvalidationReachesEndOfChain)
+{
+    for (size_t i = 0; i < 4; ++i)
+    {
+        auto stage = addStage("stage" + std::to_string(i));
+
+        if (i > 0)
+        {
+            connect(i - 1, stage);
+        }
+    }
+
+    validateOutputs();
+    EXPECT_TRUE(m_outputs.back()->isValid());
+
+    m_outputs.front()->invalidate();
+
+    EXPECT_EQ(std::vector<int>({ 1, 1, 1 }), m_invalidations);
+    EXPECT_FALSE(m_outputs.back()->isValid());
+}
+
+
+// Invalidation of synthetic slot graphs of increasing size
+class AbstractSlot_benchmark : public AbstractSlot_test, public testing::WithParamInterface<size_t>
+{
+};
+
+
+TEST_P(AbstractSlot_benchmark, InvalidateDeepChain)
+{
+    const size_t numStages = GetParam();
+
+    // Each stage is connected to its predecessor, so the invalidation recurses through all of them
+    for (size_t i = 0; i < numStages; ++i)
+    {
+        auto stage = addStage("stage" + std::to_string(i));
+
+        if (i > 0)
+        {
+            connect(i - 1, stage);
+        }
+    }
+
+    validateOutputs();
+
+    using clock = std::chrono::steady_clock;
+
+    const auto start = clock::now();
+    m_outputs.front()->invalidate();
+    const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count();
+
+    EXPECT_EQ(std::vector<int>(numStages - 1, 1), m_invalidations);
+
+    RecordProperty("depth",        static_cast<int>(numStages));
+    RecordProperty("microseconds", static_cast<int>(duration));
+
+    std::cout << "[ BENCH    ] chain of " << numStages << " stages: invalidation " << duration << " us" << std::endl;
+}
+
+TEST_P(AbstractSlot_benchmark, InvalidateWideFanOut)
+{
+    const size_t numStages = GetParam();
+
+    // All stages are connected to the same output, so the invalidation is wide but shallow
+    addStage("source");
+
+    for (size_t i = 0; i < numStages; ++i)
+    {
+        connect(0, addStage("stage" + std::to_string(i)));
+    }
+
+    validateOutputs();
+
+    using clock = std::chrono::steady_clock;
+
+    const auto start = clock::now();
+    m_outputs.front()->invalidate();
+    const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count();
+
+    EXPECT_EQ(std::vector<int>(numStages, 1), m_invalidations);
+
+    RecordProperty("width",        static_cast<int>(numStages));
+    RecordProperty("microseconds", static_cast<int>(duration));
+
+    std::cout << "[ BENCH    ] fan-out to " << numStages << " stages: invalidation " << duration << " us" << std::endl;
+}
+
+// The chain recurses once per stage, so its length is bounded by the stack size
+INSTANTIATE_TEST_CASE_P(SlotCounts, AbstractSlot_benchmark, testing::Values(10, 100, 1000));
@@ -0,0 +1,136 @@
+
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gloperate/base/BoundedQueue.h>
+
+
+using namespace gloperate;
+
+
+class BoundedQueue_test : public testing::Test
+{
+};
+
+
+TEST_F(BoundedQueue_test, PopFromEmptyQueueFails)
+{
+    BoundedQueue<int, 4> queue;
+
+    int value = 0;
+    EXPECT_FALSE(queue.pop(value));
+}
+
+TEST_F(BoundedQueue_test, PushToFullQueueFails)
+{
+    BoundedQueue<int, 4> queue;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_TRUE(queue.push(i));
+    }
+
+    EXPECT_FALSE(queue.push(4));
+
+    // Space becomes available again after an element has been removed
+    int value = -1;
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(0, value);
+    EXPECT_TRUE(queue.push(4));
+}
+
+TEST_F(BoundedQueue_test, ElementsArePoppedInOrder)
+{
+    BoundedQueue<int, 4> queue;
+
+    // Wrap around the ring buffer several times
+    for (int round = 0; round < 3; ++round)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            EXPECT_TRUE(queue.push(round * 10 + i));
+        }
+
+        for (int i = 0; i < 3; ++i)
+        {
+            int value = -1;
+            EXPECT_TRUE(queue.pop(value));
+            EXPECT_EQ(round * 10 + i, value);
+        }
+
+        int value = -1;
+        EXPECT_FALSE(queue.pop(value));
+    }
+}
+
+TEST_F(BoundedQueue_test, MultipleProducersAndConsumers)
+{
+    const int numProducers = 4;
+    const int numConsumers = 4;
+    const int numValues    = 10000;
+
+    BoundedQueue<int, 64> queue;
+
+    std::atomic<int>              numPopped(0);
+    std::vector<std::atomic<int>> received(numProducers * numValues);
+    for (auto & count : received)
+    {
+        count = 0;
+    }
+
+    std::vector<std::thread> threads;
+
+    for (int producer = 0; producer < numProducers; ++producer)
+    {
+        threads.emplace_back([&queue, producer, numValues] ()
+        {
+            for (int i = 0; i < numValues; ++i)
+            {
+                // Retry while the queue is full
+                while (!queue.push(producer * numValues + i))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (int consumer = 0; consumer < numConsumers; ++consumer)
+    {
+        threads.emplace_back([&queue, &numPopped, &received, numProducers, numValues] ()
+        {
+            while (numPopped < numProducers * numValues)
+            {
+                int value = -1;
+                if (queue.pop(value))
+                {
+                    received[value]++;
+                    numPopped++;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (auto & thread : threads)
+    {
+        thread.join();
+    }
+
+    // Each value has been received exactly once
+    EXPECT_EQ(numProducers * numValues, numPopped);
+
+    for (const auto & count : received)
+    {
+        EXPECT_EQ(1, count);
+    }
+
+    int value = -1;
+    EXPECT_FALSE(queue.pop(value));
+}
@@ -0,0 +1,294 @@
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include <cppassist/memory/make_unique.h>
+
+#include <cppexpose/variant/Variant.h>
+#include <cppexpose/signal/ScopedConnection.h>
+
+#include <gloperate/base/Environment.h>
+#include <gloperate/base/Canvas.h>
+#include <gloperate/pipeline/Pipeline.h>
+#include <gloperate/pipeline/Stage.h>
+#include <gloperate/pipeline/Input.h>
+#include <gloperate/pipeline/Output.h>
+#include <gloperate/input/InputManager.h>
+#include <gloperate/input/AbstractEventConsumer.h>
+#include <gloperate/input/MouseEvent.h>
+
+
+using namespace gloperate;
+
+
+namespace
+{
+
+
+// Renders frames without an OpenGL context
+class TestCanvas : public Canvas
+{
+public:
+    TestCanvas(Environment * environment)
+    : Canvas(environment)
+    {
+    }
+
+    using Canvas::scr_setValue;
+    using Canvas::scr_setValues;
+
+    // Lock the canvas like a frame that is being rendered
+    std::recursive_mutex & mutex()
+    {
+        return m_mutex;
+    }
+
+    // Dispatch input and measure the input latency like render(), with a fixed frame time
+    void renderFrame(std::chrono::microseconds frameTime)
+    {
+        std::lock_guard<std::recursive_mutex> lock(this->m_mutex);
+
+        dispatchInputEvents();
+        std::this_thread::sleep_for(frameTime);
+        updateInputLatency();
+    }
+};
+
+
+// Records the mouse events dispatched by the input devices
+class MouseEventRecorder : public AbstractEventConsumer
+{
+public:
+    MouseEventRecorder(InputManager * inputManager)
+    : AbstractEventConsumer(inputManager)
+    {
+    }
+
+    virtual void onEvent(InputEvent * event) override
+    {
+        const auto mouseEvent = static_cast<MouseEvent *>(event);
+
+        types.push_back(event->type());
+        positions.push_back(mouseEvent->pos());
+    }
+
+
+public:
+    std::vector<InputEvent::Type> types;
+    std::vector<glm::ivec2>       positions;
+};
+
+
+} // namespace
+
+
+class Canvas_test : public testing::Test
+{
+public:
+    Canvas_test()
+    : m_canvas(&m_environment)
+    {
+    }
+
+
+protected:
+    Environment m_environment;
+    TestCanvas  m_canvas;
+};
+
+
+TEST_F(Canvas_test, InputLatencyStartsAtOldestEvent)
+{
+    const auto delay = std::chrono::milliseconds(2);
+
+    // The canvas is idle, so the event is dispatched immediately
+    m_canvas.promoteMouseMove(glm::ivec2(1, 1), 0);
+    std::this_thread::sleep_for(delay);
+    m_canvas.promoteMouseMove(glm::ivec2(2, 2), 0);
+
+    m_canvas.renderFrame(std::chrono::microseconds(0));
+    EXPECT_GE(m_canvas.inputLatency(), std::chrono::duration<float>(delay).count());
+
+    // No input for the next frame
+    m_canvas.renderFrame(std::chrono::microseconds(0));
+    EXPECT_EQ(0.0f, m_canvas.inputLatency());
+}
+
+
+TEST_F(Canvas_test, ConsecutiveMouseMovesAreCoalesced)
+{
+    MouseEventRecorder recorder(m_environment.inputManager());
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_canvas.mutex());
+
+        // While a frame is rendered, events from the UI thread are only queued
+        std::thread([this] ()
+        {
+            m_canvas.promoteMouseMove(glm::ivec2(1, 1), 0);
+            m_canvas.promoteMouseMove(glm::ivec2(2, 2), 0);
+            m_canvas.promoteMouseMove(glm::ivec2(3, 3), 0);
+            m_canvas.promoteMousePress(1, glm::ivec2(3, 3), 0);
+            m_canvas.promoteMouseMove(glm::ivec2(4, 4), 0);
+            m_canvas.promoteMouseMove(glm::ivec2(5, 5), 0);
+        }).join();
+
+        EXPECT_TRUE(recorder.types.empty());
+    }
+
+    m_canvas.renderFrame(std::chrono::microseconds(0));
+
+    // Only the last move before and after the button press are dispatched
+    EXPECT_EQ(std::vector<InputEvent::Type>({ InputEvent::Type::MouseMove, InputEvent::Type::MouseButtonPress, InputEvent::Type::MouseMove }), recorder.types);
+    EXPECT_EQ(std::vector<glm::ivec2>({ glm::ivec2(3, 3), glm::ivec2(3, 3), glm::ivec2(5, 5) }), recorder.positions);
+}
+
+
+TEST_F(Canvas_test, ScriptValuesAreSetInOneTransaction)
+{
+    auto pipeline = cppassist::make_unique<Pipeline>(&m_environment, "Pipeline", "pipeline");
+    auto stage    = cppassist::make_unique<Stage>(&m_environment, "Stage", "stage");
+
+    auto x   = stage->createInput<int>("x");
+    auto y   = stage->createInput<int>("y");
+    auto z   = stage->createInput<int>("z");
+    auto out = stage->createOutput<int>("out");
+
+    // The stage outlives this test body, so the counters are disconnected on return
+    std::map<AbstractSlot *, int> changes;
+    cppexpose::ScopedConnection changed(stage->inputChanged.connect([&changes] (AbstractSlot * slot)
+    {
+        changes[slot]++;
+    }));
+
+    int invalidations = 0;
+    cppexpose::ScopedConnection invalidated(out->valueInvalidated.connect([&invalidations] ()
+    {
+        invalidations++;
+    }));
+
+    pipeline->addStage(std::move(stage));
+    m_canvas.setRenderStage(std::move(pipeline));
+
+    // Several values in one call
+    out->setValue(0);
+
+    cppexpose::VariantMap values;
+    values["x"]       = 1;
+    values["y"]       = 2;
+    values["missing"] = 3;
+
+    m_canvas.scr_setValues("root.stage", cppexpose::Variant(values));
+
+    EXPECT_EQ(1, **x);
+    EXPECT_EQ(2, **y);
+    EXPECT_EQ(1, changes[x]);
+    EXPECT_EQ(1, changes[y]);
+    EXPECT_EQ(0u, changes.count(z));
+    EXPECT_EQ(1, invalidations);
+
+    // Repeated values of a slot within a canvas transaction
+    out->setValue(0);
+    changes.clear();
+    invalidations = 0;
+
+    m_canvas.beginTransaction();
+
+    for (int i = 0; i < 5; ++i)
+    {
+        m_canvas.scr_setValue("root.stage", "z", cppexpose::Variant(i));
+    }
+
+    EXPECT_EQ(0u, changes.count(z));
+    EXPECT_TRUE(out->isValid());
+
+    m_canvas.commitTransaction();
+
+    EXPECT_EQ(4, **z);
+    EXPECT_EQ(1, changes[z]);
+    EXPECT_EQ(1, invalidations);
+}
+
+
+// Input latency at different frame times while the UI thread sends mouse moves
+class Canvas_benchmark : public Canvas_test, public testing::WithParamInterface<int>
+{
+};
+
+
+TEST_P(Canvas_benchmark, InputLatency)
+{
+    const auto frameTime = std::chrono::milliseconds(GetParam());
+    const int  numFrames = 50;
+
+    using clock = std::chrono::steady_clock;
+
+    std::atomic<bool> running(true);
+    clock::duration   maxPromoteTime(0);
+
+    // UI thread: a mouse move every 250 us, as sent by a high-rate mouse
+    std::thread ui([this, &running, &maxPromoteTime] ()
+    {
+        int x = 0;
+
+        while (running)
+        {
+            const auto start = clock::now();
+            m_canvas.promoteMouseMove(glm::ivec2(x++, 0), 0);
+            maxPromoteTime = std::max(maxPromoteTime, clock::now() - start);
+
+            std::this_thread::sleep_for(std::chrono::microseconds(250));
+        }
+    });
+
+    // Render thread
+    std::vector<float> latencies;
+
+    for (int i = 0; i < numFrames; ++i)
+    {
+        m_canvas.renderFrame(frameTime);
+
+        if (m_canvas.inputLatency() > 0.0f)
+        {
+            latencies.push_back(m_canvas.inputLatency() * 1000.0f);
+        }
+    }
+
+    running = false;
+    ui.join();
+
+    ASSERT_FALSE(latencies.empty());
+
+    // Events are dispatched at the beginning of a frame, so they wait at least one frame
+    const auto minLatency = *std::min_element(latencies.begin(), latencies.end());
+    const auto maxLatency = *std::max_element(latencies.begin(), latencies.end());
+
+    float meanLatency = 0.0f;
+    for (auto latency : latencies)
+    {
+        meanLatency += latency / latencies.size();
+    }
+
+    EXPECT_GE(minLatency, std::chrono::duration<float, std::milli>(frameTime).count());
+
+    const auto maxPromote = std::chrono::duration_cast<std::chrono::microseconds>(maxPromoteTime).count();
+
+    RecordProperty("frameTimeMilliseconds",   GetParam());
+    RecordProperty("meanLatencyMicroseconds", static_cast<int>(meanLatency * 1000.0f));
+    RecordProperty("maxLatencyMicroseconds",  static_cast<int>(maxLatency * 1000.0f));
+    RecordProperty("maxPromoteMicroseconds",  static_cast<int>(maxPromote));
+
+    std::cout << "[ BENCH    ] frame time " << GetParam() << " ms: input latency mean " << meanLatency << " ms, max " << maxLatency << " ms, "
+              << "UI thread blocked at most " << maxPromote << " us" << std::endl;
+}
+
+INSTANTIATE_TEST_CASE_P(FrameTimes, Canvas_benchmark, testing::Values(1, 4, 16));
@@ -0,0 +1,79 @@
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <glm/geometric.hpp>
+
+#include <gloperate/rendering/Icosahedron.h>
+
+
+using namespace gloperate;
+
+
+// Refinement levels whose indices need (or almost need) 32 bits
+class Icosahedron_test : public testing::TestWithParam<gl::GLsizei>
+{
+};
+
+
+TEST_P(Icosahedron_test, RefinementCounts)
+{
+    const gl::GLsizei level = GetParam();
+
+    Icosahedron icosahedron;
+    icosahedron.generateGeometry(level);
+
+    // Each level quadruples the faces and adds one vertex per edge:
+    // 20 * 4^n faces and 10 * 4^n + 2 vertices, shared by adjacent faces
+    const size_t scale = size_t(1) << (2 * level);
+
+    EXPECT_EQ(10 * scale + 2, icosahedron.vertices().size());
+    EXPECT_EQ(20 * scale,     icosahedron.indices().size());
+}
+
+TEST_P(Icosahedron_test, IndicesAreInRange)
+{
+    const gl::GLsizei level = GetParam();
+
+    Icosahedron icosahedron;
+    icosahedron.generateGeometry(level);
+
+    gl::GLuint maxIndex = 0;
+    for (const auto & face : icosahedron.indices())
+    {
+        maxIndex = std::max({ maxIndex, face[0], face[1], face[2] });
+    }
+
+    // Every vertex is referenced, the last one included
+    EXPECT_EQ(icosahedron.vertices().size() - 1, maxIndex);
+
+    if (icosahedron.vertices().size() > std::numeric_limits<std::uint16_t>::max())
+    {
+        EXPECT_GT(maxIndex, std::numeric_limits<std::uint16_t>::max());
+    }
+}
+
+TEST_P(Icosahedron_test, VerticesAreOnUnitSphere)
+{
+    Icosahedron icosahedron;
+    icosahedron.generateGeometry(GetParam());
+
+    for (const auto & vertex : icosahedron.vertices())
+    {
+        ASSERT_NEAR(1.0f, glm::length(vertex), 1e-5f);
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(Levels, Icosahedron_test, testing::Values(6, 7, 8));
+
+
+TEST(Icosahedron, LevelsAreClampedToMaxIterations)
+{
+    Icosahedron icosahedron;
+    icosahedron.generateGeometry(Icosahedron::MaxIterations + 1);
+
+    // 655362 vertices at the maximum level
+    EXPECT_EQ(655362u, icosahedron.vertices().size());
+}
@@ -0,0 +1,264 @@
+
+#include <gmock/gmock.h>
+
+#include <string>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include <cppexpose/reflection/Object.h>
+#include <cppexpose/variant/Variant.h>
+
+#include <gloperate/base/Environment.h>
+#include <gloperate/input/InputManager.h>
+#include <gloperate/input/InputEvent.h>
+#include <gloperate/input/MouseEvent.h>
+#include <gloperate/input/MouseDevice.h>
+
+
+using namespace gloperate;
+
+
+namespace
+{
+
+
+// Exposes the scripting interface of the input manager
+class TestInputManager : public InputManager
+{
+public:
+    TestInputManager(Environment * environment)
+    : InputManager(environment)
+    {
+    }
+
+    using InputManager::scr_onInput;
+};
+
+
+// Scripting callback that records the events passed to it
+class ScriptRecorder : public cppexpose::Object
+{
+public:
+    struct Call
+    {
+        std::string type;
+        int         button;
+        glm::ivec2  pos;
+        glm::ivec2  delta;
+    };
+
+
+public:
+    ScriptRecorder()
+    : cppexpose::Object("recorder")
+    {
+        addFunction("call", this, &ScriptRecorder::call);
+    }
+
+    cppexpose::Variant function() const
+    {
+        return cppexpose::Variant::fromValue<cppexpose::Function>(functions().front());
+    }
+
+    void call(const std::string & device, const std::string & type, int key, int modifier, int button, int x, int y, int dx, int dy)
+    {
+        calls.push_back({ type, button, glm::ivec2(x, y), glm::ivec2(dx, dy) });
+    }
+
+
+public:
+    std::vector<Call> calls;
+};
+
+
+std::vector<InputEvent::Type> types(const std::vector<const InputEvent *> & events)
+{
+    std::vector<InputEvent::Type> result;
+
+    for (auto event : events)
+    {
+        result.push_back(event->type());
+    }
+
+    return result;
+}
+
+
+} // namespace
+
+
+class InputManager_test : public testing::Test
+{
+public:
+    InputManager_test()
+    : m_inputManager(&m_environment)
+    , m_mouse(&m_inputManager, "mouse")
+    {
+    }
+
+
+protected:
+    // Button of a recorded mouse event
+    static int button(const InputEvent * event)
+    {
+        return static_cast<const MouseEvent *>(event)->button();
+    }
+
+    // Position of a recorded mouse event
+    static glm::ivec2 pos(const InputEvent * event)
+    {
+        return static_cast<const MouseEvent *>(event)->pos();
+    }
+
+
+protected:
+    Environment      m_environment;
+    TestInputManager m_inputManager;
+    MouseDevice      m_mouse;
+};
+
+
+TEST_F(InputManager_test, HistoryIsBoundedByDepth)
+{
+    m_inputManager.setHistoryDepth(4);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        m_mouse.buttonPress(i, glm::ivec2(0), 0);
+    }
+
+    // The oldest events have been overwritten
+    const auto history = m_inputManager.history();
+    ASSERT_EQ(4u, history.size());
+
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_EQ(6 + i, button(history[i]));
+    }
+}
+
+TEST_F(InputManager_test, ChangingDepthKeepsRecentEvents)
+{
+    for (int i = 0; i < 6; ++i)
+    {
+        m_mouse.buttonPress(i, glm::ivec2(0), 0);
+    }
+
+    m_inputManager.setHistoryDepth(3);
+
+    auto history = m_inputManager.history();
+    ASSERT_EQ(3u, history.size());
+    EXPECT_EQ(3, button(history[0]));
+    EXPECT_EQ(5, button(history[2]));
+
+    // Growing the history keeps the remaining events in order
+    m_inputManager.setHistoryDepth(8);
+    m_mouse.buttonPress(6, glm::ivec2(0), 0);
+
+    history = m_inputManager.history();
+    EXPECT_EQ(8u, m_inputManager.historyDepth());
+    ASSERT_EQ(4u, history.size());
+    EXPECT_EQ(3, button(history[0]));
+    EXPECT_EQ(6, button(history[3]));
+}
+
+TEST_F(InputManager_test, ZeroDepthDisablesHistory)
+{
+    m_inputManager.setHistoryDepth(0);
+
+    m_mouse.move(glm::ivec2(1, 1), 0);
+    m_mouse.buttonPress(1, glm::ivec2(1, 1), 0);
+
+    EXPECT_TRUE(m_inputManager.history().empty());
+}
+
+TEST_F(InputManager_test, ConsecutiveMovesAreCoalescedInHistory)
+{
+    m_mouse.move(glm::ivec2(1, 1), 0);
+    m_mouse.move(glm::ivec2(2, 2), 0);
+    m_mouse.move(glm::ivec2(3, 3), 0);
+    m_mouse.buttonPress(1, glm::ivec2(3, 3), 0);
+    m_mouse.move(glm::ivec2(4, 4), 0);
+    m_mouse.move(glm::ivec2(5, 5), 0);
+
+    // Only the latest position of each run of moves is kept
+    const auto history = m_inputManager.history();
+    EXPECT_EQ(std::vector<InputEvent::Type>({ InputEvent::Type::MouseMove, InputEvent::Type::MouseButtonPress, InputEvent::Type::MouseMove }), types(history));
+    ASSERT_EQ(3u, history.size());
+    EXPECT_EQ(glm::ivec2(3, 3), pos(history[0]));
+    EXPECT_EQ(glm::ivec2(5, 5), pos(history[2]));
+}
+
+TEST_F(InputManager_test, WheelScrollsAreKeptInHistory)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        m_mouse.wheelScroll(glm::vec2(0.0f, 1.0f), glm::ivec2(0), 0);
+    }
+
+    // Wheel deltas are relative, so none of them may be lost
+    EXPECT_EQ(3u, m_inputManager.history().size());
+}
+
+TEST_F(InputManager_test, MovesOfDifferentDevicesAreNotCoalesced)
+{
+    MouseDevice otherMouse(&m_inputManager, "otherMouse");
+
+    m_mouse.move(glm::ivec2(1, 1), 0);
+    otherMouse.move(glm::ivec2(2, 2), 0);
+    otherMouse.move(glm::ivec2(3, 3), 0);
+
+    const auto history = m_inputManager.history();
+    ASSERT_EQ(2u, history.size());
+    EXPECT_EQ(&m_mouse,    history[0]->device());
+    EXPECT_EQ(&otherMouse, history[1]->device());
+    EXPECT_EQ(glm::ivec2(3, 3), pos(history[1]));
+}
+
+TEST_F(InputManager_test, ScriptEventsAreCoalescedUntilUpdate)
+{
+    ScriptRecorder recorder;
+    m_inputManager.scr_onInput(recorder.function(), cppexpose::Variant());
+
+    m_mouse.move(glm::ivec2(1, 1), 0);
+    m_mouse.move(glm::ivec2(2, 2), 0);
+    m_mouse.move(glm::ivec2(3, 3), 0);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        m_mouse.wheelScroll(glm::vec2(0.0f, 1.0f), glm::ivec2(3, 3), 0);
+    }
+
+    // Callbacks are only invoked on update
+    EXPECT_TRUE(recorder.calls.empty());
+
+    m_inputManager.update();
+
+    // The latest position is passed and wheel deltas are accumulated
+    ASSERT_EQ(2u, recorder.calls.size());
+    EXPECT_EQ("MouseMove",        recorder.calls[0].type);
+    EXPECT_EQ(glm::ivec2(3, 3),   recorder.calls[0].pos);
+    EXPECT_EQ("MouseWheelScroll", recorder.calls[1].type);
+    EXPECT_EQ(glm::ivec2(0, 3),   recorder.calls[1].delta);
+
+    // Events are passed only once
+    m_inputManager.update();
+    EXPECT_EQ(2u, recorder.calls.size());
+}
+
+TEST_F(InputManager_test, ScriptCallbacksReceiveSubscribedTypesOnly)
+{
+    ScriptRecorder recorder;
+    m_inputManager.scr_onInput(recorder.function(), cppexpose::Variant(std::string("MouseButtonPress")));
+
+    m_mouse.move(glm::ivec2(1, 1), 0);
+    m_mouse.buttonPress(2, glm::ivec2(1, 1), 0);
+    m_mouse.buttonRelease(2, glm::ivec2(1, 1), 0);
+
+    m_inputManager.update();
+
+    ASSERT_EQ(1u, recorder.calls.size());
+    EXPECT_EQ("MouseButtonPress", recorder.calls[0].type);
+    EXPECT_EQ(2,                  recorder.calls[0].button);
+}
@@ -0,0 +1,173 @@
+
+#include <gmock/gmock.h>
+
+#include <cstring>
+#include <vector>
+
+#include "MeshCache.h"
+
+
+namespace
+{
+
+
+const std::uint64_t s_sourceSize = 1234;
+const std::uint64_t s_sourceTime = 5678;
+
+
+} // namespace
+
+
+class MeshCache_test : public testing::Test
+{
+public:
+    MeshCache_test()
+    {
+        // Two submeshes sharing four vertices with position and normal, six 16 bit indices
+        m_header.magic        = MeshCache::magic;
+        m_header.version      = MeshCache::version;
+        m_header.flags        = MeshCache::flagSmoothNormals;
+        m_header.attributes   = MeshCache::attributeNormal;
+        m_header.sourceSize   = s_sourceSize;
+        m_header.sourceTime   = s_sourceTime;
+        m_header.vertexCount  = 4;
+        m_header.stride       = 6 * sizeof(float);
+        m_header.indexCount   = 6;
+        m_header.indexSize    = 2;
+        m_header.submeshCount = 2;
+        m_header.reserved     = 0;
+
+        m_submeshes.push_back({ 0, 3, 0, 0 });
+        m_submeshes.push_back({ 3, 3, 1, 0 });
+    }
+
+
+protected:
+    // Serialize header, submesh table, vertices and indices as written by the loader
+    std::vector<char> write() const
+    {
+        const size_t vertexSize = static_cast<size_t>(m_header.vertexCount) * m_header.stride;
+        const size_t indexSize  = static_cast<size_t>(m_header.indexCount) * m_header.indexSize;
+
+        std::vector<char> data(sizeof(MeshCache::Header) + m_submeshes.size() * sizeof(MeshCache::Submesh) + vertexSize + indexSize, 0);
+
+        std::memcpy(data.data(), &m_header, sizeof(MeshCache::Header));
+        std::memcpy(data.data() + sizeof(MeshCache::Header), m_submeshes.data(), m_submeshes.size() * sizeof(MeshCache::Submesh));
+
+        return data;
+    }
+
+    bool parse(const std::vector<char> & data, MeshCache::View & mesh, std::uint32_t flags = MeshCache::flagSmoothNormals) const
+    {
+        return MeshCache::parse(data.data(), data.size(), s_sourceSize, s_sourceTime, flags, mesh);
+    }
+
+
+protected:
+    MeshCache::Header               m_header;
+    std::vector<MeshCache::Submesh> m_submeshes;
+};
+
+
+TEST_F(MeshCache_test, ValidDataIsParsed)
+{
+    const auto data = write();
+
+    MeshCache::View mesh;
+    ASSERT_TRUE(parse(data, mesh));
+
+    EXPECT_EQ(4u, mesh.header.vertexCount);
+    EXPECT_EQ(6u, mesh.header.indexCount);
+
+    ASSERT_EQ(2u, mesh.ranges.size());
+    EXPECT_EQ(0, mesh.ranges[0].first);
+    EXPECT_EQ(3, mesh.ranges[0].count);
+    EXPECT_EQ(3, mesh.ranges[1].first);
+    EXPECT_EQ(3, mesh.ranges[1].count);
+
+    // Vertices follow the submesh table, indices follow the vertices
+    const size_t vertexOffset = sizeof(MeshCache::Header) + 2 * sizeof(MeshCache::Submesh);
+    EXPECT_EQ(data.data() + vertexOffset, mesh.vertices);
+    EXPECT_EQ(data.data() + vertexOffset + 4 * 6 * sizeof(float), mesh.indices);
+}
+
+TEST_F(MeshCache_test, ForeignDataIsRejected)
+{
+    m_header.magic = 0x12345678;
+
+    MeshCache::View mesh;
+    EXPECT_FALSE(parse(write(), mesh));
+}
+
+TEST_F(MeshCache_test, OtherVersionIsRejected)
+{
+    m_header.version = MeshCache::version - 1;
+
+    MeshCache::View mesh;
+    EXPECT_FALSE(parse(write(), mesh));
+}
+
+TEST_F(MeshCache_test, OtherLoadingFlagsAreRejected)
+{
+    const auto data = write();
+
+    MeshCache::View mesh;
+    EXPECT_FALSE(parse(data, mesh, 0u));
+}
+
+TEST_F(MeshCache_test, ModifiedSourceIsRejected)
+{
+    const auto data = write();
+
+    MeshCache::View mesh;
+    EXPECT_FALSE(MeshCache::parse(data.data(), data.size(), s_sourceSize + 1, s_sourceTime, MeshCache::flagSmoothNormals, mesh));
+    EXPECT_FALSE(MeshCache::parse(data.data(), data.size(), s_sourceSize, s_sourceTime + 1, MeshCache::flagSmoothNormals, mesh));
+}
+
+TEST_F(MeshCache_test, IncompleteDataIsRejected)
+{
+    auto data = write();
+
+    MeshCache::View mesh;
+
+    // Shorter than a header
+    EXPECT_FALSE(MeshCache::parse(data.data(), sizeof(MeshCache::Header) - 1, s_sourceSize, s_sourceTime, MeshCache::flagSmoothNormals, mesh));
+
+    // Missing last index
+    data.resize(data.size() - 2);
+    EXPECT_FALSE(parse(data, mesh));
+
+    // Trailing data
+    data.resize(data.size() + 4);
+    EXPECT_FALSE(parse(data, mesh));
+}
+
+TEST_F(MeshCache_test, InconsistentHeaderIsRejected)
+{
+    MeshCache::View mesh;
+
+    m_header.indexSize = 3;
+    EXPECT_FALSE(parse(write(), mesh));
+
+    m_header.indexSize  = 2;
+    m_header.indexCount = 0;
+    EXPECT_FALSE(parse(write(), mesh));
+}
+
+TEST_F(MeshCache_test, SubmeshBeyondIndicesIsRejected)
+{
+    m_submeshes[1].indexCount = 4;
+
+    MeshCache::View mesh;
+    EXPECT_FALSE(parse(write(), mesh));
+}
+
+TEST_F(MeshCache_test, LargeSubmeshDoesNotOverflow)
+{
+    // firstIndex + indexCount wraps around in 32 bit
+    m_submeshes[1].firstIndex = 0xffffffffu;
+    m_submeshes[1].indexCount = 7;
+
+    MeshCache::View mesh;
+    EXPECT_FALSE(parse(write(), mesh));
+}
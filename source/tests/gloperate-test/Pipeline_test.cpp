@@ -0,0 +1,447 @@
+
+#include <gmock/gmock.h>
+
+#include <map>
+#include <list>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+#include <cppassist/memory/make_unique.h>
+
+#include <cppexpose/signal/ScopedConnection.h>
+
+#include <gloperate/base/Environment.h>
+#include <gloperate/pipeline/Pipeline.h>
+#include <gloperate/pipeline/Stage.h>
+#include <gloperate/pipeline/Input.h>
+#include <gloperate/pipeline/Output.h>
+#include <gloperate/rendering/ColorRenderTarget.h>
+#include <gloperate/rendering/RenderTargetPool.h>
+
+
+using namespace gloperate;
+
+
+namespace
+{
+
+
+// Exposes the stage order of the pipeline
+class TestPipeline : public Pipeline
+{
+public:
+    TestPipeline(Environment * environment)
+    : Pipeline(environment, "TestPipeline", "pipeline")
+    {
+    }
+
+    using Pipeline::sortStages;
+
+    bool isSorted() const
+    {
+        return m_sorted;
+    }
+};
+
+
+} // namespace
+
+
+class Pipeline_test : public testing::Test
+{
+public:
+    Pipeline_test()
+    : m_pipeline(&m_environment)
+    {
+    }
+
+
+protected:
+    Stage * addStage(const std::string & name)
+    {
+        auto stage = cppassist::make_unique<Stage>(&m_environment, "Stage", name);
+        auto stagePtr = stage.get();
+
+        m_outputs[stagePtr] = stagePtr->createOutput<int>("out");
+        m_pipeline.addStage(std::move(stage));
+
+        return stagePtr;
+    }
+
+    Input<int> * connect(Stage * source, Stage * target)
+    {
+        auto input = target->createInput<int>("in" + std::to_string(target->inputs().size()));
+        input->connect(m_outputs[source]);
+
+        return input;
+    }
+
+
+protected:
+    Environment                      m_environment;
+    TestPipeline                     m_pipeline;
+    std::map<Stage *, Output<int> *> m_outputs;
+};
+
+
+TEST_F(Pipeline_test, StagesAreSortedAfterTheirDependencies)
+{
+    auto c = addStage("c");
+    auto b = addStage("b");
+    auto a = addStage("a");
+
+    connect(a, b);
+    connect(b, c);
+    connect(a, c);
+
+    m_pipeline.sortStages();
+
+    EXPECT_TRUE(m_pipeline.isSorted());
+    EXPECT_EQ(std::vector<Stage *>({ a, b, c }), m_pipeline.stages());
+}
+
+TEST_F(Pipeline_test, IndependentStagesKeepTheirOrder)
+{
+    auto d = addStage("d");
+    auto b = addStage("b");
+    auto c = addStage("c");
+    auto a = addStage("a");
+    auto x = addStage("x");
+
+    // Diamond: b and c are ready at the same time and keep their order
+    connect(a, b);
+    connect(a, c);
+    connect(b, d);
+    connect(c, d);
+
+    m_pipeline.sortStages();
+
+    EXPECT_TRUE(m_pipeline.isSorted());
+    EXPECT_EQ(std::vector<Stage *>({ a, x, b, c, d }), m_pipeline.stages());
+}
+
+TEST_F(Pipeline_test, FeedbackInputsDoNotImposeOrder)
+{
+    auto b = addStage("b");
+    auto a = addStage("a");
+
+    connect(a, b);
+    connect(b, a)->setFeedback(true);
+
+    m_pipeline.sortStages();
+
+    EXPECT_TRUE(m_pipeline.isSorted());
+    EXPECT_EQ(std::vector<Stage *>({ a, b }), m_pipeline.stages());
+}
+
+TEST_F(Pipeline_test, CycleKeepsAllStages)
+{
+    auto a = addStage("a");
+    auto b = addStage("b");
+    auto c = addStage("c");
+    auto d = addStage("d");
+
+    connect(a, b);
+    connect(b, a);
+    connect(a, c);
+
+    m_pipeline.sortStages();
+
+    // Stages that are part of or depend on the cycle are appended in their previous order
+    EXPECT_FALSE(m_pipeline.isSorted());
+    EXPECT_EQ(std::vector<Stage *>({ d, a, b, c }), m_pipeline.stages());
+}
+
+TEST_F(Pipeline_test, ResortAfterConnectionChange)
+{
+    auto a = addStage("a");
+    auto b = addStage("b");
+
+    m_pipeline.sortStages();
+    EXPECT_EQ(std::vector<Stage *>({ a, b }), m_pipeline.stages());
+
+    connect(b, a);
+
+    m_pipeline.sortStages();
+    EXPECT_EQ(std::vector<Stage *>({ b, a }), m_pipeline.stages());
+}
+
+
+TEST_F(Pipeline_test, TransientRenderTargetsWithDisjointUsesShareTexture)
+{
+    // Render target stages have no inputs, so they are sorted to the front
+    auto targetA = addStage("targetA");
+    auto targetB = addStage("targetB");
+    auto renderA = addStage("renderA");
+    auto renderB = addStage("renderB");
+
+    auto colorA = targetA->createOutput<ColorRenderTarget *>("color");
+    auto colorB = targetB->createOutput<ColorRenderTarget *>("color");
+
+    renderA->createInput<ColorRenderTarget *>("color")->connect(colorA);
+    renderB->createInput<ColorRenderTarget *>("color")->connect(colorB);
+    connect(renderA, renderB);
+
+    renderA->setAlwaysProcessed(true);
+    renderB->setAlwaysProcessed(true);
+
+    m_pipeline.sortStages();
+    ASSERT_EQ(std::vector<Stage *>({ targetA, targetB, renderA, renderB }), m_pipeline.stages());
+
+    RenderTargetPool::Lifetime lifetimeA = { &m_pipeline, 0, 0 };
+    RenderTargetPool::Lifetime lifetimeB = { &m_pipeline, 0, 0 };
+
+    ASSERT_TRUE(m_pipeline.renderTargetLifetime(targetA, lifetimeA.first, lifetimeA.last));
+    ASSERT_TRUE(m_pipeline.renderTargetLifetime(targetB, lifetimeB.first, lifetimeB.last));
+
+    // Lifetimes start at the first stage that uses the render target, not at the render target stage
+    EXPECT_EQ(2u, lifetimeA.first);
+    EXPECT_EQ(2u, lifetimeA.last);
+    EXPECT_EQ(3u, lifetimeB.first);
+    EXPECT_EQ(3u, lifetimeB.last);
+
+    // The pool hands out the same texture to owners with disjoint lifetimes
+    EXPECT_FALSE(lifetimeA.overlaps(lifetimeB));
+    EXPECT_FALSE(lifetimeB.overlaps(lifetimeA));
+}
+
+TEST_F(Pipeline_test, RenderTargetsReadByLaterStagesDoNotShareTexture)
+{
+    auto targetA = addStage("targetA");
+    auto targetB = addStage("targetB");
+    auto renderA = addStage("renderA");
+    auto renderB = addStage("renderB");
+
+    auto colorA = targetA->createOutput<ColorRenderTarget *>("color");
+    auto colorB = targetB->createOutput<ColorRenderTarget *>("color");
+
+    // The render target of A is passed on and read by the stage that renders B
+    renderA->createInput<ColorRenderTarget *>("color")->connect(colorA);
+    auto passedA = renderA->createOutput<ColorRenderTarget *>("colorOut");
+
+    renderB->createInput<ColorRenderTarget *>("color")->connect(colorB);
+    renderB->createInput<ColorRenderTarget *>("source")->connect(passedA);
+
+    renderA->setAlwaysProcessed(true);
+    renderB->setAlwaysProcessed(true);
+
+    m_pipeline.sortStages();
+
+    RenderTargetPool::Lifetime lifetimeA = { &m_pipeline, 0, 0 };
+    RenderTargetPool::Lifetime lifetimeB = { &m_pipeline, 0, 0 };
+
+    ASSERT_TRUE(m_pipeline.renderTargetLifetime(targetA, lifetimeA.first, lifetimeA.last));
+    ASSERT_TRUE(m_pipeline.renderTargetLifetime(targetB, lifetimeB.first, lifetimeB.last));
+
+    EXPECT_EQ(2u, lifetimeA.first);
+    EXPECT_EQ(3u, lifetimeA.last);
+    EXPECT_TRUE(lifetimeA.overlaps(lifetimeB));
+}
+
+
+TEST_F(Pipeline_test, TransactionDeliversEachChangedInputOnce)
+{
+    auto a = addStage("a");
+    auto b = addStage("b");
+    auto c = addStage("c");
+    auto d = addStage("d");
+    auto e = addStage("e");
+
+    auto x = a->createInput<int>("x");
+    auto y = a->createInput<int>("y");
+    auto z = a->createInput<int>("z");
+
+    // Diamond below a, e is not affected
+    connect(a, b);
+    connect(a, c);
+    connect(b, d);
+    connect(c, d);
+
+    // The stages outlive this test body, so the counters are disconnected on return
+    std::map<AbstractSlot *, int> changes;
+    cppexpose::ScopedConnection changed(a->inputChanged.connect([&changes] (AbstractSlot * slot)
+    {
+        changes[slot]++;
+    }));
+
+    std::map<Stage *, int> invalidations;
+    std::list<cppexpose::ScopedConnection> invalidated;
+    for (auto stage : { a, b, c, d, e })
+    {
+        invalidated.emplace_back(m_outputs[stage]->valueInvalidated.connect([&invalidations, stage] ()
+        {
+            invalidations[stage]++;
+        }));
+    }
+
+    // Validate outputs in stage order, so that each one is invalidated at most once
+    for (auto stage : { a, b, c, d, e })
+    {
+        m_outputs[stage]->setValue(0);
+    }
+
+    invalidations.clear();
+
+    m_pipeline.beginTransaction();
+    EXPECT_TRUE(m_pipeline.inTransaction());
+
+    for (int i = 1; i <= 10; ++i)
+    {
+        x->setValue(i);
+        y->setValue(i);
+    }
+
+    // Values are applied immediately, notifications are deferred
+    EXPECT_EQ(10, **x);
+    EXPECT_TRUE(changes.empty());
+    EXPECT_TRUE(invalidations.empty());
+    EXPECT_TRUE(m_outputs[d]->isValid());
+
+    m_pipeline.commitTransaction();
+    EXPECT_FALSE(m_pipeline.inTransaction());
+
+    EXPECT_EQ(1, changes[x]);
+    EXPECT_EQ(1, changes[y]);
+    EXPECT_EQ(0u, changes.count(z));
+
+    // Each affected stage is invalidated once, d although it is reached twice
+    EXPECT_EQ(1, invalidations[a]);
+    EXPECT_EQ(1, invalidations[b]);
+    EXPECT_EQ(1, invalidations[c]);
+    EXPECT_EQ(1, invalidations[d]);
+    EXPECT_EQ(0u, invalidations.count(e));
+    EXPECT_FALSE(m_outputs[d]->isValid());
+    EXPECT_TRUE(m_outputs[e]->isValid());
+}
+
+TEST_F(Pipeline_test, NestedTransactionsAreCommittedByTheOutermost)
+{
+    auto a = addStage("a");
+    auto x = a->createInput<int>("x");
+
+    int changes = 0;
+    cppexpose::ScopedConnection changed(a->inputChanged.connect([&changes] (AbstractSlot *)
+    {
+        changes++;
+    }));
+
+    m_pipeline.beginTransaction();
+    m_pipeline.beginTransaction();
+    x->setValue(1);
+    m_pipeline.commitTransaction();
+
+    EXPECT_EQ(0, changes);
+    EXPECT_TRUE(m_pipeline.inTransaction());
+
+    x->setValue(2);
+    m_pipeline.commitTransaction();
+
+    EXPECT_EQ(1, changes);
+    EXPECT_FALSE(m_pipeline.inTransaction());
+}
+
+TEST_F(Pipeline_test, StageRemovedDuringCommitIsSkipped)
+{
+    auto a = addStage("a");
+    auto b = addStage("b");
+    auto c = addStage("c");
+
+    auto x = a->createInput<int>("x");
+    auto y = b->createInput<int>("y");
+    connect(a, c);
+
+    m_outputs[a]->setValue(0);
+    m_outputs[c]->setValue(0);
+
+    // Notifying a removes b, whose input change and invalidation are still pending
+    bool removed = false;
+    cppexpose::ScopedConnection changed(a->inputChanged.connect([this, b, &removed] (AbstractSlot *)
+    {
+        if (!removed)
+        {
+            removed = m_pipeline.removeStage(b);
+        }
+    }));
+
+    // Destroyed together with b
+    int changesOfB = 0;
+    b->inputChanged.connect([&changesOfB] (AbstractSlot *)
+    {
+        changesOfB++;
+    });
+
+    m_pipeline.beginTransaction();
+    x->setValue(1);
+    b->invalidateOutputs();
+    y->setValue(1);
+    m_pipeline.commitTransaction();
+
+    EXPECT_TRUE(removed);
+    EXPECT_EQ(0, changesOfB);
+    EXPECT_EQ(nullptr, m_pipeline.stage("b"));
+    EXPECT_EQ(std::vector<Stage *>({ a, c }), m_pipeline.stages());
+
+    // The remaining stages are invalidated as usual
+    EXPECT_FALSE(m_outputs[a]->isValid());
+    EXPECT_FALSE(m_outputs[c]->isValid());
+}
+
+
+// Synthetic pipelines of increasing size for measuring sortStages()
+class Pipeline_benchmark : public Pipeline_test, public testing::WithParamInterface<size_t>
+{
+};
+
+
+TEST_P(Pipeline_benchmark, SortSyntheticPipeline)
+{
+    const size_t numStages = GetParam();
+
+    // Stage i depends on its predecessor and on stage i / 2. Stages are
+    // added in reverse order, so the sort has to move every stage.
+    std::vector<Stage *> stages(numStages);
+    for (size_t i = numStages; i-- > 0; )
+    {
+        stages[i] = addStage("stage" + std::to_string(i));
+    }
+
+    for (size_t i = 1; i < numStages; ++i)
+    {
+        connect(stages[i - 1], stages[i]);
+
+        if (i / 2 != i - 1)
+        {
+            connect(stages[i / 2], stages[i]);
+        }
+    }
+
+    using clock = std::chrono::steady_clock;
+
+    // Full sort: dependencies of all stages have to be computed
+    auto start = clock::now();
+    m_pipeline.sortStages();
+    const auto fullSort = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count();
+
+    EXPECT_TRUE(m_pipeline.isSorted());
+    EXPECT_EQ(stages, m_pipeline.stages());
+
+    // Resort after a single connection change: only one stage is updated
+    connect(stages.front(), stages.back());
+
+    start = clock::now();
+    m_pipeline.sortStages();
+    const auto resort = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count();
+
+    EXPECT_TRUE(m_pipeline.isSorted());
+    EXPECT_EQ(stages, m_pipeline.stages());
+
+    RecordProperty("stages",               static_cast<int>(numStages));
+    RecordProperty("fullSortMicroseconds", static_cast<int>(fullSort));
+    RecordProperty("resortMicroseconds",   static_cast<int>(resort));
+
+    std::cout << "[ BENCH    ] " << numStages << " stages: full sort " << fullSort << " us, resort after connection change " << resort << " us" << std::endl;
+}
+
+INSTANTIATE_TEST_CASE_P(StageCounts, Pipeline_benchmark, testing::Values(10, 100, 1000, 10000));
@@ -0,0 +1,199 @@
+
+#include <gmock/gmock.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <cppexpose/reflection/Object.h>
+#include <cppexpose/variant/Variant.h>
+
+#include <gloperate/base/Environment.h>
+#include <gloperate/base/TimerManager.h>
+
+
+using namespace gloperate;
+
+
+namespace
+{
+
+
+// Exposes the scripting interface of the timer manager
+class TestTimerManager : public TimerManager
+{
+public:
+    TestTimerManager(Environment * environment)
+    : TimerManager(environment)
+    {
+    }
+
+    using TimerManager::scr_start;
+    using TimerManager::scr_once;
+    using TimerManager::scr_stop;
+    using TimerManager::scr_nextTick;
+};
+
+
+// Scripting function that calls a C++ function
+class Callback : public cppexpose::Object
+{
+public:
+    Callback(const std::function<void()> & func)
+    : cppexpose::Object("callback")
+    , m_func(func)
+    {
+        addFunction("call", this, &Callback::call);
+    }
+
+    cppexpose::Variant function() const
+    {
+        return cppexpose::Variant::fromValue<cppexpose::Function>(functions().front());
+    }
+
+    void call()
+    {
+        m_func();
+    }
+
+
+protected:
+    std::function<void()> m_func;
+};
+
+
+} // namespace
+
+
+class TimerManager_test : public testing::Test
+{
+public:
+    TimerManager_test()
+    : m_timers(&m_environment)
+    {
+    }
+
+
+protected:
+    Environment      m_environment;
+    TestTimerManager m_timers;
+};
+
+
+TEST_F(TimerManager_test, TimersFireInOrderOfDeadline)
+{
+    std::vector<std::string> fired;
+
+    Callback a([&fired] () { fired.push_back("a"); });
+    Callback b([&fired] () { fired.push_back("b"); });
+    Callback c([&fired] () { fired.push_back("c"); });
+    Callback d([&fired] () { fired.push_back("d"); });
+
+    m_timers.scr_once(30, a.function());
+    m_timers.scr_once(10, b.function());
+    m_timers.scr_once(20, c.function());
+    m_timers.scr_once(10, d.function());
+
+    m_timers.update(0.005f);
+    EXPECT_TRUE(fired.empty());
+
+    m_timers.update(0.05f);
+
+    // Timers with the same deadline fire in the order they have been started
+    EXPECT_EQ(std::vector<std::string>({ "b", "d", "c", "a" }), fired);
+
+    // Single-shot timers are deleted after they have fired
+    EXPECT_EQ(0u, m_timers.timerCount());
+    EXPECT_EQ(-1.0f, m_timers.remainingTime());
+}
+
+TEST_F(TimerManager_test, RepeatingTimerFiresOncePerUpdate)
+{
+    int calls = 0;
+
+    Callback callback([&calls] () { calls++; });
+
+    const int id = m_timers.scr_start(10, callback.function());
+
+    m_timers.update(0.01f);
+    m_timers.update(0.01f);
+    EXPECT_EQ(2, calls);
+
+    // A long frame does not fire the timer several times in a row
+    m_timers.update(0.1f);
+    EXPECT_EQ(3, calls);
+
+    m_timers.scr_stop(id);
+    m_timers.update(0.1f);
+    EXPECT_EQ(3, calls);
+    EXPECT_EQ(0u, m_timers.timerCount());
+}
+
+TEST_F(TimerManager_test, StopFromCallback)
+{
+    int calls = 0;
+    int id    = 0;
+
+    Callback callback([this, &calls, &id] ()
+    {
+        calls++;
+        m_timers.scr_stop(id);
+    });
+
+    id = m_timers.scr_start(10, callback.function());
+
+    m_timers.update(0.01f);
+    EXPECT_EQ(1, calls);
+
+    // The timer has been deleted after its callback has returned
+    EXPECT_EQ(0u, m_timers.timerCount());
+
+    m_timers.update(0.01f);
+    EXPECT_EQ(1, calls);
+}
+
+TEST_F(TimerManager_test, NextTickFromCallbackIsPostponed)
+{
+    int calls = 0;
+
+    Callback callback([this, &calls, &callback] ()
+    {
+        calls++;
+
+        // Schedule the same function again for the next update
+        m_timers.scr_nextTick(callback.function());
+    });
+
+    m_timers.scr_nextTick(callback.function());
+
+    // Each update only fires the timers that existed before it has started
+    m_timers.update(0.0f);
+    EXPECT_EQ(1, calls);
+
+    m_timers.update(0.0f);
+    EXPECT_EQ(2, calls);
+
+    m_timers.update(0.0f);
+    EXPECT_EQ(3, calls);
+
+    EXPECT_EQ(1u, m_timers.timerCount());
+    EXPECT_EQ(0.0f, m_timers.remainingTime());
+}
+
+TEST_F(TimerManager_test, RemainingTimeRefersToNextTimer)
+{
+    int calls = 0;
+
+    Callback callback([&calls] () { calls++; });
+
+    const int id = m_timers.scr_once(10, callback.function());
+    m_timers.scr_once(100, callback.function());
+
+    EXPECT_NEAR(0.01f, m_timers.remainingTime(), 0.01f);
+
+    // Stopped timers are not considered
+    m_timers.scr_stop(id);
+
+    EXPECT_NEAR(0.1f, m_timers.remainingTime(), 0.01f);
+    EXPECT_EQ(1u, m_timers.timerCount());
+}